@@ -0,0 +1,344 @@
+/* json-arena.c - Arena allocator for JSON documents
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * JsonArena is a bump allocator that holds all the nodes, values, and
+ * containers of a single JSON document, as well as the bytes of its
+ * strings; the whole document is released at once when the last
+ * reference on the arena is dropped, instead of walking the tree.
+ *
+ * The arena does not know anything about the data types it holds, so
+ * the containers register a cleanup function for the resources they
+ * allocate outside of the arena, like hash tables.
+ *
+ * Chunks are aligned to their size, which allows finding the arena that
+ * owns a structure allocated inside it from the structure's address; we
+ * use this to turn references to any part of the document into
+ * references to the arena, without storing a pointer in every node.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#ifdef HAVE_POSIX_MEMALIGN
+#include <stdlib.h>
+#endif
+
+#ifdef G_OS_WIN32
+#include <malloc.h>
+#endif
+
+#include "json-types-private.h"
+
+/* the size, and alignment, of each chunk */
+#define ARENA_CHUNK_SIZE        (64 * 1024)
+
+/* allocations larger than this are not stored inside a chunk */
+#define ARENA_LARGE_SIZE        (ARENA_CHUNK_SIZE / 4)
+
+#define ARENA_ALIGN(n)          (((n) + (sizeof (gpointer) * 2) - 1) & ~((sizeof (gpointer) * 2) - 1))
+
+typedef struct _JsonArenaChunk  JsonArenaChunk;
+
+struct _JsonArenaChunk
+{
+  JsonArena *arena;
+  JsonArenaChunk *next;
+
+  /* the memory block returned by the allocator, if the chunk
+   * had to be aligned by hand
+   */
+  gpointer block;
+};
+
+typedef struct
+{
+  GDestroyNotify func;
+  gpointer data;
+} JsonArenaCleanup;
+
+struct _JsonArena
+{
+  volatile gint ref_count;
+
+  /* documents that never leave the thread that created them do not
+   * need atomic reference counting
+   */
+  gboolean thread_local;
+  guint owner;
+
+  JsonArenaChunk *chunks;
+  gchar *cursor;
+  gchar *limit;
+
+  /* large allocations, released with g_free() */
+  GSList *large_blocks;
+
+  GArray *cleanups;
+};
+
+static JsonArenaChunk *
+json_arena_chunk_new (JsonArena *arena)
+{
+  JsonArenaChunk *chunk;
+  gpointer block = NULL;
+
+#if defined(HAVE_POSIX_MEMALIGN)
+  if (posix_memalign ((gpointer *) &chunk, ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE) != 0)
+    g_error ("%s: failed to allocate %d bytes", G_STRLOC, ARENA_CHUNK_SIZE);
+#elif defined(G_OS_WIN32)
+  chunk = _aligned_malloc (ARENA_CHUNK_SIZE, ARENA_CHUNK_SIZE);
+  if (chunk == NULL)
+    g_error ("%s: failed to allocate %d bytes", G_STRLOC, ARENA_CHUNK_SIZE);
+#else
+  block = g_malloc (ARENA_CHUNK_SIZE * 2);
+  chunk = (JsonArenaChunk *) (((guintptr) block + ARENA_CHUNK_SIZE - 1) & ~((guintptr) ARENA_CHUNK_SIZE - 1));
+#endif
+
+  chunk->arena = arena;
+  chunk->next = arena->chunks;
+  chunk->block = block;
+
+  arena->chunks = chunk;
+  arena->cursor = (gchar *) chunk + ARENA_ALIGN (sizeof (JsonArenaChunk));
+  arena->limit = (gchar *) chunk + ARENA_CHUNK_SIZE;
+
+  return chunk;
+}
+
+static void
+json_arena_chunk_free (JsonArenaChunk *chunk)
+{
+#if defined(HAVE_POSIX_MEMALIGN)
+  free (chunk);
+#elif defined(G_OS_WIN32)
+  _aligned_free (chunk);
+#else
+  g_free (chunk->block);
+#endif
+}
+
+/*< private >
+ * json_arena_new:
+ *
+ * Creates a new, empty arena.
+ *
+ * Returns: (transfer full): the newly created arena
+ */
+JsonArena *
+json_arena_new (void)
+{
+  JsonArena *arena;
+
+  arena = g_slice_new0 (JsonArena);
+  arena->ref_count = 1;
+  arena->cleanups = g_array_new (FALSE, FALSE, sizeof (JsonArenaCleanup));
+
+  return arena;
+}
+
+JsonArena *
+json_arena_ref (JsonArena *arena)
+{
+  g_return_val_if_fail (arena != NULL, NULL);
+  g_return_val_if_fail (arena->ref_count > 0, NULL);
+
+  if (arena->thread_local)
+    {
+      JSON_CHECK_THREAD (arena->owner, arena);
+      arena->ref_count++;
+    }
+  else
+    g_atomic_int_inc (&arena->ref_count);
+
+  return arena;
+}
+
+void
+json_arena_unref (JsonArena *arena)
+{
+  JsonArenaChunk *chunk;
+  guint i;
+
+  g_return_if_fail (arena != NULL);
+  g_return_if_fail (arena->ref_count > 0);
+
+  if (arena->thread_local)
+    {
+      JSON_CHECK_THREAD (arena->owner, arena);
+      if (--arena->ref_count != 0)
+        return;
+    }
+  else if (!g_atomic_int_dec_and_test (&arena->ref_count))
+    return;
+
+  for (i = 0; i < arena->cleanups->len; i++)
+    {
+      JsonArenaCleanup *cleanup = &g_array_index (arena->cleanups, JsonArenaCleanup, i);
+
+      cleanup->func (cleanup->data);
+    }
+
+  g_array_unref (arena->cleanups);
+
+  g_slist_free_full (arena->large_blocks, g_free);
+
+  chunk = arena->chunks;
+  while (chunk != NULL)
+    {
+      JsonArenaChunk *next = chunk->next;
+
+      json_arena_chunk_free (chunk);
+      chunk = next;
+    }
+
+  g_slice_free (JsonArena, arena);
+}
+
+/*< private >
+ * json_arena_set_thread_local:
+ * @arena: a #JsonArena
+ * @owner: the tag of the thread using @arena
+ *
+ * Marks @arena as used only by the thread with tag @owner, which allows
+ * using plain increments and decrements for its reference count.
+ */
+void
+json_arena_set_thread_local (JsonArena *arena,
+                             guint      owner)
+{
+  arena->thread_local = TRUE;
+  arena->owner = owner;
+}
+
+/*< private >
+ * json_arena_alloc:
+ * @arena: a #JsonArena
+ * @size: the size of the allocation
+ *
+ * Allocates @size bytes from the arena. The memory is cleared, and it
+ * is valid until the arena is destroyed.
+ *
+ * Returns: (transfer none): the allocated memory
+ */
+gpointer
+json_arena_alloc (JsonArena *arena,
+                  gsize      size)
+{
+  gpointer res;
+
+  size = ARENA_ALIGN (size);
+
+  if (size > ARENA_LARGE_SIZE)
+    {
+      res = g_malloc0 (size);
+      arena->large_blocks = g_slist_prepend (arena->large_blocks, res);
+      return res;
+    }
+
+  /* strings leave the cursor unaligned */
+  if (arena->chunks != NULL)
+    arena->cursor = (gchar *) ARENA_ALIGN ((guintptr) arena->cursor);
+
+  if (arena->chunks == NULL || (gsize) (arena->limit - arena->cursor) < size)
+    json_arena_chunk_new (arena);
+
+  res = arena->cursor;
+  arena->cursor += size;
+
+  memset (res, 0, size);
+
+  return res;
+}
+
+/*< private >
+ * json_arena_strndup:
+ * @arena: a #JsonArena
+ * @str: the string to copy
+ * @len: the length of @str
+ *
+ * Copies the first @len bytes of @str inside the arena, and
+ * nul-terminates the copy.
+ *
+ * Returns: (transfer none): the copy of @str
+ */
+gchar *
+json_arena_strndup (JsonArena   *arena,
+                    const gchar *str,
+                    gsize        len)
+{
+  gchar *res;
+
+  /* strings do not need to be aligned, or cleared */
+  if (len + 1 <= ARENA_LARGE_SIZE)
+    {
+      if (arena->chunks == NULL || (gsize) (arena->limit - arena->cursor) < len + 1)
+        json_arena_chunk_new (arena);
+
+      res = arena->cursor;
+      arena->cursor += len + 1;
+    }
+  else
+    {
+      res = g_malloc (len + 1);
+      arena->large_blocks = g_slist_prepend (arena->large_blocks, res);
+    }
+
+  memcpy (res, str, len);
+  res[len] = '\0';
+
+  return res;
+}
+
+/*< private >
+ * json_arena_add_cleanup:
+ * @arena: a #JsonArena
+ * @func: the function to call when the arena is destroyed
+ * @data: the data to pass to @func
+ *
+ * Registers a function to release resources that are associated to
+ * the data allocated in the arena, but that live outside of it.
+ */
+void
+json_arena_add_cleanup (JsonArena      *arena,
+                        GDestroyNotify  func,
+                        gpointer        data)
+{
+  JsonArenaCleanup cleanup = { func, data };
+
+  g_array_append_val (arena->cleanups, cleanup);
+}
+
+/*< private >
+ * json_arena_from_pointer:
+ * @data: a structure allocated with json_arena_alloc()
+ *
+ * Retrieves the arena that holds @data.
+ *
+ * Returns: (transfer none): the arena that holds @data
+ */
+JsonArena *
+json_arena_from_pointer (gconstpointer data)
+{
+  JsonArenaChunk *chunk;
+
+  chunk = (JsonArenaChunk *) ((guintptr) data & ~((guintptr) ARENA_CHUNK_SIZE - 1));
+
+  return chunk->arena;
+}
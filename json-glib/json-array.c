@@ -23,6 +23,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "json-types-private.h"
 
 /**
@@ -40,10 +42,254 @@
  * To extract an element at a given index, use json_array_get_element().
  * To retrieve the entire array in list form, use json_array_get_elements().
  * To retrieve the length of the array, use json_array_get_length().
+ *
+ * Arrays holding only integers, or only floating point numbers, store
+ * their values in a packed buffer instead of a #JsonNode per element.
+ * The #JsonParser creates packed arrays whenever it can, and so do
+ * json_array_add_int_element() and json_array_add_double_element() when
+ * called on an empty or packed array. The nodes of a packed array are
+ * only created when they are requested, for instance by calling
+ * json_array_get_element(); the values can be accessed without creating
+ * any node using json_array_get_int_element(), or all at once using
+ * json_array_peek_int_elements() and json_array_peek_double_elements().
  */
 
+/* the values of packed integer and double arrays share the buffer */
+G_STATIC_ASSERT (sizeof (gint64) == sizeof (gdouble));
+
+#define JSON_ARRAY_IS_PACKED(a)         ((a)->storage != JSON_ARRAY_STORAGE_NODES)
+
 G_DEFINE_BOXED_TYPE (JsonArray, json_array, json_array_ref, json_array_unref);
 
+static inline guint
+json_array_length (JsonArray *array)
+{
+  return JSON_ARRAY_IS_PACKED (array) ? array->packed_len : array->elements->len;
+}
+
+/* arrays inside an arena do not own the nodes of the same arena, which
+ * are released with it, but they own the nodes added to them afterwards
+ */
+static inline void
+json_array_release_node (JsonArray *array,
+                         JsonNode  *node)
+{
+  if (!array->in_arena || !node->in_arena ||
+      json_arena_from_pointer (node) != json_arena_from_pointer (array))
+    json_node_unref (node);
+}
+
+static void
+json_array_clear_packed (JsonArray *array)
+{
+  guint i;
+
+  if (array->nodes != NULL)
+    {
+      for (i = 0; i < array->packed_len; i++)
+        {
+          if (array->nodes[i] != NULL)
+            json_node_unref (array->nodes[i]);
+        }
+
+      g_free (array->nodes);
+      array->nodes = NULL;
+    }
+
+  g_free (array->packed.data);
+  array->packed.data = NULL;
+  array->packed_len = 0;
+  array->packed_size = 0;
+  array->storage = JSON_ARRAY_STORAGE_NODES;
+}
+
+/* makes room for @n_elements more packed values */
+static void
+json_array_grow_packed (JsonArray *array,
+                        guint      n_elements)
+{
+  guint new_size;
+
+  if (array->packed_len + n_elements <= array->packed_size)
+    return;
+
+  new_size = MAX (array->packed_size, 8);
+  while (new_size < array->packed_len + n_elements)
+    new_size *= 2;
+
+  array->packed.data = g_realloc (array->packed.data, new_size * sizeof (gint64));
+
+  if (array->nodes != NULL)
+    {
+      array->nodes = g_renew (JsonNode *, array->nodes, new_size);
+      memset (array->nodes + array->packed_size, 0,
+              (new_size - array->packed_size) * sizeof (JsonNode *));
+    }
+
+  array->packed_size = new_size;
+}
+
+static inline gboolean
+json_array_can_pack (JsonArray        *array,
+                     JsonArrayStorage  storage)
+{
+  if (array->storage == storage)
+    return TRUE;
+
+  return array->storage == JSON_ARRAY_STORAGE_NODES && array->elements->len == 0;
+}
+
+/* fills @scratch with the packed value at @index_ */
+static inline JsonNode *
+json_array_packed_value (JsonArray *array,
+                         guint      index_,
+                         JsonNode  *scratch)
+{
+  memset (scratch, 0, sizeof (JsonNode));
+  scratch->ref_count = 1;
+  scratch->type = JSON_NODE_VALUE;
+  scratch->immutable = TRUE;
+  scratch->parent = array->parent;
+
+  /* the elements belong to the same document as their array */
+  scratch->thread_local = array->thread_local;
+  scratch->owner = array->owner;
+
+  if (array->storage == JSON_ARRAY_STORAGE_INT)
+    {
+      scratch->value_type = JSON_VALUE_INT;
+      scratch->data.v_int = array->packed.v_int[index_];
+    }
+  else
+    {
+      scratch->value_type = JSON_VALUE_DOUBLE;
+      scratch->data.v_double = array->packed.v_double[index_];
+    }
+
+  return scratch;
+}
+
+/* creates the node of a packed element, if it does not exist yet; this
+ * does not modify the array as far as its users can tell, so it can be
+ * called concurrently from multiple threads
+ */
+static JsonNode *
+json_array_materialize (JsonArray *array,
+                        guint      index_)
+{
+  JsonNode **nodes;
+  JsonNode *node;
+  JsonNode scratch;
+
+  nodes = g_atomic_pointer_get (&array->nodes);
+  if (nodes == NULL)
+    {
+      nodes = g_new0 (JsonNode *, array->packed_size);
+
+      if (!g_atomic_pointer_compare_and_exchange (&array->nodes, NULL, nodes))
+        {
+          g_free (nodes);
+          nodes = g_atomic_pointer_get (&array->nodes);
+        }
+    }
+
+  node = g_atomic_pointer_get (&nodes[index_]);
+  if (node != NULL)
+    return node;
+
+  /* the nodes are allocated on the heap even for arrays inside an arena,
+   * as allocating from the arena is not thread safe
+   */
+  node = json_node_alloc ();
+  *node = *json_array_packed_value (array, index_, &scratch);
+  node->allocated = TRUE;
+  node->immutable = array->immutable;
+
+  if (!g_atomic_pointer_compare_and_exchange (&nodes[index_], NULL, node))
+    {
+      json_node_unref (node);
+      node = g_atomic_pointer_get (&nodes[index_]);
+    }
+
+  return node;
+}
+
+/* turns a packed array into an array of nodes */
+static void
+json_array_unpack (JsonArray *array)
+{
+  guint i;
+
+  if (!JSON_ARRAY_IS_PACKED (array))
+    return;
+
+  g_ptr_array_set_size (array->elements, 0);
+
+  for (i = 0; i < array->packed_len; i++)
+    {
+      JsonNode *node;
+
+      if (array->in_arena)
+        {
+          JsonNode scratch;
+
+          /* the arena does not release the nodes of its arrays */
+          node = json_node_alloc_in_arena (json_arena_from_pointer (array));
+          *node = *json_array_peek_element (array, i, &scratch);
+          node->ref_count = 1;
+          node->allocated = FALSE;
+          node->in_arena = TRUE;
+        }
+      else
+        node = json_node_ref (json_array_materialize (array, i));
+
+      g_ptr_array_add (array->elements, node);
+    }
+
+  json_array_clear_packed (array);
+}
+
+/* writes the values of the nodes created on demand, which may have been
+ * modified, back into the packed buffer; if any of them does not hold a
+ * value of the type of the array anymore, the array is unpacked
+ */
+static gboolean
+json_array_sync_packed (JsonArray *array)
+{
+  guint i;
+
+  if (array->immutable || array->nodes == NULL)
+    return TRUE;
+
+  for (i = 0; i < array->packed_len; i++)
+    {
+      JsonNode *node = array->nodes[i];
+
+      if (node == NULL)
+        continue;
+
+      if (array->storage == JSON_ARRAY_STORAGE_INT &&
+          JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_INT))
+        {
+          if (array->packed.v_int[i] != node->data.v_int)
+            array->packed.v_int[i] = node->data.v_int;
+        }
+      else if (array->storage == JSON_ARRAY_STORAGE_DOUBLE &&
+               JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_DOUBLE))
+        {
+          if (array->packed.v_double[i] != node->data.v_double)
+            array->packed.v_double[i] = node->data.v_double;
+        }
+      else
+        {
+          json_array_unpack (array);
+          return FALSE;
+        }
+    }
+
+  return TRUE;
+}
+
 /**
  * json_array_new: (constructor)
  *
@@ -85,6 +331,46 @@ json_array_sized_new (guint n_elements)
   return array;
 }
 
+static void
+json_array_free_arena_data (gpointer data)
+{
+  JsonArray *array = data;
+  guint i;
+
+  for (i = 0; i < array->elements->len; i++)
+    json_array_release_node (array, g_ptr_array_index (array->elements, i));
+
+  json_array_clear_packed (array);
+  g_ptr_array_free (array->elements, TRUE);
+}
+
+/*< private >
+ * json_array_new_in_arena:
+ * @arena: a #JsonArena
+ *
+ * Creates a new #JsonArray inside @arena.
+ *
+ * The array does not release the elements allocated inside @arena
+ * when it's destroyed, as they are released with the arena.
+ *
+ * Returns: (transfer none): the newly created #JsonArray
+ */
+JsonArray *
+json_array_new_in_arena (JsonArena *arena)
+{
+  JsonArray *array;
+
+  array = json_arena_alloc (arena, sizeof (JsonArray));
+
+  array->ref_count = 1;
+  array->in_arena = TRUE;
+  array->elements = g_ptr_array_new ();
+
+  json_arena_add_cleanup (arena, json_array_free_arena_data, array);
+
+  return array;
+}
+
 /**
  * json_array_ref:
  * @array: a #JsonArray
@@ -100,6 +386,13 @@ json_array_ref (JsonArray *array)
   g_return_val_if_fail (array != NULL, NULL);
   g_return_val_if_fail (array->ref_count > 0, NULL);
 
+  /* arrays inside an arena live as long as their document */
+  if (array->in_arena)
+    {
+      json_arena_ref (json_arena_from_pointer (array));
+      return array;
+    }
+
   array->ref_count++;
 
   return array;
@@ -119,6 +412,12 @@ json_array_unref (JsonArray *array)
   g_return_if_fail (array != NULL);
   g_return_if_fail (array->ref_count > 0);
 
+  if (array->in_arena)
+    {
+      json_arena_unref (json_arena_from_pointer (array));
+      return;
+    }
+
   if (--array->ref_count == 0)
     {
       guint i;
@@ -126,6 +425,7 @@ json_array_unref (JsonArray *array)
       for (i = 0; i < array->elements->len; i++)
         json_node_unref (g_ptr_array_index (array->elements, i));
 
+      json_array_clear_packed (array);
       g_ptr_array_free (array->elements, TRUE);
       array->elements = NULL;
 
@@ -155,7 +455,19 @@ json_array_seal (JsonArray *array)
   if (array->immutable)
     return;
 
-  /* Propagate to all members. */
+  /* Propagate to all members; the nodes of packed elements are sealed
+   * when they are created. */
+  if (JSON_ARRAY_IS_PACKED (array))
+    {
+      json_array_sync_packed (array);
+
+      for (i = 0; array->nodes != NULL && i < array->packed_len; i++)
+        {
+          if (array->nodes[i] != NULL)
+            json_node_seal (array->nodes[i]);
+        }
+    }
+
   for (i = 0; i < array->elements->len; i++)
     json_node_seal (g_ptr_array_index (array->elements, i));
 
@@ -202,9 +514,8 @@ json_array_get_elements (JsonArray *array)
   g_return_val_if_fail (array != NULL, NULL);
 
   retval = NULL;
-  for (i = 0; i < array->elements->len; i++)
-    retval = g_list_prepend (retval,
-                             g_ptr_array_index (array->elements, i));
+  for (i = 0; i < json_array_length (array); i++)
+    retval = g_list_prepend (retval, json_array_get_element (array, i));
 
   return g_list_reverse (retval);
 }
@@ -229,7 +540,7 @@ json_array_dup_element (JsonArray *array,
   JsonNode *retval;
 
   g_return_val_if_fail (array != NULL, NULL);
-  g_return_val_if_fail (index_ < array->elements->len, NULL);
+  g_return_val_if_fail (index_ < json_array_length (array), NULL);
 
   retval = json_array_get_element (array, index_);
   if (!retval)
@@ -246,6 +557,8 @@ json_array_dup_element (JsonArray *array,
  * Retrieves the #JsonNode containing the value of the element at @index_
  * inside a #JsonArray.
  *
+ * If @array is packed, the node is created the first time it is requested.
+ *
  * Return value: (transfer none): a pointer to the #JsonNode at the requested index
  */
 JsonNode *
@@ -253,11 +566,108 @@ json_array_get_element (JsonArray *array,
                         guint      index_)
 {
   g_return_val_if_fail (array != NULL, NULL);
-  g_return_val_if_fail (index_ < array->elements->len, NULL);
+  g_return_val_if_fail (index_ < json_array_length (array), NULL);
+
+  if (JSON_ARRAY_IS_PACKED (array))
+    return json_array_materialize (array, index_);
 
   return g_ptr_array_index (array->elements, index_);
 }
 
+/*< private >
+ * json_array_peek_element:
+ * @array: a #JsonArray
+ * @index_: the index of the element to retrieve
+ * @scratch: a #JsonNode to fill with the value of a packed element
+ *
+ * Retrieves the element at @index_ without creating a node for it, if
+ * @array is packed: the returned node is either the node that was
+ * already created for the element, or @scratch.
+ *
+ * Returns: (transfer none): the element at @index_
+ */
+JsonNode *
+json_array_peek_element (JsonArray *array,
+                         guint      index_,
+                         JsonNode  *scratch)
+{
+  JsonNode **nodes;
+  JsonNode *node;
+
+  if (!JSON_ARRAY_IS_PACKED (array))
+    return g_ptr_array_index (array->elements, index_);
+
+  nodes = g_atomic_pointer_get (&array->nodes);
+  if (nodes != NULL)
+    {
+      node = g_atomic_pointer_get (&nodes[index_]);
+      if (node != NULL)
+        return node;
+    }
+
+  return json_array_packed_value (array, index_, scratch);
+}
+
+/*< private >
+ * json_array_set_element_parent:
+ * @array: a packed #JsonArray
+ * @parent: (transfer none): the node holding @array
+ *
+ * Sets the parent of the nodes that are created for the packed elements
+ * of @array; they are thread-local if @parent is.
+ */
+void
+json_array_set_element_parent (JsonArray *array,
+                               JsonNode  *parent)
+{
+  array->parent = parent;
+  array->thread_local = parent->thread_local;
+  array->owner = parent->owner;
+}
+
+/*< private >
+ * json_array_copy_shared:
+ * @array: a #JsonArray
+ * @parent: the node that will hold the copy
+ *
+ * Creates a mutable copy of @array, whose elements are copies of the
+ * elements of @array created with json_node_share(); packed values are
+ * copied directly. The copy is inside the arena of @parent, if it has one.
+ *
+ * Returns: (transfer full): the copy of @array
+ */
+JsonArray *
+json_array_copy_shared (JsonArray *array,
+                        JsonNode  *parent)
+{
+  JsonArray *copy;
+  guint i;
+
+  if (parent->in_arena)
+    copy = json_array_new_in_arena (json_arena_from_pointer (parent));
+  else
+    copy = json_array_new ();
+
+  json_array_set_element_parent (copy, parent);
+
+  if (JSON_ARRAY_IS_PACKED (array) && json_array_sync_packed (array))
+    {
+      copy->storage = array->storage;
+      json_array_grow_packed (copy, array->packed_len);
+      memcpy (copy->packed.data, array->packed.data, array->packed_len * sizeof (gint64));
+      copy->packed_len = array->packed_len;
+
+      return copy;
+    }
+
+  g_ptr_array_set_size (copy->elements, array->elements->len);
+
+  for (i = 0; i < array->elements->len; i++)
+    copy->elements->pdata[i] = json_node_share (g_ptr_array_index (array->elements, i), parent);
+
+  return copy;
+}
+
 /**
  * json_array_get_int_element:
  * @array: a #JsonArray
@@ -276,12 +686,12 @@ gint64
 json_array_get_int_element (JsonArray *array,
                             guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, 0);
-  g_return_val_if_fail (index_ < array->elements->len, 0);
+  g_return_val_if_fail (index_ < json_array_length (array), 0);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, 0);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, 0);
 
@@ -306,12 +716,12 @@ gdouble
 json_array_get_double_element (JsonArray *array,
                                guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, 0.0);
-  g_return_val_if_fail (index_ < array->elements->len, 0.0);
+  g_return_val_if_fail (index_ < json_array_length (array), 0.0);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, 0.0);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, 0.0);
 
@@ -336,12 +746,12 @@ gboolean
 json_array_get_boolean_element (JsonArray *array,
                                 guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, FALSE);
-  g_return_val_if_fail (index_ < array->elements->len, FALSE);
+  g_return_val_if_fail (index_ < json_array_length (array), FALSE);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, FALSE);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, FALSE);
 
@@ -367,12 +777,12 @@ const gchar *
 json_array_get_string_element (JsonArray *array,
                                guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, NULL);
-  g_return_val_if_fail (index_ < array->elements->len, NULL);
+  g_return_val_if_fail (index_ < json_array_length (array), NULL);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, NULL);
   g_return_val_if_fail (JSON_NODE_HOLDS_VALUE (node) || JSON_NODE_HOLDS_NULL (node), NULL);
 
@@ -399,22 +809,22 @@ gboolean
 json_array_get_null_element (JsonArray *array,
                              guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, FALSE);
-  g_return_val_if_fail (index_ < array->elements->len, FALSE);
+  g_return_val_if_fail (index_ < json_array_length (array), FALSE);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, FALSE);
 
   if (JSON_NODE_HOLDS_NULL (node))
     return TRUE;
 
   if (JSON_NODE_HOLDS_ARRAY (node))
-    return json_node_get_array (node) == NULL;
+    return node->data.array == NULL;
 
   if (JSON_NODE_HOLDS_OBJECT (node))
-    return json_node_get_object (node) == NULL;
+    return node->data.object == NULL;
 
   return FALSE;
 }
@@ -437,12 +847,12 @@ JsonArray *
 json_array_get_array_element (JsonArray *array,
                               guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, NULL);
-  g_return_val_if_fail (index_ < array->elements->len, NULL);
+  g_return_val_if_fail (index_ < json_array_length (array), NULL);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, NULL);
   g_return_val_if_fail (JSON_NODE_HOLDS_ARRAY (node) || JSON_NODE_HOLDS_NULL (node), NULL);
 
@@ -470,12 +880,12 @@ JsonObject *
 json_array_get_object_element (JsonArray *array,
                                guint      index_)
 {
-  JsonNode *node;
+  JsonNode *node, scratch;
 
   g_return_val_if_fail (array != NULL, NULL);
-  g_return_val_if_fail (index_ < array->elements->len, NULL);
+  g_return_val_if_fail (index_ < json_array_length (array), NULL);
 
-  node = g_ptr_array_index (array->elements, index_);
+  node = json_array_peek_element (array, index_, &scratch);
   g_return_val_if_fail (node != NULL, NULL);
   g_return_val_if_fail (JSON_NODE_HOLDS_OBJECT (node) || JSON_NODE_HOLDS_NULL (node), NULL);
 
@@ -498,7 +908,7 @@ json_array_get_length (JsonArray *array)
 {
   g_return_val_if_fail (array != NULL, 0);
 
-  return array->elements->len;
+  return json_array_length (array);
 }
 
 /**
@@ -516,9 +926,58 @@ json_array_add_element (JsonArray *array,
   g_return_if_fail (array != NULL);
   g_return_if_fail (node != NULL);
 
+  json_array_unpack (array);
   g_ptr_array_add (array->elements, node);
 }
 
+/*< private >
+ * json_array_add_packed_int:
+ * @array: a #JsonArray
+ * @value: an integer value
+ *
+ * Appends @value to @array without creating a node for it, if @array
+ * is empty or it is a packed array of integers.
+ *
+ * Returns: %TRUE if @value was added
+ */
+gboolean
+json_array_add_packed_int (JsonArray *array,
+                           gint64     value)
+{
+  if (!json_array_can_pack (array, JSON_ARRAY_STORAGE_INT))
+    return FALSE;
+
+  array->storage = JSON_ARRAY_STORAGE_INT;
+  json_array_grow_packed (array, 1);
+  array->packed.v_int[array->packed_len++] = value;
+
+  return TRUE;
+}
+
+/*< private >
+ * json_array_add_packed_double:
+ * @array: a #JsonArray
+ * @value: a floating point value
+ *
+ * Appends @value to @array without creating a node for it, if @array
+ * is empty or it is a packed array of floating point numbers.
+ *
+ * Returns: %TRUE if @value was added
+ */
+gboolean
+json_array_add_packed_double (JsonArray *array,
+                              gdouble    value)
+{
+  if (!json_array_can_pack (array, JSON_ARRAY_STORAGE_DOUBLE))
+    return FALSE;
+
+  array->storage = JSON_ARRAY_STORAGE_DOUBLE;
+  json_array_grow_packed (array, 1);
+  array->packed.v_double[array->packed_len++] = value;
+
+  return TRUE;
+}
+
 /**
  * json_array_add_int_element:
  * @array: a #JsonArray
@@ -526,6 +985,9 @@ json_array_add_element (JsonArray *array,
  *
  * Conveniently adds an integer @value into @array
  *
+ * If @array is empty, or it only holds integers, @value is packed
+ * without creating a #JsonNode for it.
+ *
  * See also: json_array_add_element(), json_node_set_int()
  *
  * Since: 0.8
@@ -536,6 +998,9 @@ json_array_add_int_element (JsonArray *array,
 {
   g_return_if_fail (array != NULL);
 
+  if (json_array_add_packed_int (array, value))
+    return;
+
   json_array_add_element (array, json_node_init_int (json_node_alloc (), value));
 }
 
@@ -546,6 +1011,9 @@ json_array_add_int_element (JsonArray *array,
  *
  * Conveniently adds a floating point @value into @array
  *
+ * If @array is empty, or it only holds floating point numbers, @value
+ * is packed without creating a #JsonNode for it.
+ *
  * See also: json_array_add_element(), json_node_set_double()
  *
  * Since: 0.8
@@ -556,6 +1024,9 @@ json_array_add_double_element (JsonArray *array,
 {
   g_return_if_fail (array != NULL);
 
+  if (json_array_add_packed_double (array, value))
+    return;
+
   json_array_add_element (array, json_node_init_double (json_node_alloc (), value));
 }
 
@@ -704,10 +1175,14 @@ void
 json_array_remove_element (JsonArray *array,
                            guint      index_)
 {
+  JsonNode *node;
+
   g_return_if_fail (array != NULL);
-  g_return_if_fail (index_ < array->elements->len);
+  g_return_if_fail (index_ < json_array_length (array));
 
-  json_node_unref (g_ptr_array_remove_index (array->elements, index_));
+  json_array_unpack (array);
+  node = g_ptr_array_remove_index (array->elements, index_);
+  json_array_release_node (array, node);
 }
 
 /**
@@ -735,11 +1210,11 @@ json_array_foreach_element (JsonArray        *array,
   g_return_if_fail (array != NULL);
   g_return_if_fail (func != NULL);
 
-  for (i = 0; i < array->elements->len; i++)
+  for (i = 0; i < json_array_length (array); i++)
     {
       JsonNode *element_node;
 
-      element_node = g_ptr_array_index (array->elements, i);
+      element_node = json_array_get_element (array, i);
 
       (* func) (array, i, element_node, data);
     }
@@ -774,9 +1249,10 @@ json_array_hash (gconstpointer key)
     return array->immutable_hash;
 
   /* Otherwise, calculate the hash. */
-  for (i = 0; i < array->elements->len; i++)
+  for (i = 0; i < json_array_length (array); i++)
     {
-      JsonNode *node = g_ptr_array_index (array->elements, i);
+      JsonNode scratch;
+      JsonNode *node = json_array_peek_element (array, i, &scratch);
       hash ^= (i ^ json_node_hash (node));
     }
 
@@ -823,9 +1299,10 @@ json_array_equal (gconstpointer a,
   for (i = 0; i < length_a; i++)
     {
       JsonNode *child_a, *child_b;  /* unowned */
+      JsonNode scratch_a, scratch_b;
 
-      child_a = json_array_get_element (array_a, i);
-      child_b = json_array_get_element (array_b, i);
+      child_a = json_array_peek_element (array_a, i, &scratch_a);
+      child_b = json_array_peek_element (array_b, i, &scratch_b);
 
       if (!json_node_equal (child_a, child_b))
         return FALSE;
@@ -833,3 +1310,405 @@ json_array_equal (gconstpointer a,
 
   return TRUE;
 }
+
+/**
+ * json_array_peek_int_elements:
+ * @array: a #JsonArray
+ * @n_elements: (out) (optional): return location for the number of elements
+ *
+ * Retrieves the values of a packed array of integers, without creating
+ * a #JsonNode for each element.
+ *
+ * The returned buffer is only valid until @array, or any of its elements,
+ * is modified.
+ *
+ * Return value: (array length=n_elements) (transfer none) (nullable): the
+ *   values of the elements of @array, or %NULL if @array is not a packed
+ *   array of integers
+ *
+ * Since: 1.4
+ */
+const gint64 *
+json_array_peek_int_elements (JsonArray *array,
+                              guint     *n_elements)
+{
+  g_return_val_if_fail (array != NULL, NULL);
+
+  if (n_elements != NULL)
+    *n_elements = 0;
+
+  if (array->storage != JSON_ARRAY_STORAGE_INT || !json_array_sync_packed (array))
+    return NULL;
+
+  if (n_elements != NULL)
+    *n_elements = array->packed_len;
+
+  return array->packed.v_int;
+}
+
+/**
+ * json_array_peek_double_elements:
+ * @array: a #JsonArray
+ * @n_elements: (out) (optional): return location for the number of elements
+ *
+ * Retrieves the values of a packed array of floating point numbers,
+ * without creating a #JsonNode for each element.
+ *
+ * The returned buffer is only valid until @array, or any of its elements,
+ * is modified.
+ *
+ * Return value: (array length=n_elements) (transfer none) (nullable): the
+ *   values of the elements of @array, or %NULL if @array is not a packed
+ *   array of floating point numbers
+ *
+ * Since: 1.4
+ */
+const gdouble *
+json_array_peek_double_elements (JsonArray *array,
+                                 guint     *n_elements)
+{
+  g_return_val_if_fail (array != NULL, NULL);
+
+  if (n_elements != NULL)
+    *n_elements = 0;
+
+  if (array->storage != JSON_ARRAY_STORAGE_DOUBLE || !json_array_sync_packed (array))
+    return NULL;
+
+  if (n_elements != NULL)
+    *n_elements = array->packed_len;
+
+  return array->packed.v_double;
+}
+
+/* appends @n_elements empty slots to the nodes of @array */
+static JsonNode **
+json_array_append_nodes (JsonArray *array,
+                         guint      n_elements)
+{
+  guint len;
+
+  json_array_unpack (array);
+
+  len = array->elements->len;
+  g_ptr_array_set_size (array->elements, len + n_elements);
+
+  return (JsonNode **) array->elements->pdata + len;
+}
+
+/**
+ * json_array_add_int_elements:
+ * @array: a #JsonArray
+ * @values: (array length=n_values): the integer values to add
+ * @n_values: the number of values
+ *
+ * Appends all the integers in @values to @array, in order.
+ *
+ * If @array is empty, or it only holds integers, the values are copied
+ * in its packed buffer without creating a #JsonNode for each of them.
+ *
+ * See also: json_array_add_int_element()
+ *
+ * Since: 1.4
+ */
+void
+json_array_add_int_elements (JsonArray    *array,
+                             const gint64 *values,
+                             guint         n_values)
+{
+  JsonNode **nodes;
+  guint i;
+
+  g_return_if_fail (array != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  if (n_values == 0)
+    return;
+
+  if (json_array_can_pack (array, JSON_ARRAY_STORAGE_INT))
+    {
+      array->storage = JSON_ARRAY_STORAGE_INT;
+      json_array_grow_packed (array, n_values);
+      memcpy (array->packed.v_int + array->packed_len, values, n_values * sizeof (gint64));
+      array->packed_len += n_values;
+      return;
+    }
+
+  nodes = json_array_append_nodes (array, n_values);
+  for (i = 0; i < n_values; i++)
+    nodes[i] = json_node_init_int (json_node_alloc (), values[i]);
+}
+
+/**
+ * json_array_add_double_elements:
+ * @array: a #JsonArray
+ * @values: (array length=n_values): the floating point values to add
+ * @n_values: the number of values
+ *
+ * Appends all the floating point numbers in @values to @array, in order.
+ *
+ * If @array is empty, or it only holds floating point numbers, the
+ * values are copied in its packed buffer without creating a #JsonNode
+ * for each of them.
+ *
+ * See also: json_array_add_double_element()
+ *
+ * Since: 1.4
+ */
+void
+json_array_add_double_elements (JsonArray     *array,
+                                const gdouble *values,
+                                guint          n_values)
+{
+  JsonNode **nodes;
+  guint i;
+
+  g_return_if_fail (array != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  if (n_values == 0)
+    return;
+
+  if (json_array_can_pack (array, JSON_ARRAY_STORAGE_DOUBLE))
+    {
+      array->storage = JSON_ARRAY_STORAGE_DOUBLE;
+      json_array_grow_packed (array, n_values);
+      memcpy (array->packed.v_double + array->packed_len, values, n_values * sizeof (gdouble));
+      array->packed_len += n_values;
+      return;
+    }
+
+  nodes = json_array_append_nodes (array, n_values);
+  for (i = 0; i < n_values; i++)
+    nodes[i] = json_node_init_double (json_node_alloc (), values[i]);
+}
+
+/**
+ * json_array_add_string_elements:
+ * @array: a #JsonArray
+ * @values: (array length=n_values) (element-type utf8): the string
+ *   values to add
+ * @n_values: the number of values
+ *
+ * Appends all the strings in @values to @array, in order; %NULL strings
+ * are added as null elements.
+ *
+ * See also: json_array_add_string_element()
+ *
+ * Since: 1.4
+ */
+void
+json_array_add_string_elements (JsonArray           *array,
+                                const gchar * const *values,
+                                guint                n_values)
+{
+  JsonNode **nodes;
+  guint i;
+
+  g_return_if_fail (array != NULL);
+  g_return_if_fail (values != NULL || n_values == 0);
+
+  if (n_values == 0)
+    return;
+
+  nodes = json_array_append_nodes (array, n_values);
+  for (i = 0; i < n_values; i++)
+    {
+      JsonNode *node = json_node_alloc ();
+
+      if (values[i] != NULL)
+        json_node_init_string (node, values[i]);
+      else
+        json_node_init_null (node);
+
+      nodes[i] = node;
+    }
+}
+
+/**
+ * json_array_get_int_elements:
+ * @array: a #JsonArray
+ * @values: (out caller-allocates) (array length=n_values): return
+ *   location for the values
+ * @n_values: the number of elements to retrieve
+ *
+ * Retrieves the integer values of the first @n_values elements of
+ * @array, converting them like json_node_get_int() does.
+ *
+ * This is faster than calling json_array_get_int_element() for each
+ * element, and it does not create any #JsonNode for packed arrays.
+ *
+ * Return value: %TRUE if all the elements held a value or null, and
+ *   %FALSE if any of them held an object or an array, in which case
+ *   its value is set to 0
+ *
+ * Since: 1.4
+ */
+gboolean
+json_array_get_int_elements (JsonArray *array,
+                             gint64    *values,
+                             guint      n_values)
+{
+  gboolean res = TRUE;
+  guint i;
+
+  g_return_val_if_fail (array != NULL, FALSE);
+  g_return_val_if_fail (values != NULL || n_values == 0, FALSE);
+  g_return_val_if_fail (n_values <= json_array_length (array), FALSE);
+
+  if (JSON_ARRAY_IS_PACKED (array) && json_array_sync_packed (array))
+    {
+      if (array->storage == JSON_ARRAY_STORAGE_INT)
+        memcpy (values, array->packed.v_int, n_values * sizeof (gint64));
+      else
+        {
+          for (i = 0; i < n_values; i++)
+            values[i] = (gint64) array->packed.v_double[i];
+        }
+
+      return TRUE;
+    }
+
+  for (i = 0; i < n_values; i++)
+    {
+      JsonNode *node = g_ptr_array_index (array->elements, i);
+
+      values[i] = 0;
+
+      if (node->type == JSON_NODE_VALUE)
+        {
+          if (node->value_type == JSON_VALUE_INT)
+            values[i] = node->data.v_int;
+          else if (node->value_type == JSON_VALUE_DOUBLE)
+            values[i] = (gint64) node->data.v_double;
+          else if (node->value_type == JSON_VALUE_BOOLEAN)
+            values[i] = node->data.v_bool;
+        }
+      else if (node->type != JSON_NODE_NULL)
+        res = FALSE;
+    }
+
+  return res;
+}
+
+/**
+ * json_array_get_double_elements:
+ * @array: a #JsonArray
+ * @values: (out caller-allocates) (array length=n_values): return
+ *   location for the values
+ * @n_values: the number of elements to retrieve
+ *
+ * Retrieves the floating point values of the first @n_values elements
+ * of @array, converting them like json_node_get_double() does.
+ *
+ * This is faster than calling json_array_get_double_element() for each
+ * element, and it does not create any #JsonNode for packed arrays.
+ *
+ * Return value: %TRUE if all the elements held a value or null, and
+ *   %FALSE if any of them held an object or an array, in which case
+ *   its value is set to 0
+ *
+ * Since: 1.4
+ */
+gboolean
+json_array_get_double_elements (JsonArray *array,
+                                gdouble   *values,
+                                guint      n_values)
+{
+  gboolean res = TRUE;
+  guint i;
+
+  g_return_val_if_fail (array != NULL, FALSE);
+  g_return_val_if_fail (values != NULL || n_values == 0, FALSE);
+  g_return_val_if_fail (n_values <= json_array_length (array), FALSE);
+
+  if (JSON_ARRAY_IS_PACKED (array) && json_array_sync_packed (array))
+    {
+      if (array->storage == JSON_ARRAY_STORAGE_DOUBLE)
+        memcpy (values, array->packed.v_double, n_values * sizeof (gdouble));
+      else
+        {
+          for (i = 0; i < n_values; i++)
+            values[i] = (gdouble) array->packed.v_int[i];
+        }
+
+      return TRUE;
+    }
+
+  for (i = 0; i < n_values; i++)
+    {
+      JsonNode *node = g_ptr_array_index (array->elements, i);
+
+      values[i] = 0.0;
+
+      if (node->type == JSON_NODE_VALUE)
+        {
+          if (node->value_type == JSON_VALUE_DOUBLE)
+            values[i] = node->data.v_double;
+          else if (node->value_type == JSON_VALUE_INT)
+            values[i] = (gdouble) node->data.v_int;
+          else if (node->value_type == JSON_VALUE_BOOLEAN)
+            values[i] = (gdouble) node->data.v_bool;
+        }
+      else if (node->type != JSON_NODE_NULL)
+        res = FALSE;
+    }
+
+  return res;
+}
+
+/**
+ * json_array_get_string_elements:
+ * @array: a #JsonArray
+ * @values: (out caller-allocates) (array length=n_values) (element-type utf8) (transfer none):
+ *   return location for the values
+ * @n_values: the number of elements to retrieve
+ *
+ * Retrieves the string values of the first @n_values elements of
+ * @array; like json_array_get_string_element(), elements that do not
+ * hold a string are set to %NULL.
+ *
+ * The returned strings are owned by @array, and they are only valid
+ * until @array, or any of its elements, is modified.
+ *
+ * Return value: %TRUE if all the elements held a value or null, and
+ *   %FALSE if any of them held an object or an array
+ *
+ * Since: 1.4
+ */
+gboolean
+json_array_get_string_elements (JsonArray    *array,
+                                const gchar **values,
+                                guint         n_values)
+{
+  gboolean res = TRUE;
+  guint i;
+
+  g_return_val_if_fail (array != NULL, FALSE);
+  g_return_val_if_fail (values != NULL || n_values == 0, FALSE);
+  g_return_val_if_fail (n_values <= json_array_length (array), FALSE);
+
+  /* packed arrays do not hold any string */
+  if (JSON_ARRAY_IS_PACKED (array) && json_array_sync_packed (array))
+    {
+      memset (values, 0, n_values * sizeof (const gchar *));
+      return TRUE;
+    }
+
+  for (i = 0; i < n_values; i++)
+    {
+      JsonNode *node = g_ptr_array_index (array->elements, i);
+
+      if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_STRING))
+        values[i] = JSON_NODE_PEEK_STRING (node);
+      else
+        {
+          values[i] = NULL;
+
+          if (node->type != JSON_NODE_VALUE && node->type != JSON_NODE_NULL)
+            res = FALSE;
+        }
+    }
+
+  return res;
+}
@@ -53,11 +53,13 @@ struct _JsonBuilderPrivate
   GQueue *stack;
   JsonNode *root;
   gboolean immutable;
+  gboolean thread_local;
 };
 
 enum
 {
   PROP_IMMUTABLE = 1,
+  PROP_THREAD_LOCAL,
   PROP_LAST
 };
 
@@ -157,6 +159,10 @@ json_builder_set_property (GObject      *gobject,
       /* Construct-only. */
       priv->immutable = g_value_get_boolean (value);
       break;
+    case PROP_THREAD_LOCAL:
+      /* Construct-only. */
+      priv->thread_local = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -176,6 +182,9 @@ json_builder_get_property (GObject    *gobject,
     case PROP_IMMUTABLE:
       g_value_set_boolean (value, priv->immutable);
       break;
+    case PROP_THREAD_LOCAL:
+      g_value_set_boolean (value, priv->thread_local);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -203,6 +212,26 @@ json_builder_class_init (JsonBuilderClass *klass)
                           FALSE,
                           G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
 
+  /**
+   * JsonBuilder:thread-local:
+   *
+   * Whether the #JsonNode tree built by the #JsonBuilder is only going to
+   * be used by the thread that built it, which makes acquiring and
+   * releasing references on its nodes cheaper.
+   *
+   * The nodes passed to json_builder_add_value() become part of the
+   * tree, unless they are referenced from elsewhere as well. See
+   * json_node_is_thread_local().
+   *
+   * Since: 1.4
+   */
+  builder_props[PROP_THREAD_LOCAL] =
+    g_param_spec_boolean ("thread-local",
+                          "Thread Local",
+                          "Whether the builder output is only used by one thread.",
+                          FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+
   gobject_class->set_property = json_builder_set_property;
   gobject_class->get_property = json_builder_get_property;
   gobject_class->finalize = json_builder_finalize;
@@ -282,7 +311,12 @@ json_builder_get_root (JsonBuilder *builder)
   g_return_val_if_fail (JSON_IS_BUILDER (builder), NULL);
 
   if (builder->priv->root)
-    root = json_node_copy (builder->priv->root);
+    {
+      root = json_node_copy (builder->priv->root);
+
+      if (builder->priv->thread_local)
+        json_node_set_thread_local (root, builder->priv->root->owner);
+    }
 
   /* Sanity check. */
   g_return_val_if_fail (!builder->priv->immutable ||
@@ -398,6 +432,10 @@ json_builder_end_object (JsonBuilder *builder)
 
   json_builder_state_free (state);
 
+  /* the containers of a complete tree are only referenced by its nodes */
+  if (builder->priv->thread_local && builder->priv->root != NULL)
+    json_node_set_thread_local (builder->priv->root, json_thread_get_tag ());
+
   return builder;
 }
 
@@ -492,6 +530,10 @@ json_builder_end_array (JsonBuilder *builder)
 
   json_builder_state_free (state);
 
+  /* the containers of a complete tree are only referenced by its nodes */
+  if (builder->priv->thread_local && builder->priv->root != NULL)
+    json_node_set_thread_local (builder->priv->root, json_thread_get_tag ());
+
   return builder;
 }
 
@@ -802,3 +844,114 @@ json_builder_add_null_value (JsonBuilder *builder)
 
   return builder;
 }
+
+/**
+ * json_builder_add_int_values:
+ * @builder: a #JsonBuilder
+ * @values: (array length=n_values): the integers to add
+ * @n_values: the number of values
+ *
+ * Adds all the integers in @values as elements of the most recent
+ * opened array, in order.
+ *
+ * This is equivalent to calling json_builder_add_int_value() for each
+ * value, but faster.
+ *
+ * See also: json_array_add_int_elements()
+ *
+ * Return value: (nullable) (transfer none): the #JsonBuilder, or %NULL if
+ * the call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonBuilder *
+json_builder_add_int_values (JsonBuilder  *builder,
+                             const gint64 *values,
+                             guint         n_values)
+{
+  JsonBuilderState *state;
+
+  g_return_val_if_fail (JSON_IS_BUILDER (builder), NULL);
+  g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+  g_return_val_if_fail (!g_queue_is_empty (builder->priv->stack), NULL);
+  g_return_val_if_fail (json_builder_current_mode (builder) == JSON_BUILDER_MODE_ARRAY, NULL);
+
+  state = g_queue_peek_head (builder->priv->stack);
+  json_array_add_int_elements (state->data.array, values, n_values);
+
+  return builder;
+}
+
+/**
+ * json_builder_add_double_values:
+ * @builder: a #JsonBuilder
+ * @values: (array length=n_values): the floating point numbers to add
+ * @n_values: the number of values
+ *
+ * Adds all the floating point numbers in @values as elements of the most recent
+ * opened array, in order.
+ *
+ * This is equivalent to calling json_builder_add_double_value() for each
+ * value, but faster.
+ *
+ * See also: json_array_add_double_elements()
+ *
+ * Return value: (nullable) (transfer none): the #JsonBuilder, or %NULL if
+ * the call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonBuilder *
+json_builder_add_double_values (JsonBuilder   *builder,
+                                const gdouble *values,
+                                guint          n_values)
+{
+  JsonBuilderState *state;
+
+  g_return_val_if_fail (JSON_IS_BUILDER (builder), NULL);
+  g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+  g_return_val_if_fail (!g_queue_is_empty (builder->priv->stack), NULL);
+  g_return_val_if_fail (json_builder_current_mode (builder) == JSON_BUILDER_MODE_ARRAY, NULL);
+
+  state = g_queue_peek_head (builder->priv->stack);
+  json_array_add_double_elements (state->data.array, values, n_values);
+
+  return builder;
+}
+
+/**
+ * json_builder_add_string_values:
+ * @builder: a #JsonBuilder
+ * @values: (array length=n_values) (element-type utf8): the strings to add
+ * @n_values: the number of values
+ *
+ * Adds all the strings in @values as elements of the most recent
+ * opened array, in order; %NULL strings are added as null elements.
+ *
+ * This is equivalent to calling json_builder_add_string_value() for each
+ * value, but faster.
+ *
+ * See also: json_array_add_string_elements()
+ *
+ * Return value: (nullable) (transfer none): the #JsonBuilder, or %NULL if
+ * the call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonBuilder *
+json_builder_add_string_values (JsonBuilder         *builder,
+                                const gchar * const *values,
+                                guint                n_values)
+{
+  JsonBuilderState *state;
+
+  g_return_val_if_fail (JSON_IS_BUILDER (builder), NULL);
+  g_return_val_if_fail (values != NULL || n_values == 0, NULL);
+  g_return_val_if_fail (!g_queue_is_empty (builder->priv->stack), NULL);
+  g_return_val_if_fail (json_builder_current_mode (builder) == JSON_BUILDER_MODE_ARRAY, NULL);
+
+  state = g_queue_peek_head (builder->priv->stack);
+  json_array_add_string_elements (state->data.array, values, n_values);
+
+  return builder;
+}
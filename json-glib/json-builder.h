@@ -116,6 +116,18 @@ JsonBuilder *json_builder_add_string_value   (JsonBuilder  *builder,
                                               const gchar  *value);
 JSON_AVAILABLE_IN_1_0
 JsonBuilder *json_builder_add_null_value     (JsonBuilder  *builder);
+JSON_AVAILABLE_IN_1_4
+JsonBuilder *json_builder_add_int_values     (JsonBuilder  *builder,
+                                              const gint64 *values,
+                                              guint         n_values);
+JSON_AVAILABLE_IN_1_4
+JsonBuilder *json_builder_add_double_values  (JsonBuilder   *builder,
+                                              const gdouble *values,
+                                              guint          n_values);
+JSON_AVAILABLE_IN_1_4
+JsonBuilder *json_builder_add_string_values  (JsonBuilder  *builder,
+                                              const gchar * const *values,
+                                              guint         n_values);
 
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonBuilder, g_object_unref)
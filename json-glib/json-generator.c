@@ -38,6 +38,17 @@
 
 #include "json-generator.h"
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_GENERATOR_USE_SSE2 1
+
+#if defined(__GNUC__)
+#define json_ctz(x)             __builtin_ctz (x)
+#else
+#define json_ctz(x)             g_bit_nth_lsf ((x), -1)
+#endif
+#endif
+
 struct _JsonGeneratorPrivate
 {
   JsonNode *root;
@@ -60,15 +71,30 @@ enum
   PROP_LAST
 };
 
+/* the size of the buffer used when writing to a stream */
+#define WRITE_BUFFER_SIZE       (64 * 1024)
+
+typedef struct
+{
+  GString *buffer;
+
+  /* when writing to a stream, the buffer is written out whenever it
+   * fills up, instead of holding the whole document
+   */
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error;
+} DumpState;
+
 static void   dump_value  (GString       *buffer,
                            gint           level,
                            JsonNode      *node);
 static void   dump_array  (JsonGenerator *generator,
-                           GString       *buffer,
+                           DumpState     *state,
                            gint           level,
                            JsonArray     *array);
 static void   dump_object (JsonGenerator *generator,
-                           GString       *buffer,
+                           DumpState     *state,
                            gint           level,
                            JsonObject    *object);
 
@@ -76,52 +102,791 @@ static GParamSpec *generator_props[PROP_LAST] = { NULL, };
 
 G_DEFINE_TYPE_WITH_PRIVATE (JsonGenerator, json_generator, G_TYPE_OBJECT)
 
-static void
+/* quotes, backslashes, control characters and DEL are escaped */
+#define needs_escape(c)         ((guchar) (c) < 0x20 || (c) == '"' || (c) == '\\' || (c) == 0x7f)
+
+/*
+ * json_skip_unescaped:
+ * @p: the current position inside a string
+ * @end: the end of the string
+ *
+ * Skips the bytes of a string that can be copied verbatim.
+ *
+ * Returns: the position of the first byte that needs to be escaped,
+ *   or @end
+ */
+static inline const gchar *
+json_skip_unescaped (const gchar *p,
+                     const gchar *end)
+{
+#ifdef JSON_GENERATOR_USE_SSE2
+  const __m128i quote = _mm_set1_epi8 ('"');
+  const __m128i backslash = _mm_set1_epi8 ('\\');
+  const __m128i del = _mm_set1_epi8 (0x7f);
+  const __m128i control = _mm_set1_epi8 (0x1f);
+
+  while (end - p >= 16)
+    {
+      __m128i block = _mm_loadu_si128 ((const __m128i *) p);
+      __m128i special;
+      int mask;
+
+      /* there is no unsigned comparison, but the unsigned maximum of
+       * a control character and 0x1f is 0x1f; the bytes of multi-byte
+       * UTF-8 sequences are copied verbatim
+       */
+      special = _mm_or_si128 (_mm_cmpeq_epi8 (block, quote),
+                              _mm_cmpeq_epi8 (block, backslash));
+      special = _mm_or_si128 (special, _mm_cmpeq_epi8 (block, del));
+      special = _mm_or_si128 (special,
+                              _mm_cmpeq_epi8 (_mm_max_epu8 (block, control), control));
+
+      mask = _mm_movemask_epi8 (special);
+      if (mask != 0)
+        return p + json_ctz (mask);
+
+      p += 16;
+    }
+#else
+  while (end - p >= 8)
+    {
+      const guint64 ones = G_GUINT64_CONSTANT (0x0101010101010101);
+      const guint64 highs = G_GUINT64_CONSTANT (0x8080808080808080);
+      guint64 word, quote, backslash, del;
+
+      memcpy (&word, p, sizeof (guint64));
+
+      quote = word ^ (ones * '"');
+      backslash = word ^ (ones * '\\');
+      del = word ^ (ones * 0x7f);
+
+      if ((((quote - ones) & ~quote) |
+           ((backslash - ones) & ~backslash) |
+           ((del - ones) & ~del) |
+           ((word - ones * 0x20) & ~word)) & highs)
+        break;
+
+      p += 8;
+    }
+#endif
+
+  while (p < end && !needs_escape (*p))
+    p++;
+
+  return p;
+}
+
+/*< private >
+ * json_strescape:
+ * @output: the buffer to append to
+ * @str: a nul-terminated UTF-8 string
+ *
+ * Appends @str to @output, escaped for use inside a JSON string.
+ */
+void
 json_strescape (GString     *output,
                 const gchar *str)
 {
-  const gchar *p;
+  static const gchar hex_digits[] = "0123456789abcdef";
+  const gchar *p = str;
   const gchar *end;
-  gsize len;
 
-  len = strlen (str);
-  end = str + len;
+  end = str + strlen (str);
+
+  while (p < end)
+    {
+      const gchar *run = json_skip_unescaped (p, end);
+      gchar escape[6] = { '\\', 'u', '0', '0', };
+
+      /* copy the longest run that needs no escaping at once */
+      if (run != p)
+        {
+          g_string_append_len (output, p, run - p);
+          p = run;
+
+          if (p == end)
+            break;
+        }
+
+      switch (*p)
+        {
+        case '"':
+        case '\\':
+          escape[1] = *p;
+          g_string_append_len (output, escape, 2);
+          break;
+        case '\b':
+          g_string_append (output, "\\b");
+          break;
+        case '\f':
+          g_string_append (output, "\\f");
+          break;
+        case '\n':
+          g_string_append (output, "\\n");
+          break;
+        case '\r':
+          g_string_append (output, "\\r");
+          break;
+        case '\t':
+          g_string_append (output, "\\t");
+          break;
+        default:
+          escape[4] = hex_digits[(guchar) *p >> 4];
+          escape[5] = hex_digits[(guchar) *p & 0xf];
+          g_string_append_len (output, escape, 6);
+          break;
+        }
+
+      p++;
+    }
+}
+
+/* Doubles are formatted with the Grisu2 algorithm, by Florian Loitsch,
+ * from "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers"; it generates the shortest, or very close to the shortest,
+ * digits that are read back as the same double, using only 64-bit
+ * integer arithmetic.
+ */
+
+/* a floating point number, f * 2^e */
+typedef struct
+{
+  guint64 f;
+  gint e;
+} DiyFp;
+
+#define DP_SIGNIFICAND_SIZE     52
+#define DP_EXPONENT_BIAS        (0x3ff + DP_SIGNIFICAND_SIZE)
+#define DP_HIDDEN_BIT           G_GUINT64_CONSTANT (0x0010000000000000)
+
+/* the normalized powers of ten from 10^-348 to 10^340, in steps of 8 */
+static const guint64 cached_powers_f[] = {
+  G_GUINT64_CONSTANT (0xfa8fd5a0081c0288), G_GUINT64_CONSTANT (0xbaaee17fa23ebf76), G_GUINT64_CONSTANT (0x8b16fb203055ac76),
+  G_GUINT64_CONSTANT (0xcf42894a5dce35ea), G_GUINT64_CONSTANT (0x9a6bb0aa55653b2d), G_GUINT64_CONSTANT (0xe61acf033d1a45df),
+  G_GUINT64_CONSTANT (0xab70fe17c79ac6ca), G_GUINT64_CONSTANT (0xff77b1fcbebcdc4f), G_GUINT64_CONSTANT (0xbe5691ef416bd60c),
+  G_GUINT64_CONSTANT (0x8dd01fad907ffc3c), G_GUINT64_CONSTANT (0xd3515c2831559a83), G_GUINT64_CONSTANT (0x9d71ac8fada6c9b5),
+  G_GUINT64_CONSTANT (0xea9c227723ee8bcb), G_GUINT64_CONSTANT (0xaecc49914078536d), G_GUINT64_CONSTANT (0x823c12795db6ce57),
+  G_GUINT64_CONSTANT (0xc21094364dfb5637), G_GUINT64_CONSTANT (0x9096ea6f3848984f), G_GUINT64_CONSTANT (0xd77485cb25823ac7),
+  G_GUINT64_CONSTANT (0xa086cfcd97bf97f4), G_GUINT64_CONSTANT (0xef340a98172aace5), G_GUINT64_CONSTANT (0xb23867fb2a35b28e),
+  G_GUINT64_CONSTANT (0x84c8d4dfd2c63f3b), G_GUINT64_CONSTANT (0xc5dd44271ad3cdba), G_GUINT64_CONSTANT (0x936b9fcebb25c996),
+  G_GUINT64_CONSTANT (0xdbac6c247d62a584), G_GUINT64_CONSTANT (0xa3ab66580d5fdaf6), G_GUINT64_CONSTANT (0xf3e2f893dec3f126),
+  G_GUINT64_CONSTANT (0xb5b5ada8aaff80b8), G_GUINT64_CONSTANT (0x87625f056c7c4a8b), G_GUINT64_CONSTANT (0xc9bcff6034c13053),
+  G_GUINT64_CONSTANT (0x964e858c91ba2655), G_GUINT64_CONSTANT (0xdff9772470297ebd), G_GUINT64_CONSTANT (0xa6dfbd9fb8e5b88f),
+  G_GUINT64_CONSTANT (0xf8a95fcf88747d94), G_GUINT64_CONSTANT (0xb94470938fa89bcf), G_GUINT64_CONSTANT (0x8a08f0f8bf0f156b),
+  G_GUINT64_CONSTANT (0xcdb02555653131b6), G_GUINT64_CONSTANT (0x993fe2c6d07b7fac), G_GUINT64_CONSTANT (0xe45c10c42a2b3b06),
+  G_GUINT64_CONSTANT (0xaa242499697392d3), G_GUINT64_CONSTANT (0xfd87b5f28300ca0e), G_GUINT64_CONSTANT (0xbce5086492111aeb),
+  G_GUINT64_CONSTANT (0x8cbccc096f5088cc), G_GUINT64_CONSTANT (0xd1b71758e219652c), G_GUINT64_CONSTANT (0x9c40000000000000),
+  G_GUINT64_CONSTANT (0xe8d4a51000000000), G_GUINT64_CONSTANT (0xad78ebc5ac620000), G_GUINT64_CONSTANT (0x813f3978f8940984),
+  G_GUINT64_CONSTANT (0xc097ce7bc90715b3), G_GUINT64_CONSTANT (0x8f7e32ce7bea5c70), G_GUINT64_CONSTANT (0xd5d238a4abe98068),
+  G_GUINT64_CONSTANT (0x9f4f2726179a2245), G_GUINT64_CONSTANT (0xed63a231d4c4fb27), G_GUINT64_CONSTANT (0xb0de65388cc8ada8),
+  G_GUINT64_CONSTANT (0x83c7088e1aab65db), G_GUINT64_CONSTANT (0xc45d1df942711d9a), G_GUINT64_CONSTANT (0x924d692ca61be758),
+  G_GUINT64_CONSTANT (0xda01ee641a708dea), G_GUINT64_CONSTANT (0xa26da3999aef774a), G_GUINT64_CONSTANT (0xf209787bb47d6b85),
+  G_GUINT64_CONSTANT (0xb454e4a179dd1877), G_GUINT64_CONSTANT (0x865b86925b9bc5c2), G_GUINT64_CONSTANT (0xc83553c5c8965d3d),
+  G_GUINT64_CONSTANT (0x952ab45cfa97a0b3), G_GUINT64_CONSTANT (0xde469fbd99a05fe3), G_GUINT64_CONSTANT (0xa59bc234db398c25),
+  G_GUINT64_CONSTANT (0xf6c69a72a3989f5c), G_GUINT64_CONSTANT (0xb7dcbf5354e9bece), G_GUINT64_CONSTANT (0x88fcf317f22241e2),
+  G_GUINT64_CONSTANT (0xcc20ce9bd35c78a5), G_GUINT64_CONSTANT (0x98165af37b2153df), G_GUINT64_CONSTANT (0xe2a0b5dc971f303a),
+  G_GUINT64_CONSTANT (0xa8d9d1535ce3b396), G_GUINT64_CONSTANT (0xfb9b7cd9a4a7443c), G_GUINT64_CONSTANT (0xbb764c4ca7a44410),
+  G_GUINT64_CONSTANT (0x8bab8eefb6409c1a), G_GUINT64_CONSTANT (0xd01fef10a657842c), G_GUINT64_CONSTANT (0x9b10a4e5e9913129),
+  G_GUINT64_CONSTANT (0xe7109bfba19c0c9d), G_GUINT64_CONSTANT (0xac2820d9623bf429), G_GUINT64_CONSTANT (0x80444b5e7aa7cf85),
+  G_GUINT64_CONSTANT (0xbf21e44003acdd2d), G_GUINT64_CONSTANT (0x8e679c2f5e44ff8f), G_GUINT64_CONSTANT (0xd433179d9c8cb841),
+  G_GUINT64_CONSTANT (0x9e19db92b4e31ba9), G_GUINT64_CONSTANT (0xeb96bf6ebadf77d9), G_GUINT64_CONSTANT (0xaf87023b9bf0ee6b)
+};
+
+static const gint16 cached_powers_e[] = {
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+  -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+  -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+  -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+  -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+  109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+  375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+  641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+  907, 933, 960, 986, 1013, 1039, 1066
+};
+
+static const guint32 powers_of_ten[] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+static inline DiyFp
+diy_fp_multiply (DiyFp x,
+                 DiyFp y)
+{
+  const guint64 mask = G_GUINT64_CONSTANT (0xffffffff);
+  guint64 a = x.f >> 32, b = x.f & mask;
+  guint64 c = y.f >> 32, d = y.f & mask;
+  guint64 ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  guint64 tmp;
+  DiyFp res;
+
+  /* round the lower 64 bits of the product */
+  tmp = (bd >> 32) + (ad & mask) + (bc & mask) + (G_GUINT64_CONSTANT (1) << 31);
+
+  res.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+  res.e = x.e + y.e + 64;
+
+  return res;
+}
+
+static inline DiyFp
+diy_fp_normalize (DiyFp x)
+{
+  while ((x.f & (G_GUINT64_CONSTANT (1) << 63)) == 0)
+    {
+      x.f <<= 1;
+      x.e -= 1;
+    }
+
+  return x;
+}
+
+/* the boundaries of the interval of the numbers that are rounded to
+ * @v, normalized to the same exponent
+ */
+static inline void
+diy_fp_boundaries (DiyFp  v,
+                   DiyFp *minus,
+                   DiyFp *plus)
+{
+  DiyFp p, m;
+
+  p.f = (v.f << 1) + 1;
+  p.e = v.e - 1;
+  p = diy_fp_normalize (p);
+
+  /* the interval is asymmetric at powers of two */
+  if (v.f == DP_HIDDEN_BIT)
+    {
+      m.f = (v.f << 2) - 1;
+      m.e = v.e - 2;
+    }
+  else
+    {
+      m.f = (v.f << 1) - 1;
+      m.e = v.e - 1;
+    }
+
+  m.f <<= m.e - p.e;
+  m.e = p.e;
+
+  *minus = m;
+  *plus = p;
+}
+
+/* the cached power of ten c = 10^-k, so that the exponent of the
+ * product of c and a number with the exponent @e is in [-60, -32]
+ */
+static inline DiyFp
+cached_power (gint  e,
+              gint *k)
+{
+  gdouble dk = (-61 - e) * 0.30102999566398114 + 347;
+  gint ik = (gint) dk;
+  guint index;
+  DiyFp res;
+
+  if (dk - ik > 0.0)
+    ik += 1;
+
+  index = (guint) ((ik >> 3) + 1);
+
+  *k = -(-348 + (gint) index * 8);
+
+  res.f = cached_powers_f[index];
+  res.e = cached_powers_e[index];
+
+  return res;
+}
+
+static inline guint
+count_digits (guint32 n)
+{
+  guint i;
+
+  for (i = 1; i < G_N_ELEMENTS (powers_of_ten); i++)
+    if (n < powers_of_ten[i])
+      return i;
+
+  return G_N_ELEMENTS (powers_of_ten);
+}
+
+/* moves the last digit towards the actual value, as long as it stays
+ * inside the rounding interval
+ */
+static inline void
+grisu_round (gchar   *buffer,
+             guint    len,
+             guint64  delta,
+             guint64  rest,
+             guint64  ten_kappa,
+             guint64  wp_w)
+{
+  while (rest < wp_w && delta - rest >= ten_kappa &&
+         (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+      buffer[len - 1] -= 1;
+      rest += ten_kappa;
+    }
+}
+
+static guint
+grisu_digits (DiyFp  w,
+              DiyFp  mp,
+              guint64 delta,
+              gchar *buffer,
+              gint  *k)
+{
+  const gint shift = -mp.e;
+  const guint64 one = G_GUINT64_CONSTANT (1) << shift;
+  const guint64 wp_w = mp.f - w.f;
+  guint32 p1 = (guint32) (mp.f >> shift);
+  guint64 p2 = mp.f & (one - 1);
+  guint kappa = count_digits (p1);
+  guint len = 0;
+
+  /* the integral part */
+  while (kappa > 0)
+    {
+      guint32 d = p1 / powers_of_ten[kappa - 1];
+      guint64 rest;
+
+      p1 %= powers_of_ten[kappa - 1];
+
+      if (d != 0 || len != 0)
+        buffer[len++] = '0' + d;
 
-  for (p = str; p < end; p++)
+      kappa -= 1;
+
+      rest = ((guint64) p1 << shift) + p2;
+      if (rest <= delta)
+        {
+          *k += kappa;
+          grisu_round (buffer, len, delta, rest,
+                       (guint64) powers_of_ten[kappa] << shift,
+                       wp_w);
+          return len;
+        }
+    }
+
+  /* the fractional part */
+  for (;;)
     {
-      if (*p == '\\' || *p == '"')
+      guint d;
+
+      p2 *= 10;
+      delta *= 10;
+
+      d = (guint) (p2 >> shift);
+      if (d != 0 || len != 0)
+        buffer[len++] = '0' + d;
+
+      p2 &= one - 1;
+      kappa += 1;
+
+      if (p2 < delta)
         {
-          g_string_append_c (output, '\\');
-          g_string_append_c (output, *p);
+          *k -= kappa;
+          grisu_round (buffer, len, delta, p2, one,
+                       kappa < G_N_ELEMENTS (powers_of_ten) ? wp_w * powers_of_ten[kappa] : 0);
+          return len;
         }
-      else if ((*p > 0 && *p < 0x1f) || *p == 0x7f)
+    }
+}
+
+/* writes the digits of a positive, finite @value to @buffer, and
+ * returns their number; @value is the digits times 10^@k
+ */
+static guint
+grisu2 (guint64  bits,
+        gchar   *buffer,
+        gint    *k)
+{
+  guint64 significand = bits & (DP_HIDDEN_BIT - 1);
+  gint biased_e = (gint) ((bits >> DP_SIGNIFICAND_SIZE) & 0x7ff);
+  DiyFp v, w, minus, plus, c_mk;
+
+  if (biased_e != 0)
+    {
+      v.f = significand + DP_HIDDEN_BIT;
+      v.e = biased_e - DP_EXPONENT_BIAS;
+    }
+  else
+    {
+      /* subnormal */
+      v.f = significand;
+      v.e = 1 - DP_EXPONENT_BIAS;
+    }
+
+  diy_fp_boundaries (v, &minus, &plus);
+
+  c_mk = cached_power (plus.e, k);
+
+  w = diy_fp_multiply (diy_fp_normalize (v), c_mk);
+  plus = diy_fp_multiply (plus, c_mk);
+  minus = diy_fp_multiply (minus, c_mk);
+
+  /* stay on the safe side of the imprecision of the products */
+  plus.f -= 1;
+  minus.f += 1;
+
+  return grisu_digits (w, plus, plus.f - minus.f, buffer, k);
+}
+
+/*< private >
+ * json_append_int:
+ * @output: the buffer to append to
+ * @value: an integer
+ *
+ * Appends the JSON representation of @value to @output.
+ */
+void
+json_append_int (GString *output,
+                 gint64   value)
+{
+  gchar buf[24];
+  gchar *p = buf + sizeof (buf);
+  guint64 n;
+
+  /* negate as unsigned, so that G_MININT64 does not overflow */
+  n = value < 0 ? -(guint64) value : (guint64) value;
+
+  do
+    {
+      *--p = '0' + (n % 10);
+      n /= 10;
+    }
+  while (n != 0);
+
+  if (value < 0)
+    *--p = '-';
+
+  g_string_append_len (output, p, buf + sizeof (buf) - p);
+}
+
+/* writes the JSON representation of @value to @buf, which must be at
+ * least %G_ASCII_DTOSTR_BUF_SIZE bytes long, and returns its length;
+ * @buf is not nul-terminated
+ */
+static gsize
+json_format_double (gchar   *buf,
+                    gdouble  value)
+{
+  gchar digits[32];
+  gchar *p = buf;
+  guint64 bits;
+  guint len, i;
+  gint k, point;
+
+  memcpy (&bits, &value, sizeof (bits));
+
+  /* there is no JSON representation for infinities and NaNs */
+  if (G_UNLIKELY (((bits >> DP_SIGNIFICAND_SIZE) & 0x7ff) == 0x7ff))
+    {
+      g_ascii_dtostr (buf, G_ASCII_DTOSTR_BUF_SIZE - 2, value);
+      len = strlen (buf);
+      memcpy (buf + len, ".0", 2);
+
+      return len + 2;
+    }
+
+  if (bits >> 63)
+    *p++ = '-';
+
+  bits &= ~(G_GUINT64_CONSTANT (1) << 63);
+
+  if (bits == 0)
+    {
+      memcpy (p, "0.0", 3);
+
+      return p + 3 - buf;
+    }
+
+  len = grisu2 (bits, digits, &k);
+
+  /* the position of the decimal point, relative to the digits; the
+   * same notation as "%.17g" is used, with the exponent for numbers
+   * below 1e-4, or from 1e17 up
+   */
+  point = (gint) len + k;
+
+  if (point > 0 && point <= 17)
+    {
+      if (point >= (gint) len)
         {
-          switch (*p)
-            {
-            case '\b':
-              g_string_append (output, "\\b");
-              break;
-            case '\f':
-              g_string_append (output, "\\f");
-              break;
-            case '\n':
-              g_string_append (output, "\\n");
-              break;
-            case '\r':
-              g_string_append (output, "\\r");
-              break;
-            case '\t':
-              g_string_append (output, "\\t");
-              break;
-            default:
-              g_string_append_printf (output, "\\u00%02x", (guint)*p);
-              break;
-            }
+          /* 1234e3 -> 1234000.0 */
+          memcpy (p, digits, len);
+          p += len;
+
+          for (i = len; i < (guint) point; i++)
+            *p++ = '0';
+
+          *p++ = '.';
+          *p++ = '0';
         }
       else
         {
-          g_string_append_c (output, *p);
+          /* 1234e-2 -> 12.34 */
+          memcpy (p, digits, point);
+          p += point;
+          *p++ = '.';
+          memcpy (p, digits + point, len - point);
+          p += len - point;
+        }
+    }
+  else if (point > -4 && point <= 0)
+    {
+      /* 1234e-6 -> 0.001234 */
+      *p++ = '0';
+      *p++ = '.';
+
+      for (i = 0; i < (guint) -point; i++)
+        *p++ = '0';
+
+      memcpy (p, digits, len);
+      p += len;
+    }
+  else
+    {
+      gint exp10 = point - 1;
+
+      /* 1234e17 -> 1.234e+20 */
+      *p++ = digits[0];
+
+      if (len > 1)
+        {
+          *p++ = '.';
+          memcpy (p, digits + 1, len - 1);
+          p += len - 1;
+        }
+
+      *p++ = 'e';
+      *p++ = exp10 < 0 ? '-' : '+';
+
+      if (exp10 < 0)
+        exp10 = -exp10;
+
+      if (exp10 >= 100)
+        *p++ = '0' + exp10 / 100;
+
+      *p++ = '0' + (exp10 / 10) % 10;
+      *p++ = '0' + exp10 % 10;
+    }
+
+  return p - buf;
+}
+
+/*< private >
+ * json_append_double:
+ * @output: the buffer to append to
+ * @value: a floating point number
+ *
+ * Appends the JSON representation of @value to @output, using the
+ * shortest digits that are read back as the same number; the number
+ * always has a decimal point or an exponent, so that it is not read
+ * back as an integer.
+ */
+void
+json_append_double (GString *output,
+                    gdouble  value)
+{
+  gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+  g_string_append_len (output, buf, json_format_double (buf, value));
+}
+
+/* the length of @str, once escaped by json_strescape() */
+static gsize
+json_strescape_len (const gchar *str)
+{
+  const gchar *p = str;
+  const gchar *end = str + strlen (str);
+  gsize res = 0;
+
+  while (p < end)
+    {
+      const gchar *run = json_skip_unescaped (p, end);
+
+      res += run - p;
+      p = run;
+
+      if (p == end)
+        break;
+
+      switch (*p)
+        {
+        case '"': case '\\':
+        case '\b': case '\f': case '\n': case '\r': case '\t':
+          res += 2;
+          break;
+        default:
+          res += 6;
+          break;
         }
+
+      p++;
+    }
+
+  return res;
+}
+
+static void measure_array  (JsonArray    *array,
+                            JsonSizeHint *hint);
+static void measure_object (JsonObject   *object,
+                            JsonSizeHint *hint);
+
+/* the size hint of @node, as if it were the top level value */
+static void
+measure_node (JsonNode     *node,
+              JsonSizeHint *hint)
+{
+  memset (hint, 0, sizeof (JsonSizeHint));
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_NULL:
+      hint->size = 4;
+      break;
+
+    case JSON_NODE_ARRAY:
+      measure_array (node->data.array, hint);
+      break;
+
+    case JSON_NODE_OBJECT:
+      measure_object (node->data.object, hint);
+      break;
+
+    case JSON_NODE_VALUE:
+      switch (node->value_type)
+        {
+        case JSON_VALUE_INT:
+          {
+            gint64 value = node->data.v_int;
+
+            hint->size = value < 0 ? 2 : 1;
+            while (value <= -10 || value >= 10)
+              {
+                value /= 10;
+                hint->size += 1;
+              }
+          }
+          break;
+
+        case JSON_VALUE_DOUBLE:
+          {
+            gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+            hint->size = json_format_double (buf, node->data.v_double);
+          }
+          break;
+
+        case JSON_VALUE_STRING:
+          hint->size = json_strescape_len (json_node_get_string (node)) + 2;
+          break;
+
+        case JSON_VALUE_BOOLEAN:
+          hint->size = node->data.v_bool ? 4 : 5;
+          break;
+
+        case JSON_VALUE_NULL:
+          hint->size = 4;
+          break;
+
+        default:
+          break;
+        }
+      break;
+    }
+}
+
+/* adds an element or a member to the size hint of its container */
+static inline void
+measure_add_item (JsonSizeHint *hint,
+                  JsonNode     *node)
+{
+  JsonSizeHint item;
+
+  measure_node (node, &item);
+
+  /* the item is one level deeper than its container */
+  hint->size += item.size;
+  hint->lines += item.lines + 1;
+  hint->weight += item.weight + 1;
+  hint->depth += item.depth + item.weight + 1;
+}
+
+/* the opening line of the container is part of the line of its parent,
+ * but the closing one is indented
+ */
+#define MEASURE_CONTAINER_INIT(hint,n) \
+  G_STMT_START { \
+    (hint)->size = 2 + ((n) > 0 ? (n) - 1 : 0); \
+    (hint)->lines = 1; \
+    (hint)->weight = 1; \
+    (hint)->depth = 0; \
+  } G_STMT_END
+
+static void
+measure_array (JsonArray    *array,
+               JsonSizeHint *hint)
+{
+  guint i, len;
+
+  if (g_atomic_int_get (&array->size_hint_valid))
+    {
+      *hint = array->size_hint;
+      return;
+    }
+
+  len = json_array_get_length (array);
+
+  MEASURE_CONTAINER_INIT (hint, len);
+
+  for (i = 0; i < len; i++)
+    {
+      JsonNode scratch;
+
+      measure_add_item (hint, json_array_peek_element (array, i, &scratch));
+    }
+
+  /* every thread that gets here computes the same value */
+  if (array->immutable)
+    {
+      array->size_hint = *hint;
+      g_atomic_int_set (&array->size_hint_valid, TRUE);
+    }
+}
+
+static void
+measure_object (JsonObject   *object,
+                JsonSizeHint *hint)
+{
+  JsonObjectIter iter;
+  const gchar *member_name;
+  JsonNode *member;
+
+  if (g_atomic_int_get (&object->size_hint_valid))
+    {
+      *hint = object->size_hint;
+      return;
+    }
+
+  MEASURE_CONTAINER_INIT (hint, json_object_get_size (object));
+
+  json_object_iter_init (&iter, object);
+  while (json_object_iter_next (&iter, &member_name, &member))
+    {
+      /* "name": and, when pretty printing, "name" : */
+      hint->size += json_strescape_len (member_name) + 3;
+      hint->lines += 2;
+
+      measure_add_item (hint, member);
+    }
+
+  /* every thread that gets here computes the same value */
+  if (object->immutable)
+    {
+      object->size_hint = *hint;
+      g_atomic_int_set (&object->size_hint_valid, TRUE);
     }
 }
 
@@ -276,14 +1041,43 @@ json_generator_init (JsonGenerator *generator)
   priv->indent_char = ' ';
 }
 
+/* writes out the buffer if it is full, or if @force is set; returns
+ * %FALSE if writing failed, in which case the generation stops
+ */
+static gboolean
+dump_flush (DumpState *state,
+            gboolean   force)
+{
+  if (state->stream == NULL)
+    return TRUE;
+
+  if (state->error != NULL)
+    return FALSE;
+
+  if (!force && state->buffer->len < WRITE_BUFFER_SIZE)
+    return TRUE;
+
+  if (!g_output_stream_write_all (state->stream,
+                                  state->buffer->str, state->buffer->len,
+                                  NULL,
+                                  state->cancellable,
+                                  &state->error))
+    return FALSE;
+
+  g_string_truncate (state->buffer, 0);
+
+  return TRUE;
+}
+
 static void
 dump_node (JsonGenerator *generator,
-           GString       *buffer,
+           DumpState     *state,
            gint           level,
            const gchar   *name,
            JsonNode      *node)
 {
   JsonGeneratorPrivate *priv = generator->priv;
+  GString *buffer = state->buffer;
   gboolean pretty = priv->pretty;
   guint indent = priv->indent;
 
@@ -318,13 +1112,11 @@ dump_node (JsonGenerator *generator,
       break;
 
     case JSON_NODE_ARRAY:
-      dump_array (generator, buffer, level,
-                  json_node_get_array (node));
+      dump_array (generator, state, level, node->data.array);
       break;
 
     case JSON_NODE_OBJECT:
-      dump_object (generator, buffer, level,
-                   json_node_get_object (node));
+      dump_object (generator, state, level, node->data.object);
       break;
     }
 }
@@ -334,41 +1126,26 @@ dump_value (GString  *buffer,
             gint      level,
             JsonNode *node)
 {
-  const JsonValue *value;
-
-  value = node->data.value;
-
-  switch (value->type)
+  switch (node->value_type)
     {
     case JSON_VALUE_INT:
-      g_string_append_printf (buffer, "%" G_GINT64_FORMAT, json_value_get_int (value));
+      json_append_int (buffer, node->data.v_int);
       break;
 
     case JSON_VALUE_STRING:
       {
         g_string_append_c (buffer, '"');
-        json_strescape (buffer, json_value_get_string (value));
+        json_strescape (buffer, json_node_get_string (node));
         g_string_append_c (buffer, '"');
       }
       break;
 
     case JSON_VALUE_DOUBLE:
-      {
-        gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
-
-        g_string_append (buffer,
-                         g_ascii_dtostr (buf, sizeof (buf),
-                                         json_value_get_double (value)));
-	/* ensure doubles don't become ints */
-	if (g_strstr_len (buf, G_ASCII_DTOSTR_BUF_SIZE, ".") == NULL)
-	  {
-	    g_string_append (buffer, ".0");
-          }
-      }
+      json_append_double (buffer, node->data.v_double);
       break;
 
     case JSON_VALUE_BOOLEAN:
-      g_string_append (buffer, json_value_get_boolean (value) ? "true" : "false");
+      g_string_append (buffer, node->data.v_bool ? "true" : "false");
       break;
 
     case JSON_VALUE_NULL:
@@ -382,11 +1159,12 @@ dump_value (GString  *buffer,
 
 static void
 dump_array (JsonGenerator *generator,
-            GString       *buffer,
+            DumpState     *state,
             gint           level,
             JsonArray     *array)
 {
   JsonGeneratorPrivate *priv = generator->priv;
+  GString *buffer = state->buffer;
   guint array_len = json_array_get_length (array);
   guint i;
   gboolean pretty = priv->pretty;
@@ -399,15 +1177,19 @@ dump_array (JsonGenerator *generator,
 
   for (i = 0; i < array_len; i++)
     {
-      JsonNode *cur = json_array_get_element (array, i);
+      JsonNode scratch;
+      JsonNode *cur = json_array_peek_element (array, i, &scratch);
 
-      dump_node (generator, buffer, level + 1, NULL, cur);
+      dump_node (generator, state, level + 1, NULL, cur);
 
       if ((i + 1) != array_len)
         g_string_append_c (buffer, ',');
 
       if (pretty)
         g_string_append_c (buffer, '\n');
+
+      if (!dump_flush (state, FALSE))
+        return;
     }
 
   if (pretty)
@@ -421,11 +1203,12 @@ dump_array (JsonGenerator *generator,
 
 static void
 dump_object (JsonGenerator *generator,
-             GString       *buffer,
+             DumpState     *state,
              gint           level,
              JsonObject    *object)
 {
   JsonGeneratorPrivate *priv = generator->priv;
+  GString *buffer = state->buffer;
   GList *members, *l;
   gboolean pretty = priv->pretty;
   guint indent = priv->indent;
@@ -443,13 +1226,19 @@ dump_object (JsonGenerator *generator,
       const gchar *member_name = l->data;
       JsonNode *cur = json_object_get_member (object, member_name);
 
-      dump_node (generator, buffer, level + 1, member_name, cur);
+      dump_node (generator, state, level + 1, member_name, cur);
 
       if (l->next != NULL)
         g_string_append_c (buffer, ',');
 
       if (pretty)
         g_string_append_c (buffer, '\n');
+
+      if (!dump_flush (state, FALSE))
+        {
+          g_list_free (members);
+          return;
+        }
     }
 
   g_list_free (members);
@@ -478,6 +1267,47 @@ json_generator_new (void)
   return g_object_new (JSON_TYPE_GENERATOR, NULL);
 }
 
+/**
+ * json_generator_get_size_hint:
+ * @generator: a #JsonGenerator
+ *
+ * Computes the length of the data that @generator would produce with
+ * json_generator_to_data(), without generating it, for instance to
+ * allocate a buffer for it.
+ *
+ * The size of immutable objects and arrays is computed only once, and
+ * json_generator_to_data() uses it to allocate its buffer at once if
+ * the root node is immutable; see json_node_seal().
+ *
+ * Returns: the length of the generated data, not including the trailing
+ *   nul byte, or 0 if @generator does not have a root node
+ *
+ * Since: 1.4
+ */
+gsize
+json_generator_get_size_hint (JsonGenerator *generator)
+{
+  JsonGeneratorPrivate *priv;
+  JsonSizeHint hint;
+
+  g_return_val_if_fail (JSON_IS_GENERATOR (generator), 0);
+
+  priv = generator->priv;
+
+  if (priv->root == NULL)
+    return 0;
+
+  measure_node (priv->root, &hint);
+
+  if (!priv->pretty)
+    return hint.size;
+
+  /* the top level value is not indented, so only the depths of the
+   * lines below it matter
+   */
+  return hint.size + hint.lines + priv->indent * hint.depth;
+}
+
 /**
  * json_generator_to_data:
  * @generator: a #JsonGenerator
@@ -495,7 +1325,7 @@ json_generator_to_data (JsonGenerator *generator,
                         gsize         *length)
 {
   JsonNode *root;
-  GString *string;
+  DumpState state = { NULL, };
 
   g_return_val_if_fail (JSON_IS_GENERATOR (generator), NULL);
 
@@ -508,13 +1338,58 @@ json_generator_to_data (JsonGenerator *generator,
       return NULL;
     }
 
-  string = g_string_new ("");
-  dump_node (generator, string, 0, NULL, root);
+  /* the size of sealed trees is cached, so it is cheap to allocate the
+   * whole buffer at once; measuring other trees would cost about as much
+   * as growing the buffer while generating them
+   */
+  if (json_node_is_immutable (root))
+    state.buffer = g_string_sized_new (json_generator_get_size_hint (generator) + 1);
+  else
+    state.buffer = g_string_new ("");
+
+  dump_node (generator, &state, 0, NULL, root);
 
   if (length)
-    *length = string->len;
+    *length = state.buffer->len;
 
-  return g_string_free (string, FALSE);
+  return g_string_free (state.buffer, FALSE);
+}
+
+/* writes @root to @stream through a buffer of fixed size, so that the
+ * whole document is never held in memory
+ */
+static gboolean
+json_generator_write (JsonGenerator  *generator,
+                      JsonNode       *root,
+                      GOutputStream  *stream,
+                      GCancellable   *cancellable,
+                      GError        **error)
+{
+  DumpState state;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  if (root == NULL)
+    return TRUE;
+
+  state.buffer = g_string_sized_new (WRITE_BUFFER_SIZE);
+  state.stream = stream;
+  state.cancellable = cancellable;
+  state.error = NULL;
+
+  dump_node (generator, &state, 0, NULL, root);
+  dump_flush (&state, TRUE);
+
+  g_string_free (state.buffer, TRUE);
+
+  if (state.error != NULL)
+    {
+      g_propagate_error (error, state.error);
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 /**
@@ -526,6 +1401,9 @@ json_generator_to_data (JsonGenerator *generator,
  * Creates a JSON data stream and puts it inside @filename, overwriting the
  * current file contents. This operation is atomic.
  *
+ * The data is written to the file as it is generated, see
+ * json_generator_to_stream().
+ *
  * Return value: %TRUE if saving was successful.
  */
 gboolean
@@ -533,16 +1411,37 @@ json_generator_to_file (JsonGenerator  *generator,
                         const gchar    *filename,
                         GError        **error)
 {
-  gchar *buffer;
-  gsize len;
+  GFileOutputStream *stream;
+  GFile *file;
   gboolean retval;
 
   g_return_val_if_fail (JSON_IS_GENERATOR (generator), FALSE);
   g_return_val_if_fail (filename != NULL, FALSE);
 
-  buffer = json_generator_to_data (generator, &len);
-  retval = g_file_set_contents (filename, buffer, len, error);
-  g_free (buffer);
+  file = g_file_new_for_path (filename);
+  stream = g_file_replace (file, NULL, FALSE, G_FILE_CREATE_NONE, NULL, error);
+  g_object_unref (file);
+
+  if (stream == NULL)
+    return FALSE;
+
+  retval = json_generator_to_stream (generator, G_OUTPUT_STREAM (stream), NULL, error);
+
+  if (retval)
+    retval = g_output_stream_close (G_OUTPUT_STREAM (stream), NULL, error);
+  else
+    {
+      GCancellable *cancellable = g_cancellable_new ();
+
+      /* closing the stream with a cancelled cancellable leaves the
+       * previous contents of the file in place
+       */
+      g_cancellable_cancel (cancellable);
+      g_output_stream_close (G_OUTPUT_STREAM (stream), cancellable, NULL);
+      g_object_unref (cancellable);
+    }
+
+  g_object_unref (stream);
 
   return retval;
 }
@@ -556,6 +1455,10 @@ json_generator_to_file (JsonGenerator  *generator,
  *
  * Outputs JSON data and streams it (synchronously) to @stream.
  *
+ * The data is written to @stream as it is generated, through a buffer
+ * of fixed size, so generating large documents does not require holding
+ * their whole serialization in memory.
+ *
  * Return value: %TRUE if the write operation was successful, and %FALSE
  *   on failure. In case of error, the #GError will be filled accordingly
  *
@@ -567,21 +1470,125 @@ json_generator_to_stream (JsonGenerator  *generator,
                           GCancellable   *cancellable,
                           GError        **error)
 {
-  gboolean retval;
-  gchar *buffer;
-  gsize len;
-
   g_return_val_if_fail (JSON_IS_GENERATOR (generator), FALSE);
   g_return_val_if_fail (G_IS_OUTPUT_STREAM (stream), FALSE);
 
-  if (g_cancellable_set_error_if_cancelled (cancellable, error))
-    return FALSE;
+  return json_generator_write (generator, generator->priv->root,
+                               stream,
+                               cancellable,
+                               error);
+}
 
-  buffer = json_generator_to_data (generator, &len);
-  retval = g_output_stream_write (stream, buffer, len, cancellable, error);
-  g_free (buffer);
+typedef struct
+{
+  JsonNode *root;
+  GOutputStream *stream;
+} WriteData;
 
-  return retval;
+static void
+write_data_free (gpointer data_)
+{
+  WriteData *data = data_;
+
+  if (data->root != NULL)
+    json_node_unref (data->root);
+
+  g_object_unref (data->stream);
+  g_free (data);
+}
+
+static void
+write_to_stream (GTask        *task,
+                 gpointer      source_obj,
+                 gpointer      task_data,
+                 GCancellable *cancellable)
+{
+  WriteData *data = task_data;
+  GError *error = NULL;
+
+  if (!json_generator_write (source_obj, data->root, data->stream, cancellable, &error))
+    g_task_return_error (task, error);
+  else
+    g_task_return_boolean (task, TRUE);
+}
+
+/**
+ * json_generator_to_stream_async:
+ * @generator: a #JsonGenerator
+ * @stream: a #GOutputStream
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: a #GAsyncReadyCallback to call when the request is satisfied
+ * @user_data: the data to pass to @callback
+ *
+ * Asynchronously generates the JSON data stream of the root set on
+ * @generator, and writes it to @stream.
+ *
+ * For more details, see json_generator_to_stream() which is the
+ * synchronous version of this call.
+ *
+ * The data is generated in a separate thread, from a copy of the tree
+ * taken when this function is called; the properties of @generator
+ * should not be modified until the operation is finished. When it is,
+ * @callback will be called. You should then call
+ * json_generator_to_stream_finish() to get the result of the operation.
+ *
+ * Since: 1.4
+ */
+void
+json_generator_to_stream_async (JsonGenerator       *generator,
+                                GOutputStream       *stream,
+                                GCancellable        *cancellable,
+                                GAsyncReadyCallback  callback,
+                                gpointer             user_data)
+{
+  WriteData *data;
+  GTask *task;
+
+  g_return_if_fail (JSON_IS_GENERATOR (generator));
+  g_return_if_fail (G_IS_OUTPUT_STREAM (stream));
+  g_return_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable));
+
+  /* the copy of the root held by the generator shares its objects and
+   * arrays with the tree it was copied from, and they may be thread-local;
+   * the task data can be released by the thread running the task, so the
+   * task gets a deep copy that is not shared with anything else
+   */
+  data = g_new (WriteData, 1);
+  data->root = generator->priv->root != NULL
+             ? json_node_deep_copy (generator->priv->root, FALSE)
+             : NULL;
+  data->stream = g_object_ref (stream);
+
+  task = g_task_new (generator, cancellable, callback, user_data);
+  g_task_set_task_data (task, data, write_data_free);
+
+  g_task_run_in_thread (task, write_to_stream);
+  g_object_unref (task);
+}
+
+/**
+ * json_generator_to_stream_finish:
+ * @generator: a #JsonGenerator
+ * @result: a #GAsyncResult
+ * @error: the return location for a #GError or %NULL
+ *
+ * Finishes an asynchronous write started using
+ * json_generator_to_stream_async().
+ *
+ * Return value: %TRUE if the write operation was successful, and %FALSE
+ *   on failure. In case of error, the #GError will be filled accordingly
+ *
+ * Since: 1.4
+ */
+gboolean
+json_generator_to_stream_finish (JsonGenerator  *generator,
+                                 GAsyncResult   *result,
+                                 GError        **error)
+{
+  g_return_val_if_fail (JSON_IS_GENERATOR (generator), FALSE);
+  g_return_val_if_fail (g_task_is_valid (result, generator), FALSE);
+
+  return g_task_propagate_boolean (G_TASK (result), error);
 }
 
 /**
@@ -102,6 +102,9 @@ void            json_generator_set_root         (JsonGenerator  *generator,
 JSON_AVAILABLE_IN_1_0
 JsonNode *      json_generator_get_root         (JsonGenerator  *generator);
 
+JSON_AVAILABLE_IN_1_4
+gsize           json_generator_get_size_hint    (JsonGenerator  *generator);
+
 JSON_AVAILABLE_IN_1_0
 gchar *         json_generator_to_data          (JsonGenerator  *generator,
                                                  gsize          *length);
@@ -114,6 +117,16 @@ gboolean        json_generator_to_stream        (JsonGenerator  *generator,
                                                  GOutputStream  *stream,
                                                  GCancellable   *cancellable,
                                                  GError        **error);
+JSON_AVAILABLE_IN_1_4
+void            json_generator_to_stream_async  (JsonGenerator       *generator,
+                                                 GOutputStream       *stream,
+                                                 GCancellable        *cancellable,
+                                                 GAsyncReadyCallback  callback,
+                                                 gpointer             user_data);
+JSON_AVAILABLE_IN_1_4
+gboolean        json_generator_to_stream_finish (JsonGenerator  *generator,
+                                                 GAsyncResult   *result,
+                                                 GError        **error);
 
 #ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonGenerator, g_object_unref)
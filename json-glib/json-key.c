@@ -0,0 +1,387 @@
+/* json-key.c - Member names of JSON objects
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:json-key
+ * @short_description: Precomputed names of object members
+ *
+ * #JsonKey holds the name of an object member, along with its length and
+ * hash; looking up a member of a #JsonObject using a #JsonKey does not
+ * need to hash the name again, and comparing two names is usually a
+ * matter of comparing two integers.
+ *
+ * A #JsonKey is meant to be created once and used for many lookups, for
+ * instance:
+ *
+ * |[<!-- language="C" -->
+ *   static JsonKey *timestamp_key;
+ *
+ *   if (timestamp_key == NULL)
+ *     timestamp_key = json_key_new ("timestamp");
+ *
+ *   for (i = 0; i < json_array_get_length (records); i++)
+ *     {
+ *       JsonObject *record = json_array_get_object_element (records, i);
+ *
+ *       if (json_object_has_member_by_key (record, timestamp_key))
+ *         process_timestamp (json_object_get_int_member_by_key (record, timestamp_key));
+ *     }
+ * ]|
+ *
+ * Objects store the names of their members as keys as well, and share
+ * them when they can: a #JsonKey set with json_object_set_member_by_key()
+ * is shared by all the objects using it, and the #JsonParser can share
+ * the keys of a document, see #JsonParser:intern-member-names.
+ */
+
+/*
+ * Keys allocated inside an arena are not reference counted, and live as
+ * long as the arena does; JsonKeyTable interns the keys of a document
+ * while it is being parsed.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "json-types-private.h"
+
+/* the size of a key table, once it is not empty */
+#define KEY_TABLE_MIN_SIZE      32
+
+struct _JsonKeyTable
+{
+  /* the arena holding the keys, if any */
+  JsonArena *arena;
+
+  /* open addressing, with linear probing */
+  JsonKey **keys;
+  guint size;
+  guint n_keys;
+};
+
+/* the same function as g_str_hash(), which allows using the hash of a
+ * key to look it up in a hash table of strings
+ */
+static inline guint
+json_key_hash_len (const gchar *name,
+                   gsize        len)
+{
+  const signed char *p = (const signed char *) name;
+  const signed char *end = p + len;
+  guint32 h = 5381;
+
+  for (; p < end; p++)
+    h = (h << 5) + h + *p;
+
+  return h;
+}
+
+static inline void
+json_key_init (JsonKey     *key,
+               const gchar *name,
+               gsize        len,
+               guint        hash)
+{
+  key->hash = hash;
+  key->len = len;
+  memcpy (key->name, name, len);
+  key->name[len] = '\0';
+}
+
+static JsonKey *
+json_key_new_with_hash (const gchar *name,
+                        gsize        len,
+                        guint        hash)
+{
+  JsonKey *key;
+
+  key = g_malloc (G_STRUCT_OFFSET (JsonKey, name) + len + 1);
+  key->ref_count = 1;
+  json_key_init (key, name, len, hash);
+
+  return key;
+}
+
+static JsonKey *
+json_key_new_in_arena_with_hash (JsonArena   *arena,
+                                 const gchar *name,
+                                 gsize        len,
+                                 guint        hash)
+{
+  JsonKey *key;
+
+  key = json_arena_alloc (arena, G_STRUCT_OFFSET (JsonKey, name) + len + 1);
+  key->ref_count = 0;
+  json_key_init (key, name, len, hash);
+
+  return key;
+}
+
+G_DEFINE_BOXED_TYPE (JsonKey, json_key, json_key_ref, json_key_unref);
+
+/*< private >
+ * json_key_hash:
+ * @name: a nul-terminated string
+ * @len: (out): return location for the length of @name
+ *
+ * Computes the hash of @name, which is the same as the hash of
+ * a #JsonKey holding @name, and its length.
+ *
+ * Returns: the hash of @name
+ */
+guint
+json_key_hash (const gchar *name,
+               gsize       *len)
+{
+  const signed char *p = (const signed char *) name;
+  guint32 h = 5381;
+
+  for (; *p != '\0'; p++)
+    h = (h << 5) + h + *p;
+
+  *len = (const gchar *) p - name;
+
+  return h;
+}
+
+/*< private >
+ * json_key_new_len:
+ * @name: the name of the member
+ * @len: the length of @name, or -1 if @name is nul-terminated
+ *
+ * Creates a new key for @name.
+ *
+ * Returns: (transfer full): the newly created key
+ */
+JsonKey *
+json_key_new_len (const gchar *name,
+                  gssize       len)
+{
+  if (len < 0)
+    len = strlen (name);
+
+  return json_key_new_with_hash (name, len, json_key_hash_len (name, len));
+}
+
+/*< private >
+ * json_key_new_in_arena:
+ * @arena: a #JsonArena
+ * @name: the name of the member
+ * @len: the length of @name
+ *
+ * Creates a new key for @name inside @arena.
+ *
+ * Returns: (transfer none): the newly created key
+ */
+JsonKey *
+json_key_new_in_arena (JsonArena   *arena,
+                       const gchar *name,
+                       gsize        len)
+{
+  return json_key_new_in_arena_with_hash (arena, name, len, json_key_hash_len (name, len));
+}
+
+/**
+ * json_key_new:
+ * @name: the name of an object member
+ *
+ * Creates a new #JsonKey for @name, which can be used to look up the
+ * members called @name in any #JsonObject.
+ *
+ * Returns: (transfer full): the newly created #JsonKey. Use
+ *   json_key_unref() when done.
+ *
+ * Since: 1.4
+ */
+JsonKey *
+json_key_new (const gchar *name)
+{
+  g_return_val_if_fail (name != NULL, NULL);
+
+  return json_key_new_len (name, -1);
+}
+
+/**
+ * json_key_ref:
+ * @key: a #JsonKey
+ *
+ * Acquires a reference on @key.
+ *
+ * Returns: (transfer full): the passed #JsonKey
+ *
+ * Since: 1.4
+ */
+JsonKey *
+json_key_ref (JsonKey *key)
+{
+  g_return_val_if_fail (key != NULL, NULL);
+
+  /* keys inside an arena live as long as the arena */
+  if (key->ref_count != 0)
+    g_atomic_int_inc (&key->ref_count);
+
+  return key;
+}
+
+/**
+ * json_key_unref:
+ * @key: (transfer full): a #JsonKey
+ *
+ * Releases a reference on @key; the key is freed when its reference
+ * count drops to zero.
+ *
+ * Since: 1.4
+ */
+void
+json_key_unref (JsonKey *key)
+{
+  g_return_if_fail (key != NULL);
+
+  if (key->ref_count != 0 && g_atomic_int_dec_and_test (&key->ref_count))
+    g_free (key);
+}
+
+/**
+ * json_key_get_name:
+ * @key: a #JsonKey
+ *
+ * Retrieves the name held by @key.
+ *
+ * Returns: (transfer none): the name of the member
+ *
+ * Since: 1.4
+ */
+const gchar *
+json_key_get_name (const JsonKey *key)
+{
+  g_return_val_if_fail (key != NULL, NULL);
+
+  return key->name;
+}
+
+/*< private >
+ * json_key_table_new:
+ * @arena: (nullable): the arena holding the keys
+ *
+ * Creates a new table for interning keys. If @arena is not %NULL, the
+ * keys are allocated inside it, and the table must be freed before the
+ * arena is destroyed.
+ *
+ * Returns: (transfer full): the newly created table
+ */
+JsonKeyTable *
+json_key_table_new (JsonArena *arena)
+{
+  JsonKeyTable *table;
+
+  table = g_slice_new0 (JsonKeyTable);
+  table->arena = arena;
+
+  return table;
+}
+
+void
+json_key_table_free (JsonKeyTable *table)
+{
+  guint i;
+
+  if (table->arena == NULL)
+    {
+      for (i = 0; i < table->size; i++)
+        {
+          if (table->keys[i] != NULL)
+            json_key_unref (table->keys[i]);
+        }
+    }
+
+  g_free (table->keys);
+  g_slice_free (JsonKeyTable, table);
+}
+
+static void
+json_key_table_resize (JsonKeyTable *table)
+{
+  JsonKey **old_keys = table->keys;
+  guint old_size = table->size;
+  guint i;
+
+  table->size = MAX (old_size * 2, KEY_TABLE_MIN_SIZE);
+  table->keys = g_new0 (JsonKey *, table->size);
+
+  for (i = 0; i < old_size; i++)
+    {
+      JsonKey *key = old_keys[i];
+      guint pos;
+
+      if (key == NULL)
+        continue;
+
+      pos = key->hash & (table->size - 1);
+      while (table->keys[pos] != NULL)
+        pos = (pos + 1) & (table->size - 1);
+
+      table->keys[pos] = key;
+    }
+
+  g_free (old_keys);
+}
+
+/*< private >
+ * json_key_table_lookup:
+ * @table: a #JsonKeyTable
+ * @name: the name of the member
+ * @len: the length of @name
+ *
+ * Retrieves the key for @name, creating it if it was not interned
+ * in @table already.
+ *
+ * Returns: (transfer full): the key for @name
+ */
+JsonKey *
+json_key_table_lookup (JsonKeyTable *table,
+                       const gchar  *name,
+                       gsize         len)
+{
+  guint hash = json_key_hash_len (name, len);
+  JsonKey *key;
+  guint pos;
+
+  /* keep the load factor under 3/4 */
+  if ((table->n_keys + 1) * 4 > table->size * 3)
+    json_key_table_resize (table);
+
+  pos = hash & (table->size - 1);
+  while ((key = table->keys[pos]) != NULL)
+    {
+      if (key->hash == hash && key->len == len && memcmp (key->name, name, len) == 0)
+        return json_key_ref (key);
+
+      pos = (pos + 1) & (table->size - 1);
+    }
+
+  if (table->arena != NULL)
+    key = json_key_new_in_arena_with_hash (table->arena, name, len, hash);
+  else
+    key = json_key_new_with_hash (name, len, hash);
+
+  table->keys[pos] = key;
+  table->n_keys += 1;
+
+  return json_key_ref (key);
+}
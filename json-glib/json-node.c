@@ -25,6 +25,8 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include "json-types.h"
@@ -97,10 +99,7 @@ json_node_get_value_type (JsonNode *node)
       return G_TYPE_INVALID;
 
     case JSON_NODE_VALUE:
-      if (node->data.value)
-        return JSON_VALUE_TYPE (node->data.value);
-      else
-        return G_TYPE_INVALID;
+      return json_value_type (node->value_type);
 
     default:
       g_assert_not_reached ();
@@ -131,6 +130,29 @@ json_node_alloc (void)
   return node;
 }
 
+/*< private >
+ * json_node_alloc_in_arena:
+ * @arena: a #JsonArena
+ *
+ * Allocates a new #JsonNode inside @arena.
+ *
+ * The node does not hold a reference on @arena; references acquired on
+ * the node using json_node_ref() are forwarded to the arena instead.
+ *
+ * Returns: (transfer none): the newly allocated #JsonNode
+ */
+JsonNode *
+json_node_alloc_in_arena (JsonArena *arena)
+{
+  JsonNode *node;
+
+  node = json_arena_alloc (arena, sizeof (JsonNode));
+  node->ref_count = 1;
+  node->in_arena = TRUE;
+
+  return node;
+}
+
 static void
 json_node_unset (JsonNode *node)
 {
@@ -151,13 +173,109 @@ json_node_unset (JsonNode *node)
       break;
 
     case JSON_NODE_VALUE:
-      if (node->data.value)
-        json_value_unref (node->data.value);
+      if (node->value_type == JSON_VALUE_STRING &&
+          !node->string_inline &&
+          !node->in_arena)
+        g_free (node->data.v_str);
       break;
 
     case JSON_NODE_NULL:
       break;
     }
+
+  memset (&node->data, 0, sizeof (node->data));
+  node->value_type = JSON_VALUE_INVALID;
+  node->string_inline = FALSE;
+  node->cow = FALSE;
+}
+
+/* gives @node a container of its own, if it still shares it with the
+ * immutable tree it was copied from by json_node_copy_on_write(); the
+ * members or elements of the new container share their own containers
+ * in turn, so only the containers along the path to a modified node are
+ * copied, and the immutable tree is never changed
+ */
+static void
+json_node_unshare (JsonNode *node)
+{
+  node->cow = FALSE;
+
+  if (node->immutable)
+    return;
+
+  if (node->type == JSON_NODE_OBJECT && node->data.object != NULL)
+    {
+      JsonObject *object = node->data.object;
+
+      /* nobody else can see the object */
+      if (!object->immutable && !object->in_arena && object->ref_count == 1)
+        return;
+
+      node->data.object = json_object_copy_shared (object, node);
+
+      /* nodes inside an arena do not own their containers */
+      if (!node->in_arena)
+        json_object_unref (object);
+    }
+  else if (node->type == JSON_NODE_ARRAY && node->data.array != NULL)
+    {
+      JsonArray *array = node->data.array;
+
+      if (!array->immutable && !array->in_arena && array->ref_count == 1)
+        return;
+
+      node->data.array = json_array_copy_shared (array, node);
+
+      if (!node->in_arena)
+        json_array_unref (array);
+    }
+}
+
+static inline void
+json_node_reset_value (JsonNode      *node,
+                       JsonValueType  value_type)
+{
+  json_node_unset (node);
+
+  node->value_type = value_type;
+}
+
+static inline const gchar *
+json_node_peek_string (JsonNode *node)
+{
+  return JSON_NODE_PEEK_STRING (node);
+}
+
+static void
+json_node_store_string (JsonNode    *node,
+                        const gchar *value,
+                        gsize        len)
+{
+  gchar *str;
+
+  if (len < JSON_NODE_INLINE_STRING_SIZE)
+    {
+      gchar buf[JSON_NODE_INLINE_STRING_SIZE];
+
+      /* @value may be the string currently stored in @node */
+      memcpy (buf, value, len);
+      buf[len] = '\0';
+
+      json_node_reset_value (node, JSON_VALUE_STRING);
+      memcpy (node->data.v_inline, buf, len + 1);
+      node->string_inline = TRUE;
+
+      return;
+    }
+
+  /* long strings live as long as the node does */
+  if (node->in_arena)
+    str = json_arena_strndup (json_arena_from_pointer (node), value, len);
+  else
+    str = g_strndup (value, len);
+
+  json_node_reset_value (node, JSON_VALUE_STRING);
+  node->data.v_str = str;
 }
 
 /**
@@ -394,6 +512,49 @@ json_node_new (JsonNodeType type)
   return json_node_init (json_node_alloc (), type);
 }
 
+static JsonNode *
+json_node_dup (JsonNode *node)
+{
+  JsonNode *copy;
+
+  copy = json_node_alloc ();
+  copy->type = node->type;
+  copy->immutable = node->immutable;
+  copy->cow = node->cow;
+
+  switch (copy->type)
+    {
+    case JSON_NODE_OBJECT:
+      if (node->data.object != NULL)
+        copy->data.object = json_object_ref (node->data.object);
+      break;
+
+    case JSON_NODE_ARRAY:
+      if (node->data.array != NULL)
+        copy->data.array = json_array_ref (node->data.array);
+      break;
+
+    case JSON_NODE_VALUE:
+      copy->value_type = node->value_type;
+      copy->string_inline = node->string_inline;
+
+      /* the copy may outlive the arena, or the string, of @node */
+      if (node->value_type == JSON_VALUE_STRING && !node->string_inline)
+        copy->data.v_str = g_strdup (node->data.v_str);
+      else
+        copy->data = node->data;
+      break;
+
+    case JSON_NODE_NULL:
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+
+  return copy;
+}
+
 /**
  * json_node_copy:
  * @node: a #JsonNode
@@ -405,19 +566,15 @@ json_node_new (JsonNodeType type)
  * The copy will be immutable if, and only if, @node is immutable. However,
  * there should be no need to copy an immutable node.
  *
+ * See also: json_node_copy_on_write(), json_node_deep_copy()
+ *
  * Return value: (transfer full): the copied #JsonNode
  */
 JsonNode *
 json_node_copy (JsonNode *node)
 {
-  JsonNode *copy;
-
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
 
-  copy = json_node_alloc ();
-  copy->type = node->type;
-  copy->immutable = node->immutable;
-
 #ifdef JSON_ENABLE_DEBUG
   if (node->immutable)
     {
@@ -427,19 +584,202 @@ json_node_copy (JsonNode *node)
     }
 #endif
 
-  switch (copy->type)
+  return json_node_dup (node);
+}
+
+/**
+ * json_node_copy_on_write:
+ * @node: a #JsonNode
+ *
+ * Creates a mutable copy of @node, and of the whole tree below it, that
+ * can be modified without affecting @node.
+ *
+ * If @node is immutable, the copy shares all its objects and arrays with
+ * @node; the copy gets a container of its own only when the container is
+ * retrieved from the copy using json_node_get_object(),
+ * json_node_get_array(), or any function built on top of them, like
+ * json_object_get_object_member(). At that point, only the retrieved
+ * container is copied, along with the nodes of its members or elements.
+ * Taking a copy of a large immutable tree, and then changing a few values
+ * deep inside it, only copies the containers on the path to the changed
+ * values. Since reading the copy may change it, the copy must not be used
+ * from more than one thread at a time; @node is never changed, and it can
+ * still be shared between threads.
+ *
+ * If @node is mutable, it could be changed after the copy is taken, so
+ * the whole tree is copied right away, like json_node_deep_copy() does.
+ *
+ * Return value: (transfer full): the copy of @node
+ *
+ * Since: 1.4
+ */
+JsonNode *
+json_node_copy_on_write (JsonNode *node)
+{
+  JsonNode *copy;
+
+  g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
+
+  if (!node->immutable)
+    return json_node_deep_copy (node, node->in_arena);
+
+  copy = json_node_dup (node);
+  copy->immutable = FALSE;
+
+  if (node->type == JSON_NODE_OBJECT || node->type == JSON_NODE_ARRAY)
+    copy->cow = TRUE;
+
+  return copy;
+}
+
+/*< private >
+ * json_node_share:
+ * @node: a member or element of a container
+ * @parent: the node holding the copy of the container
+ *
+ * Copies @node like json_node_copy_on_write() does, for the copy of its
+ * container held by @parent; @node belongs to an immutable tree, so it
+ * can be shared. If @parent is inside an arena, the copy is allocated
+ * inside the same arena.
+ *
+ * Returns: (transfer full): the copy of @node
+ */
+JsonNode *
+json_node_share (JsonNode *node,
+                 JsonNode *parent)
+{
+  JsonArena *arena;
+  JsonNode *copy;
+
+  if (!parent->in_arena)
+    {
+      copy = json_node_copy_on_write (node);
+      copy->parent = parent;
+      copy->thread_local = parent->thread_local;
+      copy->owner = parent->owner;
+
+      return copy;
+    }
+
+  arena = json_arena_from_pointer (parent);
+
+  /* the containers of the nodes inside an arena belong to the arena */
+  copy = json_node_alloc_in_arena (arena);
+  copy->type = node->type;
+  copy->value_type = node->value_type;
+  copy->string_inline = node->string_inline;
+  copy->data = node->data;
+  copy->parent = parent;
+  copy->thread_local = parent->thread_local;
+  copy->owner = parent->owner;
+
+  if (node->type == JSON_NODE_VALUE &&
+      node->value_type == JSON_VALUE_STRING &&
+      !node->string_inline &&
+      !(node->in_arena && json_arena_from_pointer (node) == arena))
+    copy->data.v_str = json_arena_strndup (arena, node->data.v_str, strlen (node->data.v_str));
+
+  if (node->type == JSON_NODE_OBJECT || node->type == JSON_NODE_ARRAY)
+    copy->cow = TRUE;
+
+  return copy;
+}
+
+typedef struct
+{
+  JsonNode *source;
+  JsonNode *copy;
+
+  /* the position of the next member or element of @source */
+  guint position;
+} DeepCopyFrame;
+
+/* copies @node, without the members or elements of its container;
+ * returns %TRUE if they still need to be copied
+ */
+static gboolean
+json_node_deep_copy_node (JsonNode   *node,
+                          JsonArena  *arena,
+                          JsonNode   *parent,
+                          JsonNode  **copy_p)
+{
+  JsonNode *copy;
+
+  if (arena != NULL)
+    copy = json_node_alloc_in_arena (arena);
+  else
+    copy = json_node_alloc ();
+
+  copy->type = node->type;
+  copy->parent = parent;
+  *copy_p = copy;
+
+  switch (node->type)
     {
     case JSON_NODE_OBJECT:
-      copy->data.object = json_node_dup_object (node);
-      break;
+      {
+        JsonObject *object = node->data.object;
+
+        if (object == NULL)
+          return FALSE;
+
+        if (arena != NULL)
+          copy->data.object = json_object_new_in_arena (arena);
+        else
+          copy->data.object = json_object_new ();
+
+        json_object_reserve (copy->data.object, object->n_members);
+
+        return object->n_members > 0;
+      }
 
     case JSON_NODE_ARRAY:
-      copy->data.array = json_node_dup_array (node);
-      break;
+      {
+        JsonArray *array = node->data.array;
+        const gint64 *ints;
+        const gdouble *doubles;
+        guint len;
+
+        if (array == NULL)
+          return FALSE;
+
+        if (arena != NULL)
+          copy->data.array = json_array_new_in_arena (arena);
+        else
+          copy->data.array = json_array_new ();
+
+        /* packed values are copied at once */
+        if ((ints = json_array_peek_int_elements (array, &len)) != NULL)
+          {
+            json_array_add_int_elements (copy->data.array, ints, len);
+            json_array_set_element_parent (copy->data.array, copy);
+            return FALSE;
+          }
+
+        if ((doubles = json_array_peek_double_elements (array, &len)) != NULL)
+          {
+            json_array_add_double_elements (copy->data.array, doubles, len);
+            json_array_set_element_parent (copy->data.array, copy);
+            return FALSE;
+          }
+
+        /* the elements are filled in as they are copied */
+        g_ptr_array_set_size (copy->data.array->elements, array->elements->len);
+
+        return array->elements->len > 0;
+      }
 
     case JSON_NODE_VALUE:
-      if (node->data.value)
-        copy->data.value = json_value_ref (node->data.value);
+      copy->value_type = node->value_type;
+
+      if (node->value_type == JSON_VALUE_STRING)
+        {
+          const gchar *str = JSON_NODE_PEEK_STRING (node);
+
+          json_node_set_string_len (copy, str, strlen (str));
+        }
+      else
+        copy->data = node->data;
       break;
 
     case JSON_NODE_NULL:
@@ -449,7 +789,151 @@ json_node_copy (JsonNode *node)
       g_assert_not_reached ();
     }
 
-  return copy;
+  return FALSE;
+}
+
+/**
+ * json_node_deep_copy:
+ * @node: a #JsonNode
+ * @use_arena: whether to allocate the copy inside an arena
+ *
+ * Creates a mutable copy of @node, and of all the nodes, objects, arrays,
+ * and strings below it, which does not share any data with @node.
+ *
+ * Unlike the trees returned by json_node_copy(), the copy can be passed
+ * to another thread and modified there, and copying it does not touch
+ * the reference counts of @node; @node can be used in multiple threads
+ * at the same time while it's copied, as long as it is immutable.
+ *
+ * The copy does not use the stack for each level of nesting of @node,
+ * so that arbitrarily deep trees can be copied. If @use_arena is %TRUE
+ * the whole copy is allocated inside a single arena, like the trees
+ * created by a #JsonParser with #JsonParser:use-arena set, and it is
+ * released at once when the last reference on any of its nodes is
+ * released.
+ *
+ * Return value: (transfer full): the copy of @node
+ *
+ * Since: 1.4
+ */
+JsonNode *
+json_node_deep_copy (JsonNode *node,
+                     gboolean  use_arena)
+{
+  JsonArena *arena = NULL;
+  JsonKeyTable *keys;
+  GArray *stack;
+  DeepCopyFrame frame;
+  JsonNode *root;
+
+  g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
+
+  /* the reference on the arena is the reference held by the root */
+  if (use_arena)
+    arena = json_arena_new ();
+
+  frame.source = node;
+  frame.position = 0;
+  if (!json_node_deep_copy_node (node, arena, NULL, &frame.copy))
+    return frame.copy;
+
+  root = frame.copy;
+
+  /* member names are shared inside the copy, but not with @node */
+  keys = json_key_table_new (arena);
+
+  stack = g_array_new (FALSE, FALSE, sizeof (DeepCopyFrame));
+  g_array_append_val (stack, frame);
+
+  while (stack->len > 0)
+    {
+      DeepCopyFrame *top = &g_array_index (stack, DeepCopyFrame, stack->len - 1);
+      JsonNode *child, *copy;
+      gboolean descend;
+
+      if (top->source->type == JSON_NODE_OBJECT)
+        {
+          JsonObject *object = top->source->data.object;
+          JsonObjectMember *member;
+          JsonKey *key;
+
+          /* skip the holes left by removed members */
+          while (top->position < object->members_len &&
+                 object->members[top->position].key == NULL)
+            top->position += 1;
+
+          if (top->position == object->members_len)
+            {
+              g_array_set_size (stack, stack->len - 1);
+              continue;
+            }
+
+          member = &object->members[top->position++];
+          child = member->value;
+          descend = json_node_deep_copy_node (child, arena, top->copy, &copy);
+
+          key = json_key_table_lookup (keys, member->key->name, member->key->len);
+          json_object_take_member (top->copy->data.object, key, copy);
+        }
+      else
+        {
+          JsonArray *array = top->source->data.array;
+
+          if (top->position == array->elements->len)
+            {
+              g_array_set_size (stack, stack->len - 1);
+              continue;
+            }
+
+          child = g_ptr_array_index (array->elements, top->position);
+          descend = json_node_deep_copy_node (child, arena, top->copy, &copy);
+
+          top->copy->data.array->elements->pdata[top->position++] = copy;
+        }
+
+      if (descend)
+        {
+          frame.source = child;
+          frame.copy = copy;
+          frame.position = 0;
+          g_array_append_val (stack, frame);
+        }
+    }
+
+  g_array_unref (stack);
+  json_key_table_free (keys);
+
+  return root;
+}
+
+static GPrivate json_thread_tag_private = G_PRIVATE_INIT (NULL);
+static volatile gint json_thread_tag_next;
+
+/*< private >
+ * json_thread_get_tag:
+ *
+ * Retrieves the tag of the calling thread, used to check that the data
+ * of thread-local documents does not leave the thread that created it.
+ * Tags are not unique once they wrap around, which only means that some
+ * misuses go undetected.
+ *
+ * Returns: the tag of the calling thread, which is never 0
+ */
+guint
+json_thread_get_tag (void)
+{
+  guint tag = GPOINTER_TO_UINT (g_private_get (&json_thread_tag_private));
+
+  if (G_UNLIKELY (tag == 0))
+    {
+      do
+        tag = (guint) g_atomic_int_add (&json_thread_tag_next, 1) & JSON_THREAD_TAG_MASK;
+      while (tag == 0);
+
+      g_private_set (&json_thread_tag_private, GUINT_TO_POINTER (tag));
+    }
+
+  return tag;
 }
 
 /**
@@ -466,7 +950,20 @@ json_node_ref (JsonNode *node)
 {
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
 
-  g_atomic_int_inc (&node->ref_count);
+  /* nodes inside an arena live as long as their document */
+  if (node->in_arena)
+    {
+      json_arena_ref (json_arena_from_pointer (node));
+      return node;
+    }
+
+  if (node->thread_local)
+    {
+      JSON_CHECK_THREAD (node->owner, node);
+      node->ref_count++;
+    }
+  else
+    g_atomic_int_inc (&node->ref_count);
 
   return node;
 }
@@ -485,12 +982,24 @@ json_node_unref (JsonNode *node)
 {
   g_return_if_fail (JSON_NODE_IS_VALID (node));
 
-  if (g_atomic_int_dec_and_test (&node->ref_count))
+  if (node->in_arena)
     {
-      json_node_unset (node);
-      if (node->allocated)
-        g_slice_free (JsonNode, node);
+      json_arena_unref (json_arena_from_pointer (node));
+      return;
     }
+
+  if (node->thread_local)
+    {
+      JSON_CHECK_THREAD (node->owner, node);
+      if (--node->ref_count != 0)
+        return;
+    }
+  else if (!g_atomic_int_dec_and_test (&node->ref_count))
+    return;
+
+  json_node_unset (node);
+  if (node->allocated)
+    g_slice_free (JsonNode, node);
 }
 
 /**
@@ -563,6 +1072,9 @@ json_node_get_object (JsonNode *node)
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_OBJECT, NULL);
 
+  if (node->cow)
+    json_node_unshare (node);
+
   return node->data.object;
 }
 
@@ -582,6 +1094,9 @@ json_node_dup_object (JsonNode *node)
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_OBJECT, NULL);
 
+  if (node->cow)
+    json_node_unshare (node);
+
   if (node->data.object)
     return json_object_ref (node->data.object);
   
@@ -656,6 +1171,9 @@ json_node_get_array (JsonNode *node)
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_ARRAY, NULL);
 
+  if (node->cow)
+    json_node_unshare (node);
+
   return node->data.array;
 }
 
@@ -676,6 +1194,9 @@ json_node_dup_array (JsonNode *node)
   g_return_val_if_fail (JSON_NODE_IS_VALID (node), NULL);
   g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_ARRAY, NULL);
 
+  if (node->cow)
+    json_node_unshare (node);
+
   if (node->data.array)
     return json_array_ref (node->data.array);
 
@@ -698,25 +1219,25 @@ json_node_get_value (JsonNode *node,
   g_return_if_fail (JSON_NODE_IS_VALID (node));
   g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
 
-  if (node->data.value)
+  if (node->value_type != JSON_VALUE_INVALID)
     {
-      g_value_init (value, JSON_VALUE_TYPE (node->data.value));
-      switch (JSON_VALUE_TYPE (node->data.value))
+      g_value_init (value, json_value_type (node->value_type));
+      switch (node->value_type)
         {
-        case G_TYPE_INT64:
-          g_value_set_int64 (value, json_value_get_int (node->data.value));
+        case JSON_VALUE_INT:
+          g_value_set_int64 (value, node->data.v_int);
           break;
 
-        case G_TYPE_DOUBLE:
-          g_value_set_double (value, json_value_get_double (node->data.value));
+        case JSON_VALUE_DOUBLE:
+          g_value_set_double (value, node->data.v_double);
           break;
 
-        case G_TYPE_BOOLEAN:
-          g_value_set_boolean (value, json_value_get_boolean (node->data.value));
+        case JSON_VALUE_BOOLEAN:
+          g_value_set_boolean (value, node->data.v_bool);
           break;
 
-        case G_TYPE_STRING:
-          g_value_set_string (value, json_value_get_string (node->data.value));
+        case JSON_VALUE_STRING:
+          g_value_set_string (value, json_node_peek_string (node));
           break;
 
         default:
@@ -743,39 +1264,32 @@ json_node_set_value (JsonNode     *node,
   g_return_if_fail (G_VALUE_TYPE (value) != G_TYPE_INVALID);
   g_return_if_fail (!node->immutable);
 
-  if (node->data.value == NULL)
-    node->data.value = json_value_alloc ();
-
   switch (G_VALUE_TYPE (value))
     {
     /* auto-promote machine integers to 64 bit integers */
     case G_TYPE_INT64:
     case G_TYPE_INT:
-      json_value_init (node->data.value, JSON_VALUE_INT);
       if (G_VALUE_TYPE (value) == G_TYPE_INT64)
-        json_value_set_int (node->data.value, g_value_get_int64 (value));
+        json_node_set_int (node, g_value_get_int64 (value));
       else
-        json_value_set_int (node->data.value, g_value_get_int (value));
+        json_node_set_int (node, g_value_get_int (value));
       break;
 
     case G_TYPE_BOOLEAN:
-      json_value_init (node->data.value, JSON_VALUE_BOOLEAN);
-      json_value_set_boolean (node->data.value, g_value_get_boolean (value));
+      json_node_set_boolean (node, g_value_get_boolean (value));
       break;
 
     /* auto-promote single-precision floats to double precision floats */
     case G_TYPE_DOUBLE:
     case G_TYPE_FLOAT:
-      json_value_init (node->data.value, JSON_VALUE_DOUBLE);
       if (G_VALUE_TYPE (value) == G_TYPE_DOUBLE)
-        json_value_set_double (node->data.value, g_value_get_double (value));
+        json_node_set_double (node, g_value_get_double (value));
       else
-        json_value_set_double (node->data.value, g_value_get_float (value));
+        json_node_set_double (node, g_value_get_float (value));
       break;
 
     case G_TYPE_STRING:
-      json_value_init (node->data.value, JSON_VALUE_STRING);
-      json_value_set_string (node->data.value, g_value_get_string (value));
+      json_node_set_string (node, g_value_get_string (value));
       break;
 
     default:
@@ -842,8 +1356,7 @@ json_node_seal (JsonNode *node)
     case JSON_NODE_NULL:
       break;
     case JSON_NODE_VALUE:
-      g_return_if_fail (node->data.value != NULL);
-      json_value_seal (node->data.value);
+      g_return_if_fail (node->value_type != JSON_VALUE_INVALID);
       break;
     default:
       g_assert_not_reached ();
@@ -870,6 +1383,99 @@ json_node_is_immutable (JsonNode *node)
   return node->immutable;
 }
 
+/*< private >
+ * json_node_set_thread_local:
+ * @node: a #JsonNode
+ * @owner: the tag of the thread using @node
+ *
+ * Marks @node, and the nodes below it, as used only by the thread with
+ * tag @owner. Nodes and containers that are also referenced from outside
+ * of the tree are left alone, as other threads may be using them; so are
+ * the nodes inside an arena, as they share the reference count of their
+ * arena.
+ */
+void
+json_node_set_thread_local (JsonNode *node,
+                            guint     owner)
+{
+  guint i;
+
+  if (node->in_arena || node->ref_count > 1)
+    return;
+
+  node->thread_local = TRUE;
+  node->owner = owner;
+
+  if (node->type == JSON_NODE_OBJECT && node->data.object != NULL)
+    {
+      JsonObject *object = node->data.object;
+
+      if (object->ref_count > 1)
+        return;
+
+      for (i = 0; i < object->members_len; i++)
+        {
+          if (object->members[i].key != NULL)
+            json_node_set_thread_local (object->members[i].value, owner);
+        }
+    }
+  else if (node->type == JSON_NODE_ARRAY && node->data.array != NULL)
+    {
+      JsonArray *array = node->data.array;
+
+      if (array->ref_count > 1)
+        return;
+
+      /* the nodes of packed elements that are created later inherit
+       * the flag from @array
+       */
+      array->thread_local = TRUE;
+      array->owner = owner;
+
+      if (array->storage != JSON_ARRAY_STORAGE_NODES)
+        {
+          if (array->nodes != NULL)
+            {
+              for (i = 0; i < array->packed_len; i++)
+                {
+                  if (array->nodes[i] != NULL)
+                    json_node_set_thread_local (array->nodes[i], owner);
+                }
+            }
+        }
+      else
+        {
+          for (i = 0; i < array->elements->len; i++)
+            json_node_set_thread_local (g_ptr_array_index (array->elements, i), owner);
+        }
+    }
+}
+
+/**
+ * json_node_is_thread_local:
+ * @node: a #JsonNode
+ *
+ * Checks whether @node belongs to a thread-local document, created by
+ * a #JsonParser or a #JsonBuilder with their thread-local property set.
+ *
+ * The reference count of a thread-local node is not atomic, which makes
+ * acquiring and releasing references on it cheaper, but the node must
+ * only be used from the thread that created it, even if it is immutable.
+ * Use json_node_deep_copy() to pass the contents of a thread-local node
+ * to another thread.
+ *
+ * Returns: %TRUE if the @node is thread-local
+ *
+ * Since: 1.4
+ */
+gboolean
+json_node_is_thread_local (JsonNode *node)
+{
+  g_return_val_if_fail (JSON_NODE_IS_VALID (node), FALSE);
+
+  return node->thread_local;
+}
+
 /**
  * json_node_type_name:
  * @node: a #JsonNode
@@ -892,8 +1498,8 @@ json_node_type_name (JsonNode *node)
       return json_node_type_get_name (node->type);
 
     case JSON_NODE_VALUE:
-      if (node->data.value)
-        return json_value_type_get_name (node->data.value->type);
+      if (node->value_type != JSON_VALUE_INVALID)
+        return json_value_type_get_name (node->value_type);
     }
 
   return "unknown";
@@ -982,12 +1588,35 @@ json_node_set_string (JsonNode    *node,
   g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
   g_return_if_fail (!node->immutable);
 
-  if (node->data.value == NULL)
-    node->data.value = json_value_init (json_value_alloc (), JSON_VALUE_STRING);
+  if (value != NULL)
+    json_node_store_string (node, value, strlen (value));
   else
-    json_value_init (node->data.value, JSON_VALUE_STRING);
+    json_node_reset_value (node, JSON_VALUE_STRING);
+}
 
-  json_value_set_string (node->data.value, value);
+/*< private >
+ * json_node_set_string_len:
+ * @node: a #JsonNode initialized to %JSON_NODE_VALUE
+ * @value: a string value
+ * @len: the length of @value
+ *
+ * Like json_node_set_string(), but copies only the first @len bytes
+ * of @value, which does not need to be nul-terminated.
+ *
+ * If @node was allocated inside an arena, the copy of @value is
+ * allocated inside the same arena.
+ */
+void
+json_node_set_string_len (JsonNode    *node,
+                          const gchar *value,
+                          gsize        len)
+{
+  g_return_if_fail (JSON_NODE_IS_VALID (node));
+  g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
+  g_return_if_fail (!node->immutable);
+  g_return_if_fail (value != NULL);
+
+  json_node_store_string (node, value, len);
 }
 
 /**
@@ -1007,8 +1636,8 @@ json_node_get_string (JsonNode *node)
   if (JSON_NODE_TYPE (node) == JSON_NODE_NULL)
     return NULL;
 
-  if (JSON_VALUE_HOLDS_STRING (node->data.value))
-    return json_value_get_string (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_STRING))
+    return json_node_peek_string (node);
 
   return NULL;
 }
@@ -1050,12 +1679,8 @@ json_node_set_int (JsonNode *node,
   g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
   g_return_if_fail (!node->immutable);
 
-  if (node->data.value == NULL)
-    node->data.value = json_value_init (json_value_alloc (), JSON_VALUE_INT);
-  else
-    json_value_init (node->data.value, JSON_VALUE_INT);
-
-  json_value_set_int (node->data.value, value);
+  json_node_reset_value (node, JSON_VALUE_INT);
+  node->data.v_int = value;
 }
 
 /**
@@ -1078,14 +1703,14 @@ json_node_get_int (JsonNode *node)
   if (JSON_NODE_TYPE (node) == JSON_NODE_NULL)
     return 0;
 
-  if (JSON_VALUE_HOLDS_INT (node->data.value))
-    return json_value_get_int (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_INT))
+    return node->data.v_int;
 
-  if (JSON_VALUE_HOLDS_DOUBLE (node->data.value))
-    return json_value_get_double (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_DOUBLE))
+    return node->data.v_double;
 
-  if (JSON_VALUE_HOLDS_BOOLEAN (node->data.value))
-    return json_value_get_boolean (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_BOOLEAN))
+    return node->data.v_bool;
 
   return 0;
 }
@@ -1108,12 +1733,8 @@ json_node_set_double (JsonNode *node,
   g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
   g_return_if_fail (!node->immutable);
 
-  if (node->data.value == NULL)
-    node->data.value = json_value_init (json_value_alloc (), JSON_VALUE_DOUBLE);
-  else
-    json_value_init (node->data.value, JSON_VALUE_DOUBLE);
-
-  json_value_set_double (node->data.value, value);
+  json_node_reset_value (node, JSON_VALUE_DOUBLE);
+  node->data.v_double = value;
 }
 
 /**
@@ -1136,14 +1757,14 @@ json_node_get_double (JsonNode *node)
   if (JSON_NODE_TYPE (node) == JSON_NODE_NULL)
     return 0;
 
-  if (JSON_VALUE_HOLDS_DOUBLE (node->data.value))
-    return json_value_get_double (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_DOUBLE))
+    return node->data.v_double;
 
-  if (JSON_VALUE_HOLDS_INT (node->data.value))
-    return (gdouble) json_value_get_int (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_INT))
+    return (gdouble) node->data.v_int;
 
-  if (JSON_VALUE_HOLDS_BOOLEAN (node->data.value))
-    return (gdouble) json_value_get_boolean (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_BOOLEAN))
+    return (gdouble) node->data.v_bool;
 
   return 0.0;
 }
@@ -1166,12 +1787,8 @@ json_node_set_boolean (JsonNode *node,
   g_return_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE);
   g_return_if_fail (!node->immutable);
 
-  if (node->data.value == NULL)
-    node->data.value = json_value_init (json_value_alloc (), JSON_VALUE_BOOLEAN);
-  else
-    json_value_init (node->data.value, JSON_VALUE_BOOLEAN);
-
-  json_value_set_boolean (node->data.value, value);
+  json_node_reset_value (node, JSON_VALUE_BOOLEAN);
+  node->data.v_bool = value;
 }
 
 /**
@@ -1193,14 +1810,14 @@ json_node_get_boolean (JsonNode *node)
   if (JSON_NODE_TYPE (node) == JSON_NODE_NULL)
     return FALSE;
 
-  if (JSON_VALUE_HOLDS_BOOLEAN (node->data.value))
-    return json_value_get_boolean (node->data.value);
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_BOOLEAN))
+    return node->data.v_bool;
 
-  if (JSON_VALUE_HOLDS_INT (node->data.value))
-    return json_value_get_int (node->data.value) != 0;
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_INT))
+    return node->data.v_int != 0;
 
-  if (JSON_VALUE_HOLDS_DOUBLE (node->data.value))
-    return json_value_get_double (node->data.value) != 0.0;
+  if (JSON_NODE_HOLDS_VALUE_TYPE (node, JSON_VALUE_DOUBLE))
+    return node->data.v_double != 0.0;
 
   return FALSE;
 }
@@ -1269,11 +1886,12 @@ json_type_is_a (JsonNode  *sub,
     {
       JsonValueType super_value_type, sub_value_type;
 
-      if (super->data.value == NULL || sub->data.value == NULL)
+      if (super->value_type == JSON_VALUE_INVALID ||
+          sub->value_type == JSON_VALUE_INVALID)
         return FALSE;
 
-      super_value_type = super->data.value->type;
-      sub_value_type = sub->data.value->type;
+      super_value_type = super->value_type;
+      sub_value_type = sub->value_type;
 
       return (super_value_type == sub_value_type ||
               (super_value_type == JSON_VALUE_DOUBLE &&
@@ -1338,6 +1956,44 @@ json_string_compare (gconstpointer  a,
   return g_strcmp0 (a, b);
 }
 
+static guint
+json_node_value_hash (JsonNode *node)
+{
+  guint value_hash;
+  guint type_hash;
+
+  /* Hash the type and value separately.
+   * Use the top 3 bits to store the type. */
+  type_hash = (guint) node->value_type << (sizeof (guint) * 8 - 3);
+
+  switch (node->value_type)
+    {
+    case JSON_VALUE_NULL:
+      value_hash = 0;
+      break;
+    case JSON_VALUE_BOOLEAN:
+      value_hash = node->data.v_bool ? 1 : 0;
+      break;
+    case JSON_VALUE_STRING:
+      value_hash = json_string_hash (json_node_peek_string (node));
+      break;
+    case JSON_VALUE_INT:
+      value_hash = g_int64_hash (&node->data.v_int);
+      break;
+    case JSON_VALUE_DOUBLE:
+      value_hash = g_double_hash (&node->data.v_double);
+      break;
+    case JSON_VALUE_INVALID:
+    default:
+      g_assert_not_reached ();
+    }
+
+  /* Mask out the top 3 bits of the @value_hash. */
+  value_hash &= ~(7u << (sizeof (guint) * 8 - 3));
+
+  return (type_hash | value_hash);
+}
+
 /**
  * json_node_hash:
  * @key: (type JsonNode): a JSON node to hash
@@ -1372,11 +2028,11 @@ json_node_hash (gconstpointer key)
     case JSON_NODE_NULL:
       return 0;
     case JSON_NODE_VALUE:
-      return value_hash ^ json_value_hash (node->data.value);
+      return value_hash ^ json_node_value_hash (node);
     case JSON_NODE_ARRAY:
-      return array_hash ^ json_array_hash (json_node_get_array (node));
+      return array_hash ^ json_array_hash (node->data.array);
     case JSON_NODE_OBJECT:
-      return object_hash ^ json_object_hash (json_node_get_object (node));
+      return object_hash ^ json_object_hash (node->data.object);
     default:
       g_assert_not_reached ();
     }
@@ -1421,11 +2077,9 @@ json_node_equal (gconstpointer  a,
       /* Types match already. */
       return TRUE;
     case JSON_NODE_ARRAY:
-      return json_array_equal (json_node_get_array (node_a),
-                               json_node_get_array (node_b));
+      return json_array_equal (node_a->data.array, node_b->data.array);
     case JSON_NODE_OBJECT:
-      return json_object_equal (json_node_get_object (node_a),
-                                json_node_get_object (node_b));
+      return json_object_equal (node_a->data.object, node_b->data.object);
     case JSON_NODE_VALUE:
       /* Handled below. */
       break;
@@ -1434,7 +2088,7 @@ json_node_equal (gconstpointer  a,
     }
 
   /* Handle values. */
-  switch (node_a->data.value->type)
+  switch (node_a->value_type)
     {
     case JSON_VALUE_NULL:
       /* Types already match. */
@@ -1449,8 +2103,8 @@ json_node_equal (gconstpointer  a,
       gdouble val_a, val_b;
       JsonValueType value_type_a, value_type_b;
 
-      value_type_a = node_a->data.value->type;
-      value_type_b = node_b->data.value->type;
+      value_type_a = node_a->value_type;
+      value_type_b = node_b->value_type;
 
       /* Integer comparison doesn’t need to involve doubles… */
       if (value_type_a == JSON_VALUE_INT &&
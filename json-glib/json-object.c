@@ -49,6 +49,12 @@
 
 G_DEFINE_BOXED_TYPE (JsonObject, json_object, json_object_ref, json_object_unref);
 
+/* objects with up to this many members are searched linearly; most
+ * objects are small, and comparing a few names is cheaper than hashing
+ * the name we are looking for
+ */
+#define OBJECT_INDEX_THRESHOLD  8
+
 /**
  * json_object_new: (constructor)
  * 
@@ -64,10 +70,64 @@ json_object_new (void)
   object = g_slice_new0 (JsonObject);
   
   object->ref_count = 1;
-  object->members = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                           g_free,
-                                           (GDestroyNotify) json_node_unref);
-  object->members_ordered = NULL;
+
+  return object;
+}
+
+/* objects inside an arena do not own the nodes of the same arena, which
+ * are released with it, but they own the nodes added to them afterwards
+ */
+static inline void
+object_release_node (JsonObject *object,
+                     JsonNode   *node)
+{
+  if (!object->in_arena || !node->in_arena ||
+      json_arena_from_pointer (node) != json_arena_from_pointer (object))
+    json_node_unref (node);
+}
+
+static void
+json_object_free_arena_data (gpointer data)
+{
+  JsonObject *object = data;
+  guint i;
+
+  for (i = 0; i < object->members_len; i++)
+    {
+      if (object->members[i].key == NULL)
+        continue;
+
+      json_key_unref (object->members[i].key);
+      object_release_node (object, object->members[i].value);
+    }
+
+  g_free (object->members);
+  g_free (object->index);
+}
+
+/*< private >
+ * json_object_new_in_arena:
+ * @arena: a #JsonArena
+ *
+ * Creates a new #JsonObject inside @arena.
+ *
+ * The object does not release the member names and nodes allocated
+ * inside @arena when it's destroyed, as they are released with the
+ * arena.
+ *
+ * Returns: (transfer none): the newly created #JsonObject
+ */
+JsonObject *
+json_object_new_in_arena (JsonArena *arena)
+{
+  JsonObject *object;
+
+  object = json_arena_alloc (arena, sizeof (JsonObject));
+
+  object->ref_count = 1;
+  object->in_arena = TRUE;
+
+  json_arena_add_cleanup (arena, json_object_free_arena_data, object);
 
   return object;
 }
@@ -87,6 +147,13 @@ json_object_ref (JsonObject *object)
   g_return_val_if_fail (object != NULL, NULL);
   g_return_val_if_fail (object->ref_count > 0, NULL);
 
+  /* objects inside an arena live as long as their document */
+  if (object->in_arena)
+    {
+      json_arena_ref (json_arena_from_pointer (object));
+      return object;
+    }
+
   object->ref_count++;
 
   return object;
@@ -106,12 +173,27 @@ json_object_unref (JsonObject *object)
   g_return_if_fail (object != NULL);
   g_return_if_fail (object->ref_count > 0);
 
+  if (object->in_arena)
+    {
+      json_arena_unref (json_arena_from_pointer (object));
+      return;
+    }
+
   if (--object->ref_count == 0)
     {
-      g_list_free (object->members_ordered);
-      g_hash_table_destroy (object->members);
-      object->members_ordered = NULL;
-      object->members = NULL;
+      guint i;
+
+      for (i = 0; i < object->members_len; i++)
+        {
+          if (object->members[i].key == NULL)
+            continue;
+
+          json_key_unref (object->members[i].key);
+          json_node_unref (object->members[i].value);
+        }
+
+      g_free (object->members);
+      g_free (object->index);
 
       g_slice_free (JsonObject, object);
     }
@@ -169,29 +251,258 @@ json_object_is_immutable (JsonObject *object)
   return object->immutable;
 }
 
+/* the slots of the index hold the position of a member plus one, so
+ * that empty slots are zero
+ */
 static inline void
-object_set_member_internal (JsonObject  *object,
-                            const gchar *member_name,
-                            JsonNode    *node)
+object_index_insert (JsonObject *object,
+                     guint       hash,
+                     guint       position)
 {
-  gchar *name = g_strdup (member_name);
+  guint mask = object->index_size - 1;
+  guint slot = hash & mask;
 
-  if (g_hash_table_lookup (object->members, name) == NULL)
-    object->members_ordered = g_list_prepend (object->members_ordered, name);
-  else
+  while (object->index[slot] != 0)
+    slot = (slot + 1) & mask;
+
+  object->index[slot] = position + 1;
+}
+
+static void
+object_build_index (JsonObject *object)
+{
+  guint size = 16;
+  guint i;
+
+  /* keep the load factor under 3/4 */
+  while (size * 3 < (object->n_members + 1) * 4)
+    size *= 2;
+
+  g_free (object->index);
+  object->index = g_new0 (guint, size);
+  object->index_size = size;
+
+  for (i = 0; i < object->members_len; i++)
+    {
+      if (object->members[i].key != NULL)
+        object_index_insert (object, object->members[i].key->hash, i);
+    }
+}
+
+/* removes the member at @position from the index, and moves the
+ * following slots back so that lookups do not need tombstones
+ */
+static void
+object_index_remove (JsonObject *object,
+                     guint       hash,
+                     guint       position)
+{
+  guint mask = object->index_size - 1;
+  guint i, j;
+
+  i = hash & mask;
+  while (object->index[i] != position + 1)
+    i = (i + 1) & mask;
+
+  j = i;
+  for (;;)
     {
-      GList *l;
+      guint home;
+
+      j = (j + 1) & mask;
+      if (object->index[j] == 0)
+        break;
 
-      /* if the member already exists then we need to replace the
-       * pointer to its name, to avoid keeping invalid pointers
-       * once we replace the key in the hash table
+      home = object->members[object->index[j] - 1].key->hash & mask;
+
+      /* the slot can fill the hole unless it's reachable from its
+       * home slot without going through the hole
        */
-      l = g_list_find_custom (object->members_ordered, name, (GCompareFunc) strcmp);
-      if (l != NULL)
-        l->data = name;
+      if ((i < j && (home <= i || home > j)) ||
+          (i > j && (home <= i && home > j)))
+        {
+          object->index[i] = object->index[j];
+          i = j;
+        }
+    }
+
+  object->index[i] = 0;
+}
+
+static inline gint
+object_index_lookup (JsonObject    *object,
+                     const JsonKey *key,
+                     const gchar   *name,
+                     gsize          len,
+                     guint          hash)
+{
+  guint mask = object->index_size - 1;
+  guint slot = hash & mask;
+  guint position;
+
+  while ((position = object->index[slot]) != 0)
+    {
+      const JsonKey *member_key = object->members[position - 1].key;
+
+      if (member_key == key ||
+          (member_key->hash == hash &&
+           member_key->len == len &&
+           memcmp (member_key->name, name, len) == 0))
+        return position - 1;
+
+      slot = (slot + 1) & mask;
+    }
+
+  return -1;
+}
+
+/* returns the position of the member called @member_name, or -1 */
+static inline gint
+object_find_member (JsonObject  *object,
+                    const gchar *member_name)
+{
+  guint i;
+
+  if (object->index != NULL)
+    {
+      gsize len;
+      guint hash = json_key_hash (member_name, &len);
+
+      return object_index_lookup (object, NULL, member_name, len, hash);
     }
 
-  g_hash_table_replace (object->members, name, node);
+  /* keys are shared between objects, so the name we are looking for
+   * is often the same string as the name of the member
+   */
+  for (i = 0; i < object->members_len; i++)
+    {
+      const JsonKey *key = object->members[i].key;
+
+      if (key != NULL && (key->name == member_name || strcmp (key->name, member_name) == 0))
+        return i;
+    }
+
+  return -1;
+}
+
+/* like object_find_member(), but uses the hash stored in @key instead
+ * of hashing the name again, and compares the hashes of the keys
+ * before comparing their names
+ */
+static inline gint
+object_find_key (JsonObject    *object,
+                 const JsonKey *key)
+{
+  guint i;
+
+  if (object->index != NULL)
+    return object_index_lookup (object, key, key->name, key->len, key->hash);
+
+  for (i = 0; i < object->members_len; i++)
+    {
+      const JsonKey *member_key = object->members[i].key;
+
+      if (member_key == key)
+        return i;
+
+      if (member_key != NULL &&
+          member_key->hash == key->hash &&
+          member_key->len == key->len &&
+          memcmp (member_key->name, key->name, key->len) == 0)
+        return i;
+    }
+
+  return -1;
+}
+
+static inline JsonNode *
+object_get_member_internal (JsonObject  *object,
+                            const gchar *member_name)
+{
+  gint position = object_find_member (object, member_name);
+
+  return position >= 0 ? object->members[position].value : NULL;
+}
+
+static inline JsonNode *
+object_get_key_internal (JsonObject    *object,
+                         const JsonKey *key)
+{
+  gint position = object_find_key (object, key);
+
+  return position >= 0 ? object->members[position].value : NULL;
+}
+
+/* moves the members over the holes left by json_object_remove_member() */
+static void
+object_compact (JsonObject *object)
+{
+  guint i, j;
+
+  for (i = 0, j = 0; i < object->members_len; i++)
+    {
+      if (object->members[i].key == NULL)
+        continue;
+
+      if (i != j)
+        object->members[j] = object->members[i];
+
+      j += 1;
+    }
+
+  object->members_len = j;
+
+  /* the positions of the members have changed */
+  if (object->index != NULL)
+    object_build_index (object);
+}
+
+/* takes ownership of @key */
+static inline void
+object_set_member_internal (JsonObject *object,
+                            JsonKey    *key,
+                            JsonNode   *node)
+{
+  JsonObjectMember *member;
+  gint position;
+
+  position = object_find_key (object, key);
+  if (position >= 0)
+    {
+      /* replacing the value of a member keeps its position */
+      member = &object->members[position];
+
+      object_release_node (object, member->value);
+      json_key_unref (key);
+
+      member->value = node;
+
+      return;
+    }
+
+  if (object->members_len == object->members_size)
+    {
+      /* reuse the holes before growing the array */
+      if (object->members_len - object->n_members > object->members_len / 4)
+        object_compact (object);
+      else
+        {
+          object->members_size = MAX (object->members_size * 2, 4);
+          object->members = g_renew (JsonObjectMember, object->members, object->members_size);
+        }
+    }
+
+  member = &object->members[object->members_len];
+  member->key = key;
+  member->value = node;
+
+  object->members_len += 1;
+  object->n_members += 1;
+
+  if (object->index != NULL && object->n_members * 4 <= object->index_size * 3)
+    object_index_insert (object, key->hash, object->members_len - 1);
+  else if (object->n_members > OBJECT_INDEX_THRESHOLD)
+    object_build_index (object);
 }
 
 /**
@@ -225,7 +536,7 @@ json_object_add_member (JsonObject  *object,
       return;
     }
 
-  object_set_member_internal (object, member_name, node);
+  object_set_member_internal (object, json_key_new_len (member_name, -1), node);
 }
 
 /**
@@ -253,15 +564,136 @@ json_object_set_member (JsonObject  *object,
   g_return_if_fail (member_name != NULL);
   g_return_if_fail (node != NULL);
 
-  old_node = g_hash_table_lookup (object->members, member_name);
-  if (old_node == NULL)
-    goto set_member;
-
+  old_node = object_get_member_internal (object, member_name);
   if (old_node == node)
     return;
 
-set_member:
-  object_set_member_internal (object, member_name, node);
+  object_set_member_internal (object, json_key_new_len (member_name, -1), node);
+}
+
+/*< private >
+ * json_object_take_member:
+ * @object: a #JsonObject
+ * @key: (transfer full): the key of the member
+ * @node: (transfer full): the value of the member
+ *
+ * Like json_object_set_member(), but takes ownership of a #JsonKey
+ * instead of copying the name of the member; this allows objects to
+ * share the keys of their members.
+ *
+ * If @object is inside an arena, @key must be allocated inside the
+ * same arena.
+ *
+ * Returns: (transfer none): the name of the member, owned by @object;
+ *   @key is released if @object already had a member with the same name
+ */
+const gchar *
+json_object_take_member (JsonObject *object,
+                         JsonKey    *key,
+                         JsonNode   *node)
+{
+  gint position;
+
+  g_return_val_if_fail (object != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+  g_return_val_if_fail (node != NULL, NULL);
+
+  position = object_find_key (object, key);
+  if (position >= 0)
+    {
+      JsonObjectMember *member = &object->members[position];
+
+      if (member->value != node)
+        object_release_node (object, member->value);
+      json_key_unref (key);
+
+      member->value = node;
+
+      return member->key->name;
+    }
+
+  object_set_member_internal (object, key, node);
+
+  return key->name;
+}
+
+/*< private >
+ * json_object_copy_shared:
+ * @object: a #JsonObject
+ * @parent: the node that will hold the copy
+ *
+ * Creates a mutable copy of @object, whose members are copies of the
+ * members of @object created with json_node_share(). The copy is inside
+ * the arena of @parent, if it has one.
+ *
+ * Returns: (transfer full): the copy of @object
+ */
+JsonObject *
+json_object_copy_shared (JsonObject *object,
+                         JsonNode   *parent)
+{
+  JsonArena *arena = NULL;
+  JsonObject *copy;
+  guint i;
+
+  if (parent->in_arena)
+    {
+      arena = json_arena_from_pointer (parent);
+      copy = json_object_new_in_arena (arena);
+    }
+  else
+    copy = json_object_new ();
+
+  copy->members = g_new (JsonObjectMember, object->n_members);
+  copy->members_size = object->n_members;
+
+  for (i = 0; i < object->members_len; i++)
+    {
+      JsonObjectMember *member = &object->members[i];
+      JsonKey *key = member->key;
+      JsonObjectMember *dest;
+
+      if (key == NULL)
+        continue;
+
+      dest = &copy->members[copy->members_len++];
+
+      /* keys inside an arena live as long as the arena does */
+      if (arena != NULL)
+        dest->key = key->ref_count == 0 && json_arena_from_pointer (key) == arena
+                  ? key
+                  : json_key_new_in_arena (arena, key->name, key->len);
+      else
+        dest->key = key->ref_count != 0 ? json_key_ref (key) : json_key_new_len (key->name, key->len);
+
+      dest->value = json_node_share (member->value, parent);
+    }
+
+  copy->n_members = copy->members_len;
+
+  if (copy->n_members > OBJECT_INDEX_THRESHOLD)
+    object_build_index (copy);
+
+  return copy;
+}
+
+/*< private >
+ * json_object_reserve:
+ * @object: a #JsonObject
+ * @n_members: the number of members to make room for
+ *
+ * Makes room for @n_members more members inside @object, so that
+ * adding them does not need to grow it multiple times.
+ */
+void
+json_object_reserve (JsonObject *object,
+                     guint       n_members)
+{
+  if (object->members_len + n_members <= object->members_size)
+    return;
+
+  object->members_size = object->members_len + n_members;
+  object->members = g_renew (JsonObjectMember, object->members, object->members_size);
 }
 
 /**
@@ -285,7 +717,7 @@ json_object_set_int_member (JsonObject  *object,
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  object_set_member_internal (object, member_name, json_node_init_int (json_node_alloc (), value));
+  object_set_member_internal (object, json_key_new_len (member_name, -1), json_node_init_int (json_node_alloc (), value));
 }
 
 /**
@@ -309,7 +741,7 @@ json_object_set_double_member (JsonObject  *object,
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  object_set_member_internal (object, member_name, json_node_init_double (json_node_alloc (), value));
+  object_set_member_internal (object, json_key_new_len (member_name, -1), json_node_init_double (json_node_alloc (), value));
 }
 
 /**
@@ -333,7 +765,7 @@ json_object_set_boolean_member (JsonObject  *object,
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  object_set_member_internal (object, member_name, json_node_init_boolean (json_node_alloc (), value));
+  object_set_member_internal (object, json_key_new_len (member_name, -1), json_node_init_boolean (json_node_alloc (), value));
 }
 
 /**
@@ -366,7 +798,7 @@ json_object_set_string_member (JsonObject  *object,
   else
     json_node_init_null (node);
 
-  object_set_member_internal (object, member_name, node);
+  object_set_member_internal (object, json_key_new_len (member_name, -1), node);
 }
 
 /**
@@ -388,7 +820,7 @@ json_object_set_null_member (JsonObject  *object,
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  object_set_member_internal (object, member_name, json_node_init_null (json_node_alloc ()));
+  object_set_member_internal (object, json_key_new_len (member_name, -1), json_node_init_null (json_node_alloc ()));
 }
 
 /**
@@ -426,7 +858,7 @@ json_object_set_array_member (JsonObject  *object,
   else
     json_node_init_null (node);
 
-  object_set_member_internal (object, member_name, node);
+  object_set_member_internal (object, json_key_new_len (member_name, -1), node);
 }
 
 /**
@@ -464,7 +896,7 @@ json_object_set_object_member (JsonObject  *object,
   else
     json_node_init_null (node);
 
-  object_set_member_internal (object, member_name, node);
+  object_set_member_internal (object, json_key_new_len (member_name, -1), node);
 }
 
 /**
@@ -483,13 +915,18 @@ json_object_set_object_member (JsonObject  *object,
 GList *
 json_object_get_members (JsonObject *object)
 {
-  GList *copy;
+  GList *members = NULL;
+  guint i;
 
   g_return_val_if_fail (object != NULL, NULL);
 
-  copy = g_list_copy (object->members_ordered);
+  for (i = object->members_len; i > 0; i--)
+    {
+      if (object->members[i - 1].key != NULL)
+        members = g_list_prepend (members, object->members[i - 1].key->name);
+    }
 
-  return g_list_reverse (copy);
+  return members;
 }
 
 /**
@@ -507,13 +944,16 @@ json_object_get_members (JsonObject *object)
 GList *
 json_object_get_values (JsonObject *object)
 {
-  GList *values, *l;
+  GList *values = NULL;
+  guint i;
 
   g_return_val_if_fail (object != NULL, NULL);
 
-  values = NULL;
-  for (l = object->members_ordered; l != NULL; l = l->next)
-    values = g_list_prepend (values, g_hash_table_lookup (object->members, l->data));
+  for (i = object->members_len; i > 0; i--)
+    {
+      if (object->members[i - 1].key != NULL)
+        values = g_list_prepend (values, object->members[i - 1].value);
+    }
 
   return values;
 }
@@ -547,13 +987,6 @@ json_object_dup_member (JsonObject  *object,
   return json_node_copy (retval);
 }
 
-static inline JsonNode *
-object_get_member_internal (JsonObject  *object,
-                            const gchar *member_name)
-{
-  return g_hash_table_lookup (object->members, member_name);
-}
-
 /**
  * json_object_get_member:
  * @object: a #JsonObject
@@ -695,10 +1128,10 @@ json_object_get_null_member (JsonObject  *object,
     return TRUE;
 
   if (JSON_NODE_HOLDS_OBJECT (node))
-    return json_node_get_object (node) == NULL;
+    return node->data.object == NULL;
 
   if (JSON_NODE_HOLDS_ARRAY (node))
-    return json_node_get_array (node) == NULL;
+    return node->data.array == NULL;
 
   return FALSE;
 }
@@ -820,7 +1253,7 @@ json_object_has_member (JsonObject *object,
   g_return_val_if_fail (object != NULL, FALSE);
   g_return_val_if_fail (member_name != NULL, FALSE);
 
-  return (g_hash_table_lookup (object->members, member_name) != NULL);
+  return object_find_member (object, member_name) >= 0;
 }
 
 /**
@@ -836,7 +1269,7 @@ json_object_get_size (JsonObject *object)
 {
   g_return_val_if_fail (object != NULL, 0);
 
-  return g_hash_table_size (object->members);
+  return object->n_members;
 }
 
 /**
@@ -850,23 +1283,37 @@ void
 json_object_remove_member (JsonObject  *object,
                            const gchar *member_name)
 {
-  GList *l;
+  JsonObjectMember member;
+  gint position;
 
   g_return_if_fail (object != NULL);
   g_return_if_fail (member_name != NULL);
 
-  for (l = object->members_ordered; l != NULL; l = l->next)
-    {
-      const gchar *name = l->data;
+  position = object_find_member (object, member_name);
+  if (position < 0)
+    return;
 
-      if (g_strcmp0 (name, member_name) == 0)
-        {
-          object->members_ordered = g_list_delete_link (object->members_ordered, l);
-          break;
-        }
-    }
+  member = object->members[position];
+
+  if (object->index != NULL)
+    object_index_remove (object, member.key->hash, position);
+
+  /* leave a hole, instead of moving all the members after this one;
+   * the holes are compacted away once they outnumber the members,
+   * which keeps removals constant time on average
+   */
+  object->members[position].key = NULL;
+  object->members[position].value = NULL;
+  object->n_members -= 1;
+
+  while (object->members_len > 0 && object->members[object->members_len - 1].key == NULL)
+    object->members_len -= 1;
 
-  g_hash_table_remove (object->members, member_name);
+  if (object->members_len - object->n_members > object->n_members)
+    object_compact (object);
+
+  json_key_unref (member.key);
+  object_release_node (object, member.value);
 }
 
 /**
@@ -889,19 +1336,15 @@ json_object_foreach_member (JsonObject        *object,
                             JsonObjectForeach  func,
                             gpointer           data)
 {
-  GList *members, *l;
+  guint i;
 
   g_return_if_fail (object != NULL);
   g_return_if_fail (func != NULL);
 
-  /* the list is stored in reverse order to have constant time additions */
-  members = g_list_last (object->members_ordered);
-  for (l = members; l != NULL; l = l->prev)
+  for (i = 0; i < object->members_len; i++)
     {
-      const gchar *member_name = l->data;
-      JsonNode *member_node = g_hash_table_lookup (object->members, member_name);
-
-      func (object, member_name, member_node, data);
+      if (object->members[i].key != NULL)
+        func (object, object->members[i].key->name, object->members[i].value, data);
     }
 }
 
@@ -1033,7 +1476,7 @@ json_object_iter_init (JsonObjectIter  *iter,
   g_return_if_fail (object->ref_count > 0);
 
   iter_real->object = object;
-  g_hash_table_iter_init (&iter_real->members_iter, object->members);
+  iter_real->position = 0;
 }
 
 /**
@@ -1062,12 +1505,333 @@ json_object_iter_next (JsonObjectIter  *iter,
                        JsonNode       **member_node)
 {
   JsonObjectIterReal *iter_real = (JsonObjectIterReal *) iter;
+  JsonObjectMember *member;
 
   g_return_val_if_fail (iter != NULL, FALSE);
   g_return_val_if_fail (iter_real->object != NULL, FALSE);
   g_return_val_if_fail (iter_real->object->ref_count > 0, FALSE);
 
-  return g_hash_table_iter_next (&iter_real->members_iter,
-                                 (gpointer *) member_name,
-                                 (gpointer *) member_node);
+  do
+    {
+      if ((guint) iter_real->position >= iter_real->object->members_len)
+        return FALSE;
+
+      member = &iter_real->object->members[iter_real->position++];
+    }
+  while (member->key == NULL);
+
+  if (member_name != NULL)
+    *member_name = member->key->name;
+  if (member_node != NULL)
+    *member_node = member->value;
+
+  return TRUE;
+}
+
+/**
+ * json_object_set_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ * @node: (transfer full): the value of the member
+ *
+ * Sets @node as the value of the member named by @key inside @object.
+ *
+ * Unlike json_object_set_member(), @object does not copy the name of
+ * the member, but acquires a reference on @key instead; all the objects
+ * using the same #JsonKey share its name, and looking their members up
+ * using @key only needs to compare pointers.
+ *
+ * See also: json_object_set_member()
+ *
+ * Since: 1.4
+ */
+void
+json_object_set_member_by_key (JsonObject *object,
+                               JsonKey    *key,
+                               JsonNode   *node)
+{
+  g_return_if_fail (object != NULL);
+  g_return_if_fail (key != NULL);
+  g_return_if_fail (node != NULL);
+
+  if (object_get_key_internal (object, key) == node)
+    return;
+
+  object_set_member_internal (object, json_key_ref (key), node);
+}
+
+/**
+ * json_object_get_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Retrieves the #JsonNode containing the value of the member named
+ * by @key inside a #JsonObject.
+ *
+ * See also: json_object_get_member()
+ *
+ * Return value: (transfer none) (nullable): a pointer to the node for the
+ *   requested object member, or %NULL
+ *
+ * Since: 1.4
+ */
+JsonNode *
+json_object_get_member_by_key (JsonObject    *object,
+                               const JsonKey *key)
+{
+  g_return_val_if_fail (object != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  return object_get_key_internal (object, key);
+}
+
+/**
+ * json_object_get_int_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the integer value
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_int_member()
+ *
+ * Return value: the integer value of the object's member
+ *
+ * Since: 1.4
+ */
+gint64
+json_object_get_int_member_by_key (JsonObject    *object,
+                                   const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, 0);
+  g_return_val_if_fail (key != NULL, 0);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, 0);
+  g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, 0);
+
+  return json_node_get_int (node);
+}
+
+/**
+ * json_object_get_double_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the floating point value
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_double_member()
+ *
+ * Return value: the floating point value of the object's member
+ *
+ * Since: 1.4
+ */
+gdouble
+json_object_get_double_member_by_key (JsonObject    *object,
+                                      const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, 0.0);
+  g_return_val_if_fail (key != NULL, 0.0);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, 0.0);
+  g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, 0.0);
+
+  return json_node_get_double (node);
+}
+
+/**
+ * json_object_get_boolean_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the boolean value
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_boolean_member()
+ *
+ * Return value: the boolean value of the object's member
+ *
+ * Since: 1.4
+ */
+gboolean
+json_object_get_boolean_member_by_key (JsonObject    *object,
+                                       const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, FALSE);
+  g_return_val_if_fail (JSON_NODE_TYPE (node) == JSON_NODE_VALUE, FALSE);
+
+  return json_node_get_boolean (node);
+}
+
+/**
+ * json_object_get_null_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that checks whether the value
+ * stored in the member of @object named by @key is null
+ *
+ * See also: json_object_get_null_member()
+ *
+ * Return value: %TRUE if the value is null
+ *
+ * Since: 1.4
+ */
+gboolean
+json_object_get_null_member_by_key (JsonObject    *object,
+                                    const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, FALSE);
+
+  if (JSON_NODE_HOLDS_NULL (node))
+    return TRUE;
+
+  if (JSON_NODE_HOLDS_OBJECT (node))
+    return node->data.object == NULL;
+
+  if (JSON_NODE_HOLDS_ARRAY (node))
+    return node->data.array == NULL;
+
+  return FALSE;
+}
+
+/**
+ * json_object_get_string_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the string value
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_string_member()
+ *
+ * Return value: the string value of the object's member
+ *
+ * Since: 1.4
+ */
+const gchar *
+json_object_get_string_member_by_key (JsonObject    *object,
+                                      const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, NULL);
+  g_return_val_if_fail (JSON_NODE_HOLDS_VALUE (node) || JSON_NODE_HOLDS_NULL (node), NULL);
+
+  if (JSON_NODE_HOLDS_NULL (node))
+    return NULL;
+
+  return json_node_get_string (node);
+}
+
+/**
+ * json_object_get_array_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the array
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_array_member()
+ *
+ * Return value: (transfer none): the array inside the object's member
+ *
+ * Since: 1.4
+ */
+JsonArray *
+json_object_get_array_member_by_key (JsonObject    *object,
+                                     const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, NULL);
+  g_return_val_if_fail (JSON_NODE_HOLDS_ARRAY (node) || JSON_NODE_HOLDS_NULL (node), NULL);
+
+  if (JSON_NODE_HOLDS_NULL (node))
+    return NULL;
+
+  return json_node_get_array (node);
+}
+
+/**
+ * json_object_get_object_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of the member
+ *
+ * Convenience function that retrieves the object
+ * stored in the member of @object named by @key
+ *
+ * See also: json_object_get_object_member()
+ *
+ * Return value: (transfer none) (nullable): the object inside the object’s
+ *    member, or %NULL if the value for the member is `null`
+ *
+ * Since: 1.4
+ */
+JsonObject *
+json_object_get_object_member_by_key (JsonObject    *object,
+                                      const JsonKey *key)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (object != NULL, NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  node = object_get_key_internal (object, key);
+  g_return_val_if_fail (node != NULL, NULL);
+  g_return_val_if_fail (JSON_NODE_HOLDS_OBJECT (node) || JSON_NODE_HOLDS_NULL (node), NULL);
+
+  if (JSON_NODE_HOLDS_NULL (node))
+    return NULL;
+
+  return json_node_get_object (node);
+}
+
+/**
+ * json_object_has_member_by_key:
+ * @object: a #JsonObject
+ * @key: the key of a JSON object member
+ *
+ * Checks whether @object has a member named by @key.
+ *
+ * See also: json_object_has_member()
+ *
+ * Return value: %TRUE if the JSON object has the requested member
+ *
+ * Since: 1.4
+ */
+gboolean
+json_object_has_member_by_key (JsonObject    *object,
+                               const JsonKey *key)
+{
+  g_return_val_if_fail (object != NULL, FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+
+  return object_find_key (object, key) >= 0;
 }
@@ -36,13 +36,19 @@
 
 #include <string.h>
 
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+
 #include <glib/gi18n-lib.h>
+#include <glib/gstdio.h>
 
 #include "json-types-private.h"
 
 #include "json-debug.h"
 #include "json-parser.h"
 #include "json-scanner.h"
+#include "json-stream-reader-private.h"
 
 struct _JsonParserPrivate
 {
@@ -51,6 +57,18 @@ struct _JsonParserPrivate
 
   JsonScanner *scanner;
 
+  /* the arena for the document being parsed, if any */
+  JsonArena *arena;
+
+  /* the interned member names of the current document */
+  JsonKeyTable *keys;
+
+  /* the state of json_parser_feed(): the reader holding the data that
+   * was not parsed yet, and the containers that are still open
+   */
+  JsonStreamReader *push_reader;
+  GArray *push_stack;
+
   JsonParserError error_code;
   GError *last_error;
 
@@ -60,27 +78,14 @@ struct _JsonParserPrivate
   guint has_assignment : 1;
   guint is_filename    : 1;
   guint is_immutable   : 1;
-};
+  guint use_arena      : 1;
+  guint intern_member_names : 1;
+  guint thread_local   : 1;
 
-static const gchar symbol_names[] =
-  "true\0"
-  "false\0"
-  "null\0"
-  "var\0";
-
-static const struct
-{
-  guint name_offset;
-  guint token;
-} symbols[] = {
-  {  0, JSON_TOKEN_TRUE  },
-  {  5, JSON_TOKEN_FALSE },
-  { 11, JSON_TOKEN_NULL  },
-  { 16, JSON_TOKEN_VAR   }
+  /* the tag of the thread using the current document, if thread-local */
+  guint owner;
 };
 
-static const guint n_symbols = G_N_ELEMENTS (symbols);
-
 enum
 {
   PARSE_START,
@@ -101,6 +106,9 @@ static guint parser_signals[LAST_SIGNAL] = { 0, };
 enum
 {
   PROP_IMMUTABLE = 1,
+  PROP_USE_ARENA,
+  PROP_INTERN_MEMBER_NAMES,
+  PROP_THREAD_LOCAL,
   PROP_LAST
 };
 
@@ -117,11 +125,92 @@ static guint json_parse_object (JsonParser   *parser,
                                 JsonScanner  *scanner,
                                 JsonNode    **node);
 
+typedef struct
+{
+  JsonNode *node;
+
+  /* the name of the member being parsed, for objects, or the index
+   * of the element being parsed, for arrays
+   */
+  JsonKey *member_key;
+  guint index;
+} JsonParserFrame;
+
+static void
+json_parser_push_reset (JsonParser *parser)
+{
+  JsonParserPrivate *priv = parser->priv;
+  guint i;
+
+  if (priv->push_reader == NULL)
+    return;
+
+  /* containers are added to their parent only once they are complete,
+   * so each open container needs to be released
+   */
+  if (priv->arena == NULL)
+    {
+      for (i = 0; i < priv->push_stack->len; i++)
+        {
+          JsonParserFrame *frame = &g_array_index (priv->push_stack, JsonParserFrame, i);
+
+          json_node_unref (frame->node);
+          if (frame->member_key != NULL)
+            json_key_unref (frame->member_key);
+        }
+    }
+  else
+    {
+      json_arena_unref (priv->arena);
+      priv->arena = NULL;
+    }
+
+  g_array_set_size (priv->push_stack, 0);
+  g_clear_object (&priv->push_reader);
+}
+
+/* the keys are bound to the arena of the document, if any, so they
+ * cannot be used once a new document begins
+ */
+static void
+json_parser_clear_keys (JsonParser *parser)
+{
+  JsonParserPrivate *priv = parser->priv;
+
+  if (priv->keys != NULL)
+    {
+      json_key_table_free (priv->keys);
+      priv->keys = NULL;
+    }
+}
+
+static inline void
+json_parser_begin_arena (JsonParser *parser)
+{
+  JsonParserPrivate *priv = parser->priv;
+
+  if (!priv->use_arena)
+    return;
+
+  json_parser_clear_keys (parser);
+  priv->arena = json_arena_new ();
+
+  if (priv->thread_local)
+    json_arena_set_thread_local (priv->arena, priv->owner);
+}
+
 static inline void
 json_parser_clear (JsonParser *parser)
 {
   JsonParserPrivate *priv = parser->priv;
 
+  json_parser_push_reset (parser);
+  json_parser_clear_keys (parser);
+
+  /* the next document belongs to the calling thread */
+  if (priv->thread_local)
+    priv->owner = json_thread_get_tag ();
+
   g_free (priv->variable_name);
   priv->variable_name = NULL;
 
@@ -154,6 +243,8 @@ json_parser_finalize (GObject *gobject)
   g_free (priv->variable_name);
   g_free (priv->filename);
 
+  g_array_unref (priv->push_stack);
+
   G_OBJECT_CLASS (json_parser_parent_class)->finalize (gobject);
 }
 
@@ -169,7 +260,21 @@ json_parser_set_property (GObject      *gobject,
     {
     case PROP_IMMUTABLE:
       /* Construct-only. */
-      priv->is_immutable = g_value_get_boolean (value);
+      priv->is_immutable = g_value_get_boolean (value) || priv->use_arena;
+      break;
+    case PROP_USE_ARENA:
+      /* Construct-only; arena documents are always immutable */
+      priv->use_arena = g_value_get_boolean (value);
+      if (priv->use_arena)
+        priv->is_immutable = TRUE;
+      break;
+    case PROP_INTERN_MEMBER_NAMES:
+      /* Construct-only. */
+      priv->intern_member_names = g_value_get_boolean (value);
+      break;
+    case PROP_THREAD_LOCAL:
+      /* Construct-only. */
+      priv->thread_local = g_value_get_boolean (value);
       break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
@@ -190,6 +295,15 @@ json_parser_get_property (GObject    *gobject,
     case PROP_IMMUTABLE:
       g_value_set_boolean (value, priv->is_immutable);
       break;
+    case PROP_USE_ARENA:
+      g_value_set_boolean (value, priv->use_arena);
+      break;
+    case PROP_INTERN_MEMBER_NAMES:
+      g_value_set_boolean (value, priv->intern_member_names);
+      break;
+    case PROP_THREAD_LOCAL:
+      g_value_set_boolean (value, priv->thread_local);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -222,6 +336,70 @@ json_parser_class_init (JsonParserClass *klass)
                           FALSE,
                           G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
 
+  /**
+   * JsonParser:use-arena:
+   *
+   * Whether the #JsonNode tree built by the #JsonParser should be allocated
+   * inside a single memory arena, instead of allocating each node, value,
+   * and string separately. The whole tree is released at once when the
+   * last reference on any of its nodes, arrays, or objects is released.
+   *
+   * Trees allocated inside an arena are always immutable, so setting this
+   * property also sets #JsonParser:immutable. They are meant for read-only
+   * use: nodes of an arena tree should not be re-initialized, or added to
+   * other trees.
+   *
+   * Since: 1.4
+   */
+  parser_props[PROP_USE_ARENA] =
+    g_param_spec_boolean ("use-arena",
+                          "Use Arena",
+                          "Whether the parser output is allocated inside an arena.",
+                          FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+
+  /**
+   * JsonParser:intern-member-names:
+   *
+   * Whether the objects built by the #JsonParser should share the names
+   * of their members, instead of keeping a copy each. This reduces the
+   * memory used by documents containing many objects with the same
+   * members, like arrays of records, at the cost of looking up each
+   * name while parsing.
+   *
+   * The names are shared among the objects of a single document, or
+   * of all the records loaded by a single call to
+   * json_parser_load_lines_from_data() and similar functions.
+   *
+   * Since: 1.4
+   */
+  parser_props[PROP_INTERN_MEMBER_NAMES] =
+    g_param_spec_boolean ("intern-member-names",
+                          "Intern Member Names",
+                          "Whether objects share the names of their members.",
+                          FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+
+  /**
+   * JsonParser:thread-local:
+   *
+   * Whether the #JsonNode tree built by the #JsonParser is only going to
+   * be used by the thread that parsed it. Acquiring and releasing
+   * references on the nodes of a thread-local tree does not use atomic
+   * operations, which makes building and releasing large trees cheaper.
+   *
+   * Each document belongs to the thread that started parsing it; see
+   * json_node_is_thread_local().
+   *
+   * Since: 1.4
+   */
+  parser_props[PROP_THREAD_LOCAL] =
+    g_param_spec_boolean ("thread-local",
+                          "Thread Local",
+                          "Whether the parser output is only used by one thread.",
+                          FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, parser_props);
 
   /**
@@ -387,12 +565,96 @@ json_parser_init (JsonParser *parser)
 
   priv->is_filename = FALSE;
   priv->filename = FALSE;
+
+  priv->push_stack = g_array_new (FALSE, FALSE, sizeof (JsonParserFrame));
+}
+
+/* when building a document inside an arena, the nodes are allocated from
+ * the arena, and we do not need to release them if we fail halfway
+ * through, as the arena is going to be released all at once
+ */
+static JsonNode *
+json_parser_alloc_node (JsonParser   *parser,
+                        JsonNodeType  node_type)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonNode *node;
+
+  if (priv->arena == NULL)
+    node = json_node_init (json_node_alloc (), node_type);
+  else
+    node = json_node_init (json_node_alloc_in_arena (priv->arena), node_type);
+
+  if (priv->thread_local)
+    {
+      node->thread_local = TRUE;
+      node->owner = priv->owner;
+    }
+
+  return node;
+}
+
+static JsonKey *
+json_parser_dup_key (JsonParser  *parser,
+                     const gchar *name,
+                     gsize        len)
+{
+  JsonParserPrivate *priv = parser->priv;
+  const gchar *nul;
+
+  /* member names are nul-terminated, so an escaped NUL character ends
+   * the name, on every parse path
+   */
+  nul = memchr (name, '\0', len);
+  if (nul != NULL)
+    len = nul - name;
+
+  if (priv->intern_member_names)
+    {
+      if (priv->keys == NULL)
+        priv->keys = json_key_table_new (priv->arena);
+
+      return json_key_table_lookup (priv->keys, name, len);
+    }
+
+  if (priv->arena != NULL)
+    return json_key_new_in_arena (priv->arena, name, len);
+
+  return json_key_new_len (name, len);
+}
+
+static inline void
+json_parser_release_node (JsonParser *parser,
+                          JsonNode   *node)
+{
+  if (node != NULL && parser->priv->arena == NULL)
+    json_node_unref (node);
+}
+
+static inline void
+json_parser_release_array (JsonParser *parser,
+                           JsonArray  *array)
+{
+  if (parser->priv->arena == NULL)
+    json_array_unref (array);
+}
+
+static inline void
+json_parser_release_object (JsonParser *parser,
+                            JsonObject *object)
+{
+  if (parser->priv->arena == NULL)
+    json_object_unref (object);
 }
 
+/* if @array is not %NULL, numbers are added to it as packed values
+ * whenever possible, instead of being returned in @node
+ */
 static guint
 json_parse_value (JsonParser   *parser,
                   JsonScanner  *scanner,
                   guint         token,
+                  JsonArray    *array,
                   JsonNode    **node)
 {
   JsonParserPrivate *priv = parser->priv;
@@ -419,36 +681,53 @@ json_parse_value (JsonParser   *parser,
       JSON_NOTE (PARSER, "abs(node): %" G_GINT64_FORMAT " (sign: %s)",
                  scanner->value.v_int64,
                  is_negative ? "negative" : "positive");
-      *node = json_node_init_int (json_node_alloc (),
-                                  is_negative ? scanner->value.v_int64 * -1
-                                              : scanner->value.v_int64);
+      {
+        gint64 value = is_negative ? scanner->value.v_int64 * -1
+                                   : scanner->value.v_int64;
+
+        if (array != NULL && json_array_add_packed_int (array, value))
+          break;
+
+        *node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+        json_node_set_int (*node, value);
+      }
       break;
 
     case G_TOKEN_FLOAT:
       JSON_NOTE (PARSER, "abs(node): %.6f (sign: %s)",
                  scanner->value.v_float,
                  is_negative ? "negative" : "positive");
-      *node = json_node_init_double (json_node_alloc (),
-                                     is_negative ? scanner->value.v_float * -1.0
-                                                 : scanner->value.v_float);
+      {
+        gdouble value = is_negative ? scanner->value.v_float * -1.0
+                                    : scanner->value.v_float;
+
+        if (array != NULL && json_array_add_packed_double (array, value))
+          break;
+
+        *node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+        json_node_set_double (*node, value);
+      }
       break;
 
     case G_TOKEN_STRING:
-      JSON_NOTE (PARSER, "node: '%s'",
+      JSON_NOTE (PARSER, "node: '%.*s'",
+                 (int) scanner->string_len,
                  scanner->value.v_string);
-      *node = json_node_init_string (json_node_alloc (), scanner->value.v_string);
+      *node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+      json_node_set_string_len (*node, scanner->value.v_string, scanner->string_len);
       break;
 
     case JSON_TOKEN_TRUE:
     case JSON_TOKEN_FALSE:
       JSON_NOTE (PARSER, "node: '%s'",
                  JSON_TOKEN_TRUE ? "<true>" : "<false>");
-      *node = json_node_init_boolean (json_node_alloc (), token == JSON_TOKEN_TRUE ? TRUE : FALSE);
+      *node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+      json_node_set_boolean (*node, token == JSON_TOKEN_TRUE ? TRUE : FALSE);
       break;
 
     case JSON_TOKEN_NULL:
       JSON_NOTE (PARSER, "node: <null>");
-      *node = json_node_init_null (json_node_alloc ());
+      *node = json_parser_alloc_node (parser, JSON_NODE_NULL);
       break;
 
     case G_TOKEN_IDENTIFIER:
@@ -503,9 +782,14 @@ json_parse_array (JsonParser   *parser,
   gint idx;
 
   old_current = priv->current_node;
-  priv->current_node = json_node_init_array (json_node_alloc (), NULL);
+  priv->current_node = json_parser_alloc_node (parser, JSON_NODE_ARRAY);
+
+  if (priv->arena != NULL)
+    array = json_array_new_in_arena (priv->arena);
+  else
+    array = json_array_new ();
 
-  array = json_array_new ();
+  json_array_set_element_parent (array, priv->current_node);
 
   token = json_scanner_get_next_token (scanner);
   g_assert (token == G_TOKEN_LEFT_BRACE);
@@ -517,6 +801,7 @@ json_parse_array (JsonParser   *parser,
     {
       guint next_token = json_scanner_peek_next_token (scanner);
       JsonNode *element = NULL;
+      gboolean packed;
 
       /* parse the element */
       switch (next_token)
@@ -536,15 +821,18 @@ json_parse_array (JsonParser   *parser,
 
         default:
           token = json_scanner_get_next_token (scanner);
-          token = json_parse_value (parser, scanner, token, &element);
+          token = json_parse_value (parser, scanner, token, array, &element);
           break;
         }
 
-      if (token != G_TOKEN_NONE || element == NULL)
+      /* numbers are added to the array without a node, if possible */
+      packed = element == NULL && json_array_get_length (array) > (guint) idx;
+
+      if (token != G_TOKEN_NONE || (element == NULL && !packed))
         {
           /* the json_parse_* functions will have set the error code */
-          json_array_unref (array);
-          json_node_unref (priv->current_node);
+          json_parser_release_array (parser, array);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return token;
@@ -557,9 +845,9 @@ json_parse_array (JsonParser   *parser,
         {
           priv->error_code = JSON_PARSER_ERROR_MISSING_COMMA;
 
-          json_array_unref (array);
-          json_node_free (priv->current_node);
-          json_node_free (element);
+          json_parser_release_array (parser, array);
+          json_parser_release_node (parser, priv->current_node);
+          json_parser_release_node (parser, element);
           priv->current_node = old_current;
 
           return G_TOKEN_COMMA;
@@ -575,9 +863,9 @@ json_parse_array (JsonParser   *parser,
             {
               priv->error_code = JSON_PARSER_ERROR_TRAILING_COMMA;
 
-              json_array_unref (array);
-              json_node_unref (priv->current_node);
-              json_node_unref (element);
+              json_parser_release_array (parser, array);
+              json_parser_release_node (parser, priv->current_node);
+              json_parser_release_node (parser, element);
               priv->current_node = old_current;
 
               return G_TOKEN_RIGHT_BRACE;
@@ -585,10 +873,13 @@ json_parse_array (JsonParser   *parser,
         }
 
       JSON_NOTE (PARSER, "Array element %d completed", idx);
-      json_node_set_parent (element, priv->current_node);
-      if (priv->is_immutable)
-        json_node_seal (element);
-      json_array_add_element (array, element);
+      if (!packed)
+        {
+          json_node_set_parent (element, priv->current_node);
+          if (priv->is_immutable)
+            json_node_seal (element);
+          json_array_add_element (array, element);
+        }
 
       g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
                      array,
@@ -630,9 +921,12 @@ json_parse_object (JsonParser   *parser,
   guint token;
 
   old_current = priv->current_node;
-  priv->current_node = json_node_init_object (json_node_alloc (), NULL);
+  priv->current_node = json_parser_alloc_node (parser, JSON_NODE_OBJECT);
 
-  object = json_object_new ();
+  if (priv->arena != NULL)
+    object = json_object_new_in_arena (priv->arena);
+  else
+    object = json_object_new ();
 
   token = json_scanner_get_next_token (scanner);
   g_assert (token == G_TOKEN_LEFT_CURLY);
@@ -643,7 +937,7 @@ json_parse_object (JsonParser   *parser,
     {
       guint next_token = json_scanner_peek_next_token (scanner);
       JsonNode *member = NULL;
-      gchar *name;
+      JsonKey *key;
 
       /* we need to abort here because empty objects do not
        * have member names
@@ -658,8 +952,8 @@ json_parse_object (JsonParser   *parser,
 
           priv->error_code = JSON_PARSER_ERROR_INVALID_BAREWORD;
 
-          json_object_unref (object);
-          json_node_unref (priv->current_node);
+          json_parser_release_object (parser, object);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return G_TOKEN_STRING;
@@ -667,21 +961,21 @@ json_parse_object (JsonParser   *parser,
 
       /* member name */
       token = json_scanner_get_next_token (scanner);
-      name = g_strdup (scanner->value.v_string);
-      if (name == NULL)
+      key = json_parser_dup_key (parser, scanner->value.v_string, scanner->string_len);
+      if (key == NULL)
         {
           JSON_NOTE (PARSER, "Empty object member name");
 
           priv->error_code = JSON_PARSER_ERROR_EMPTY_MEMBER_NAME;
 
-          json_object_unref (object);
-          json_node_unref (priv->current_node);
+          json_parser_release_object (parser, object);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return G_TOKEN_STRING;
         }
 
-      JSON_NOTE (PARSER, "Object member '%s'", name);
+      JSON_NOTE (PARSER, "Object member '%s'", key->name);
 
       /* a colon separates names from values */
       next_token = json_scanner_peek_next_token (scanner);
@@ -691,9 +985,9 @@ json_parse_object (JsonParser   *parser,
 
           priv->error_code = JSON_PARSER_ERROR_MISSING_COLON;
 
-          g_free (name);
-          json_object_unref (object);
-          json_node_unref (priv->current_node);
+          json_key_unref (key);
+          json_parser_release_object (parser, object);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return ':';
@@ -708,28 +1002,28 @@ json_parse_object (JsonParser   *parser,
       switch (next_token)
         {
         case G_TOKEN_LEFT_BRACE:
-          JSON_NOTE (PARSER, "Nested array at member %s", name);
+          JSON_NOTE (PARSER, "Nested array at member %s", key->name);
           token = json_parse_array (parser, scanner, &member);
           break;
 
         case G_TOKEN_LEFT_CURLY:
-          JSON_NOTE (PARSER, "Nested object at member %s", name);
+          JSON_NOTE (PARSER, "Nested object at member %s", key->name);
           token = json_parse_object (parser, scanner, &member);
           break;
 
         default:
           /* once a member name is defined we need a value */
           token = json_scanner_get_next_token (scanner);
-          token = json_parse_value (parser, scanner, token, &member);
+          token = json_parse_value (parser, scanner, token, NULL, &member);
           break;
         }
 
       if (token != G_TOKEN_NONE || member == NULL)
         {
           /* the json_parse_* functions will have set the error code */
-          g_free (name);
-          json_object_unref (object);
-          json_node_unref (priv->current_node);
+          json_key_unref (key);
+          json_parser_release_object (parser, object);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return token;
@@ -746,9 +1040,10 @@ json_parse_object (JsonParser   *parser,
             {
               priv->error_code = JSON_PARSER_ERROR_TRAILING_COMMA;
 
-              json_object_unref (object);
-              json_node_unref (member);
-              json_node_unref (priv->current_node);
+              json_key_unref (key);
+              json_parser_release_object (parser, object);
+              json_parser_release_node (parser, member);
+              json_parser_release_node (parser, priv->current_node);
               priv->current_node = old_current;
 
               return G_TOKEN_RIGHT_BRACE;
@@ -758,25 +1053,23 @@ json_parse_object (JsonParser   *parser,
         {
           priv->error_code = JSON_PARSER_ERROR_MISSING_COMMA;
 
-          json_object_unref (object);
-          json_node_unref (member);
-          json_node_unref (priv->current_node);
+          json_key_unref (key);
+          json_parser_release_object (parser, object);
+          json_parser_release_node (parser, member);
+          json_parser_release_node (parser, priv->current_node);
           priv->current_node = old_current;
 
           return G_TOKEN_COMMA;
         }
 
-      JSON_NOTE (PARSER, "Object member '%s' completed", name);
+      JSON_NOTE (PARSER, "Object member '%s' completed", key->name);
       json_node_set_parent (member, priv->current_node);
       if (priv->is_immutable)
         json_node_seal (member);
-      json_object_set_member (object, name, member);
 
       g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
                      object,
-                     name);
-
-      g_free (name);
+                     json_object_take_member (object, key, member));
 
       token = next_token;
     }
@@ -880,7 +1173,7 @@ json_parse_statement (JsonParser  *parser,
     case G_TOKEN_IDENTIFIER:
       JSON_NOTE (PARSER, "Statement is a value");
       token = json_scanner_get_next_token (scanner);
-      return json_parse_value (parser, scanner, token, &priv->root);
+      return json_parse_value (parser, scanner, token, NULL, &priv->root);
 
     default:
       JSON_NOTE (PARSER, "Unknown statement");
@@ -918,23 +1211,11 @@ static JsonScanner *
 json_scanner_create (JsonParser *parser)
 {
   JsonScanner *scanner;
-  gint i;
 
   scanner = json_scanner_new ();
   scanner->msg_handler = json_scanner_msg_handler;
   scanner->user_data = parser;
 
-  /* XXX: this is eminently stupid, but we use the symbols later on, so
-   * we cannot move them into JsonScanner without moving a bunch of code
-   * as well
-   */
-  for (i = 0; i < n_symbols; i++)
-    {
-      json_scanner_scope_add_symbol (scanner, 0,
-                                     symbol_names + symbols[i].name_offset,
-                                     GINT_TO_POINTER (symbols[i].token));
-    }
-
   return scanner;
 }
 
@@ -969,6 +1250,72 @@ json_parser_new_immutable (void)
   return g_object_new (JSON_TYPE_PARSER, "immutable", TRUE, NULL);
 }
 
+/* reports the token that the parser expected, instead of the one
+ * that was found, as a #GError
+ */
+static void
+json_parser_set_error (JsonParser   *parser,
+                       JsonScanner  *scanner,
+                       guint         expected_token,
+                       GError      **error)
+{
+  JsonParserPrivate *priv = parser->priv;
+
+  if (scanner->invalid_data)
+    {
+      GError *internal_error;
+
+      internal_error = g_error_new_literal (JSON_PARSER_ERROR,
+                                            JSON_PARSER_ERROR_INVALID_DATA,
+                                            _("JSON data must be UTF-8 encoded"));
+      g_signal_emit (parser, parser_signals[ERROR], 0, internal_error);
+      g_propagate_error (error, internal_error);
+    }
+  else
+    {
+      const gchar *symbol_name;
+      gint cur_token;
+      gchar *msg;
+
+      cur_token = scanner->token;
+      msg = NULL;
+      symbol_name = NULL;
+
+      if (expected_token > JSON_TOKEN_INVALID &&
+          expected_token < JSON_TOKEN_LAST)
+        {
+          symbol_name = json_token_type_to_string (expected_token);
+          msg = g_strconcat ("e.g. '", symbol_name, "'", NULL);
+        }
+
+      if (cur_token > JSON_TOKEN_INVALID &&
+          cur_token < JSON_TOKEN_LAST)
+        {
+          symbol_name = json_token_type_to_string (cur_token);
+          if (symbol_name == NULL)
+            symbol_name = "???";
+        }
+
+      /* this will emit the ::error signal via the custom
+       * message handler we install
+       */
+      json_scanner_unexp_token (scanner, expected_token,
+                                NULL, "value",
+                                symbol_name, msg);
+
+      /* and this will propagate the error we create in the
+       * same message handler
+       */
+      if (priv->last_error)
+        {
+          g_propagate_error (error, priv->last_error);
+          priv->last_error = NULL;
+        }
+
+      g_free (msg);
+    }
+}
+
 static gboolean
 json_parser_load (JsonParser   *parser,
                   const gchar  *data,
@@ -979,24 +1326,19 @@ json_parser_load (JsonParser   *parser,
   JsonScanner *scanner;
   gboolean done;
   gboolean retval = TRUE;
-  gint i;
 
   json_parser_clear (parser);
 
-  if (!g_utf8_validate (data, length, NULL))
-    {
-      g_set_error_literal (error, JSON_PARSER_ERROR,
-                           JSON_PARSER_ERROR_INVALID_DATA,
-                           _("JSON data must be UTF-8 encoded"));
-      g_signal_emit (parser, parser_signals[ERROR], 0, *error);
-      return FALSE;
-    }
-
+  /* the scanner validates the UTF-8 encoding of the data while
+   * tokenizing it, so we don't need a separate pass over it
+   */
   scanner = json_scanner_create (parser);
   json_scanner_input_text (scanner, data, length);
 
   priv->scanner = scanner;
 
+  json_parser_begin_arena (parser);
+
   g_signal_emit (parser, parser_signals[PARSE_START], 0);
 
   done = FALSE;
@@ -1007,62 +1349,21 @@ json_parser_load (JsonParser   *parser,
       else
         {
           guint expected_token;
-          gint cur_token;
+
+          /* if the data contains more than one value, the last one
+           * becomes the root; the nodes inside the arena are released
+           * with the arena
+           */
+          if (priv->root != NULL && priv->arena == NULL)
+            json_node_unref (priv->root);
+          priv->root = NULL;
 
           /* we try to show the expected token, if possible */
           expected_token = json_parse_statement (parser, scanner);
           if (expected_token != G_TOKEN_NONE)
             {
-              const gchar *symbol_name;
-              gchar *msg;
-
-              cur_token = scanner->token;
-              msg = NULL;
-              symbol_name = NULL;
-
-              if (scanner->scope_id == 0)
-                {
-                  if (expected_token > JSON_TOKEN_INVALID &&
-                      expected_token < JSON_TOKEN_LAST)
-                    {
-                      for (i = 0; i < n_symbols; i++)
-                        if (symbols[i].token == expected_token)
-                          symbol_name = symbol_names + symbols[i].name_offset;
-
-                      if (!msg)
-                        msg = g_strconcat ("e.g. '", symbol_name, "'", NULL);
-                    }
-
-                  if (cur_token > JSON_TOKEN_INVALID &&
-                      cur_token < JSON_TOKEN_LAST)
-                    {
-                      symbol_name = "???";
-
-                      for (i = 0; i < n_symbols; i++)
-                        if (symbols[i].token == cur_token)
-                          symbol_name = symbol_names + symbols[i].name_offset;
-                    }
-                }
-
-              /* this will emit the ::error signal via the custom
-               * message handler we install
-               */
-              json_scanner_unexp_token (scanner, expected_token,
-                                        NULL, "value",
-                                        symbol_name, msg);
-
-              /* and this will propagate the error we create in the
-               * same message handler
-               */
-              if (priv->last_error)
-                {
-                  g_propagate_error (error, priv->last_error);
-                  priv->last_error = NULL;
-                }
-
+              json_parser_set_error (parser, scanner, expected_token, error);
               retval = FALSE;
-
-              g_free (msg);
               done = TRUE;
             }
         }
@@ -1075,9 +1376,62 @@ json_parser_load (JsonParser   *parser,
   priv->scanner = NULL;
   priv->current_node = NULL;
 
+  /* the reference we hold on the arena becomes the reference held by
+   * the root node, if we have one
+   */
+  if (priv->arena != NULL)
+    {
+      if (priv->root == NULL)
+        json_arena_unref (priv->arena);
+
+      priv->arena = NULL;
+    }
+
   return retval;
 }
 
+/* regular files are mapped in memory instead of being copied, and since
+ * the parser reads them only once, from start to end, we let the kernel
+ * read ahead aggressively and drop the pages we already parsed; pipes,
+ * character devices, and files that do not report their size, like the
+ * ones in procfs, cannot be mapped, so they are read into a buffer
+ */
+static GBytes *
+json_parser_read_file (const gchar  *filename,
+                       GError      **error)
+{
+  GStatBuf st;
+  gchar *contents;
+  gsize length;
+
+  if (g_stat (filename, &st) == 0 && S_ISREG (st.st_mode) && st.st_size > 0)
+    {
+      GMappedFile *mapped_file;
+
+      mapped_file = g_mapped_file_new (filename, FALSE, NULL);
+      if (mapped_file != NULL)
+        {
+          GBytes *bytes;
+
+#if defined(HAVE_MADVISE) && defined(MADV_SEQUENTIAL)
+          madvise (g_mapped_file_get_contents (mapped_file),
+                   g_mapped_file_get_length (mapped_file),
+                   MADV_SEQUENTIAL);
+#endif
+
+          bytes = g_mapped_file_get_bytes (mapped_file);
+          g_mapped_file_unref (mapped_file);
+
+          return bytes;
+        }
+    }
+
+  if (!g_file_get_contents (filename, &contents, &length, error))
+    return NULL;
+
+  return g_bytes_new_take (contents, length);
+}
+
 /**
  * json_parser_load_from_file:
  * @parser: a #JsonParser
@@ -1087,6 +1441,10 @@ json_parser_load (JsonParser   *parser,
  * Loads a JSON stream from the content of @filename and parses it. See
  * json_parser_load_from_data().
  *
+ * Regular files are mapped in memory and parsed in place, instead of
+ * being copied; they should not be modified while they are being parsed.
+ * Other kinds of files, like pipes, are read into a buffer.
+ *
  * Return value: %TRUE if the file was successfully loaded and parsed.
  *   In case of error, @error is set accordingly and %FALSE is returned
  */
@@ -1097,8 +1455,7 @@ json_parser_load_from_file (JsonParser   *parser,
 {
   JsonParserPrivate *priv;
   GError *internal_error;
-  gchar *data;
-  gsize length;
+  GBytes *bytes;
   gboolean retval = TRUE;
 
   g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
@@ -1107,7 +1464,8 @@ json_parser_load_from_file (JsonParser   *parser,
   priv = parser->priv;
 
   internal_error = NULL;
-  if (!g_file_get_contents (filename, &data, &length, &internal_error))
+  bytes = json_parser_read_file (filename, &internal_error);
+  if (bytes == NULL)
     {
       g_propagate_error (error, internal_error);
       return FALSE;
@@ -1118,13 +1476,16 @@ json_parser_load_from_file (JsonParser   *parser,
   priv->is_filename = TRUE;
   priv->filename = g_strdup (filename);
 
-  if (!json_parser_load (parser, data, length, &internal_error))
+  if (!json_parser_load (parser,
+                         g_bytes_get_data (bytes, NULL),
+                         g_bytes_get_size (bytes),
+                         &internal_error))
     {
       g_propagate_error (error, internal_error);
       retval = FALSE;
     }
 
-  g_free (data);
+  g_bytes_unref (bytes);
 
   return retval;
 }
@@ -1175,68 +1536,462 @@ json_parser_load_from_data (JsonParser   *parser,
   return retval;
 }
 
-/**
- * json_parser_get_root:
- * @parser: a #JsonParser
- *
- * Retrieves the top level node from the parsed JSON stream.
- *
- * Return value: (transfer none): the root #JsonNode . The returned
- *   node is owned by the #JsonParser and should never be modified
- *   or freed.
- */
-JsonNode *
-json_parser_get_root (JsonParser *parser)
+/* releases the partial document after an error */
+static void
+json_parser_push_abort (JsonParser *parser)
 {
-  g_return_val_if_fail (JSON_IS_PARSER (parser), NULL);
+  JsonParserPrivate *priv = parser->priv;
 
-  /* Sanity check. */
-  g_return_val_if_fail (!parser->priv->is_immutable ||
-                        json_node_is_immutable (parser->priv->root), NULL);
+  /* the root of an arena document is released with the arena */
+  if (priv->root != NULL && priv->arena == NULL)
+    json_node_unref (priv->root);
 
-  return parser->priv->root;
+  priv->root = NULL;
+
+  json_parser_push_reset (parser);
 }
 
-/**
- * json_parser_steal_root:
- * @parser: a #JsonParser
- *
- * Steals the top level node from the parsed JSON stream.
- *
- * Returns: (transfer full): the top level #JsonNode
- *
- * Since: 1.4
+/* adds a complete node to the innermost open container, or sets it
+ * as the root of the document
  */
-JsonNode *
-json_parser_steal_root (JsonParser *parser)
+static void
+json_parser_push_node (JsonParser *parser,
+                       JsonNode   *node)
 {
-  JsonParserPrivate *priv = json_parser_get_instance_private (parser);
+  JsonParserPrivate *priv = parser->priv;
+  JsonParserFrame *frame;
 
-  g_return_val_if_fail (JSON_IS_PARSER (parser), NULL);
+  if (priv->is_immutable)
+    json_node_seal (node);
 
-  return g_steal_pointer (&priv->root);
-}
+  if (priv->push_stack->len == 0)
+    {
+      priv->root = node;
+      return;
+    }
 
-/**
- * json_parser_get_current_line:
- * @parser: a #JsonParser
- *
- * Retrieves the line currently parsed, starting from 1.
- *
- * This function has defined behaviour only while parsing; calling this
- * function from outside the signal handlers emitted by #JsonParser will
- * yield 0.
- *
- * Return value: the currently parsed line, or 0.
- */
-guint
-json_parser_get_current_line (JsonParser *parser)
-{
+  frame = &g_array_index (priv->push_stack, JsonParserFrame, priv->push_stack->len - 1);
+
+  json_node_set_parent (node, frame->node);
+
+  if (JSON_NODE_TYPE (frame->node) == JSON_NODE_OBJECT)
+    {
+      JsonObject *object = json_node_get_object (frame->node);
+      const gchar *name;
+
+      JSON_NOTE (PARSER, "Object member '%s' completed", frame->member_key->name);
+
+      name = json_object_take_member (object, frame->member_key, node);
+      frame->member_key = NULL;
+
+      g_signal_emit (parser, parser_signals[OBJECT_MEMBER], 0,
+                     object,
+                     name);
+    }
+  else
+    {
+      JsonArray *array = json_node_get_array (frame->node);
+
+      JSON_NOTE (PARSER, "Array element %d completed", frame->index);
+
+      json_array_add_element (array, node);
+
+      g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
+                     array,
+                     frame->index);
+
+      frame->index += 1;
+    }
+}
+
+/* adds a number to the innermost open container without creating a
+ * node for it, if the container is an array that can be packed
+ */
+static gboolean
+json_parser_push_packed (JsonParser       *parser,
+                         JsonStreamReader *reader)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonParserFrame *frame;
+  JsonArray *array;
+  gboolean res;
+
+  if (priv->push_stack->len == 0)
+    return FALSE;
+
+  frame = &g_array_index (priv->push_stack, JsonParserFrame, priv->push_stack->len - 1);
+  if (JSON_NODE_TYPE (frame->node) != JSON_NODE_ARRAY)
+    return FALSE;
+
+  array = json_node_get_array (frame->node);
+
+  switch (json_stream_reader_get_value_type (reader))
+    {
+    case G_TYPE_INT64:
+      res = json_array_add_packed_int (array, json_stream_reader_get_int_value (reader));
+      break;
+
+    case G_TYPE_DOUBLE:
+      res = json_array_add_packed_double (array, json_stream_reader_get_double_value (reader));
+      break;
+
+    default:
+      res = FALSE;
+      break;
+    }
+
+  if (!res)
+    return FALSE;
+
+  JSON_NOTE (PARSER, "Array element %d completed", frame->index);
+
+  g_signal_emit (parser, parser_signals[ARRAY_ELEMENT], 0,
+                 array,
+                 frame->index);
+
+  frame->index += 1;
+
+  return TRUE;
+}
+
+static JsonNode *
+json_parser_push_value (JsonParser       *parser,
+                        JsonStreamReader *reader)
+{
+  JsonNode *node;
+
+  switch (json_stream_reader_get_value_type (reader))
+    {
+    case G_TYPE_INT64:
+      node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+      json_node_set_int (node, json_stream_reader_get_int_value (reader));
+      break;
+
+    case G_TYPE_DOUBLE:
+      node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+      json_node_set_double (node, json_stream_reader_get_double_value (reader));
+      break;
+
+    case G_TYPE_BOOLEAN:
+      node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+      json_node_set_boolean (node, json_stream_reader_get_boolean_value (reader));
+      break;
+
+    case G_TYPE_STRING:
+      {
+        const gchar *str = json_stream_reader_get_string_value (reader);
+
+        node = json_parser_alloc_node (parser, JSON_NODE_VALUE);
+        json_node_set_string_len (node, str, strlen (str));
+      }
+      break;
+
+    default:
+      node = json_parser_alloc_node (parser, JSON_NODE_NULL);
+      break;
+    }
+
+  return node;
+}
+
+/* turns the events read so far into nodes */
+static gboolean
+json_parser_push_events (JsonParser  *parser,
+                         GError     **error)
+{
+  JsonParserPrivate *priv = parser->priv;
+  JsonStreamReader *reader = priv->push_reader;
+
+  while (TRUE)
+    {
+      GError *internal_error = NULL;
+      JsonParserFrame *frame;
+      JsonParserFrame new_frame;
+      JsonStreamEvent event;
+
+      event = json_stream_reader_next_pushed (reader, &internal_error);
+      switch (event)
+        {
+        case JSON_STREAM_EVENT_NONE:
+          if (internal_error == NULL)
+            return TRUE;
+
+          g_signal_emit (parser, parser_signals[ERROR], 0, internal_error);
+          g_propagate_error (error, internal_error);
+          return FALSE;
+
+        case JSON_STREAM_EVENT_START_OBJECT:
+          new_frame.node = json_parser_alloc_node (parser, JSON_NODE_OBJECT);
+          new_frame.member_key = NULL;
+          new_frame.index = 0;
+
+          if (priv->arena != NULL)
+            json_node_take_object (new_frame.node, json_object_new_in_arena (priv->arena));
+          else
+            json_node_take_object (new_frame.node, json_object_new ());
+
+          g_array_append_val (priv->push_stack, new_frame);
+          g_signal_emit (parser, parser_signals[OBJECT_START], 0);
+          break;
+
+        case JSON_STREAM_EVENT_START_ARRAY:
+          new_frame.node = json_parser_alloc_node (parser, JSON_NODE_ARRAY);
+          new_frame.member_key = NULL;
+          new_frame.index = 0;
+
+          if (priv->arena != NULL)
+            json_node_take_array (new_frame.node, json_array_new_in_arena (priv->arena));
+          else
+            json_node_take_array (new_frame.node, json_array_new ());
+
+          json_array_set_element_parent (json_node_get_array (new_frame.node), new_frame.node);
+
+          g_array_append_val (priv->push_stack, new_frame);
+          g_signal_emit (parser, parser_signals[ARRAY_START], 0);
+          break;
+
+        case JSON_STREAM_EVENT_MEMBER_NAME:
+          {
+            const gchar *name = json_stream_reader_get_member_name (reader);
+
+            frame = &g_array_index (priv->push_stack, JsonParserFrame, priv->push_stack->len - 1);
+            frame->member_key = json_parser_dup_key (parser, name, strlen (name));
+          }
+          break;
+
+        case JSON_STREAM_EVENT_VALUE:
+          if (!json_parser_push_packed (parser, reader))
+            json_parser_push_node (parser, json_parser_push_value (parser, reader));
+          break;
+
+        case JSON_STREAM_EVENT_END_OBJECT:
+        case JSON_STREAM_EVENT_END_ARRAY:
+          new_frame = g_array_index (priv->push_stack, JsonParserFrame, priv->push_stack->len - 1);
+          g_array_set_size (priv->push_stack, priv->push_stack->len - 1);
+
+          if (event == JSON_STREAM_EVENT_END_OBJECT)
+            {
+              JsonObject *object = json_node_get_object (new_frame.node);
+
+              if (priv->is_immutable)
+                json_object_seal (object);
+
+              g_signal_emit (parser, parser_signals[OBJECT_END], 0, object);
+            }
+          else
+            {
+              JsonArray *array = json_node_get_array (new_frame.node);
+
+              if (priv->is_immutable)
+                json_array_seal (array);
+
+              g_signal_emit (parser, parser_signals[ARRAY_END], 0, array);
+            }
+
+          json_parser_push_node (parser, new_frame.node);
+          break;
+
+        case JSON_STREAM_EVENT_END:
+          return TRUE;
+        }
+    }
+}
+
+/**
+ * json_parser_feed:
+ * @parser: a #JsonParser
+ * @data: (array length=length): a chunk of the JSON data to parse
+ * @length: the length of @data, or -1 if it is nul-terminated
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses a chunk of a JSON document. The document can be split in any
+ * number of chunks, at any position, even inside a token; the parser
+ * keeps the data that it could not parse yet, and the state of the
+ * containers that are still open, between calls.
+ *
+ * The #JsonParser::object-member and #JsonParser::array-element signals
+ * are emitted as soon as each member or element is complete, without
+ * waiting for the rest of the document. Once all the data has been fed,
+ * call json_parser_finish() to complete the document.
+ *
+ * The first call to this function after json_parser_finish(), or after
+ * loading a document using the other functions of #JsonParser, starts
+ * a new document and releases the current root.
+ *
+ * Unlike the other loading functions, the chunked parser parses exactly
+ * one top level value: any data after it, like the second value in
+ * "1 2", is an error, reported with %JSON_PARSER_ERROR_PARSE by this
+ * function or by json_parser_finish(). It does not support the
+ * "var name = ..." assignment extension either.
+ *
+ * Return value: %TRUE if the chunk was parsed successfully. In case of
+ *   error, @error is set accordingly, the partial document is released,
+ *   and %FALSE is returned
+ *
+ * Since: 1.4
+ */
+gboolean
+json_parser_feed (JsonParser   *parser,
+                  const gchar  *data,
+                  gssize        length,
+                  GError      **error)
+{
+  JsonParserPrivate *priv;
+  gboolean retval;
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+  g_return_val_if_fail (data != NULL || length == 0, FALSE);
+
+  priv = parser->priv;
+
+  if (length < 0)
+    length = strlen (data);
+
+  if (priv->push_reader == NULL)
+    {
+      json_parser_clear (parser);
+
+      priv->is_filename = FALSE;
+      g_free (priv->filename);
+      priv->filename = NULL;
+
+      priv->push_reader = json_stream_reader_new_push ();
+
+      json_parser_begin_arena (parser);
+
+      g_signal_emit (parser, parser_signals[PARSE_START], 0);
+    }
+
+  json_stream_reader_push_data (priv->push_reader, data, length);
+
+  retval = json_parser_push_events (parser, error);
+  if (!retval)
+    json_parser_push_abort (parser);
+
+  return retval;
+}
+
+/**
+ * json_parser_finish:
+ * @parser: a #JsonParser
+ * @error: return location for a #GError, or %NULL
+ *
+ * Completes the JSON document fed to @parser using json_parser_feed().
+ * On success, the document can be retrieved using json_parser_get_root().
+ *
+ * The document must hold exactly one top level value; in particular,
+ * data following a top level number is only known to be an error once
+ * the end of the document is reached, so the error is reported here.
+ *
+ * Return value: %TRUE if the document was complete and valid. In case
+ *   of error, @error is set accordingly and %FALSE is returned
+ *
+ * Since: 1.4
+ */
+gboolean
+json_parser_finish (JsonParser  *parser,
+                    GError     **error)
+{
+  JsonParserPrivate *priv;
+  gboolean retval;
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+
+  priv = parser->priv;
+
+  /* an empty document */
+  if (priv->push_reader == NULL && !json_parser_feed (parser, "", 0, error))
+    return FALSE;
+
+  json_stream_reader_push_eof (priv->push_reader);
+
+  retval = json_parser_push_events (parser, error);
+
+  g_signal_emit (parser, parser_signals[PARSE_END], 0);
+
+  if (!retval)
+    {
+      json_parser_push_abort (parser);
+      return FALSE;
+    }
+
+  /* the reference we hold on the arena becomes the reference held by
+   * the root node, if we have one
+   */
+  if (priv->root != NULL)
+    priv->arena = NULL;
+
+  json_parser_push_reset (parser);
+
+  return TRUE;
+}
+
+/**
+ * json_parser_get_root:
+ * @parser: a #JsonParser
+ *
+ * Retrieves the top level node from the parsed JSON stream.
+ *
+ * Return value: (transfer none): the root #JsonNode . The returned
+ *   node is owned by the #JsonParser and should never be modified
+ *   or freed.
+ */
+JsonNode *
+json_parser_get_root (JsonParser *parser)
+{
+  g_return_val_if_fail (JSON_IS_PARSER (parser), NULL);
+
+  /* Sanity check. */
+  g_return_val_if_fail (parser->priv->root == NULL ||
+                        !parser->priv->is_immutable ||
+                        json_node_is_immutable (parser->priv->root), NULL);
+
+  return parser->priv->root;
+}
+
+/**
+ * json_parser_steal_root:
+ * @parser: a #JsonParser
+ *
+ * Steals the top level node from the parsed JSON stream.
+ *
+ * Returns: (transfer full): the top level #JsonNode
+ *
+ * Since: 1.4
+ */
+JsonNode *
+json_parser_steal_root (JsonParser *parser)
+{
+  JsonParserPrivate *priv = json_parser_get_instance_private (parser);
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), NULL);
+
+  return g_steal_pointer (&priv->root);
+}
+
+/**
+ * json_parser_get_current_line:
+ * @parser: a #JsonParser
+ *
+ * Retrieves the line currently parsed, starting from 1.
+ *
+ * This function has defined behaviour only while parsing; calling this
+ * function from outside the signal handlers emitted by #JsonParser will
+ * yield 0.
+ *
+ * Return value: the currently parsed line, or 0.
+ */
+guint
+json_parser_get_current_line (JsonParser *parser)
+{
   g_return_val_if_fail (JSON_IS_PARSER (parser), 0);
 
   if (parser->priv->scanner != NULL)
     return parser->priv->scanner->line;
 
+  if (parser->priv->push_reader != NULL)
+    return json_stream_reader_get_current_line (parser->priv->push_reader);
+
   return 0;
 }
 
@@ -1261,6 +2016,9 @@ json_parser_get_current_pos (JsonParser *parser)
   if (parser->priv->scanner != NULL)
     return parser->priv->scanner->position;
 
+  if (parser->priv->push_reader != NULL)
+    return json_stream_reader_get_current_pos (parser->priv->push_reader);
+
   return 0;
 }
 
@@ -1520,3 +2278,725 @@ json_parser_load_from_stream_async (JsonParser          *parser,
   g_task_run_in_thread (task, read_from_stream);
   g_object_unref (task);
 }
+
+typedef struct {
+  JsonParser *parser;
+  JsonScanner *scanner;
+
+  JsonParserLineFunc func;
+  gpointer user_data;
+
+  /* the number of the next line */
+  guint line;
+
+  /* whether the function asked to stop */
+  gboolean stopped;
+} LinesData;
+
+static void
+json_parser_lines_begin (JsonParser         *parser,
+                         LinesData          *data,
+                         JsonParserLineFunc  func,
+                         gpointer            user_data)
+{
+  JsonParserPrivate *priv = parser->priv;
+
+  json_parser_clear (parser);
+
+  /* the same scanner is used for every record */
+  data->parser = parser;
+  data->scanner = json_scanner_create (parser);
+  data->func = func;
+  data->user_data = user_data;
+  data->line = 1;
+  data->stopped = FALSE;
+
+  priv->scanner = data->scanner;
+
+  g_signal_emit (parser, parser_signals[PARSE_START], 0);
+}
+
+static void
+json_parser_lines_end (JsonParser *parser,
+                       LinesData  *data)
+{
+  JsonParserPrivate *priv = parser->priv;
+
+  g_signal_emit (parser, parser_signals[PARSE_END], 0);
+
+  json_scanner_destroy (data->scanner);
+  priv->scanner = NULL;
+  priv->current_node = NULL;
+}
+
+/* parses a record, which must be the only value on its line */
+static guint
+json_parse_record (JsonParser  *parser,
+                   JsonScanner *scanner)
+{
+  JsonParserPrivate *priv = parser->priv;
+  guint token;
+
+  /* assignments do not make sense for a sequence of records */
+  token = json_scanner_peek_next_token (scanner);
+  if (token == JSON_TOKEN_VAR)
+    {
+      json_scanner_get_next_token (scanner);
+      priv->error_code = JSON_PARSER_ERROR_INVALID_BAREWORD;
+      return G_TOKEN_SYMBOL;
+    }
+
+  token = json_parse_statement (parser, scanner);
+  if (token != G_TOKEN_NONE)
+    return token;
+
+  if (json_scanner_peek_next_token (scanner) != G_TOKEN_EOF)
+    {
+      json_scanner_get_next_token (scanner);
+      priv->error_code = JSON_PARSER_ERROR_PARSE;
+      return G_TOKEN_EOF;
+    }
+
+  return G_TOKEN_NONE;
+}
+
+/* parses a single line, and passes the result to the function */
+static void
+json_parser_load_line (LinesData   *data,
+                       const gchar *text,
+                       gsize        length)
+{
+  JsonParser *parser = data->parser;
+  JsonParserPrivate *priv = parser->priv;
+  JsonScanner *scanner = data->scanner;
+  GError *error = NULL;
+  guint expected_token;
+  guint line = data->line;
+
+  /* like the scanner, stop counting lines instead of wrapping around */
+  if (data->line < G_MAXINT)
+    data->line += 1;
+
+  json_scanner_input_partial_text (scanner, text, length, line, 0);
+
+  /* blank lines are skipped */
+  if (json_scanner_peek_next_token (scanner) == G_TOKEN_EOF)
+    return;
+
+  json_parser_begin_arena (parser);
+
+  expected_token = json_parse_record (parser, scanner);
+  if (expected_token != G_TOKEN_NONE)
+    json_parser_set_error (parser, scanner, expected_token, &error);
+
+  /* the reference we hold on the arena becomes the reference held by
+   * the root node, if we have one
+   */
+  if (priv->arena != NULL)
+    {
+      if (priv->root == NULL)
+        json_arena_unref (priv->arena);
+
+      priv->arena = NULL;
+    }
+
+  /* a record followed by trailing data is not passed along */
+  if (error != NULL && priv->root != NULL)
+    {
+      json_node_unref (priv->root);
+      priv->root = NULL;
+    }
+
+  if (!data->func (parser, line, priv->root, error, data->user_data))
+    data->stopped = TRUE;
+
+  if (priv->root != NULL)
+    {
+      json_node_unref (priv->root);
+      priv->root = NULL;
+    }
+
+  g_clear_error (&error);
+}
+
+/* parses the complete lines inside @text, and returns the number of
+ * bytes that were consumed; if @eof is set, the data after the last
+ * newline is parsed as well
+ */
+static gsize
+json_parser_load_lines (LinesData   *data,
+                        const gchar *text,
+                        gsize        length,
+                        gboolean     eof)
+{
+  const gchar *p = text;
+  const gchar *end = text + length;
+
+  while (p < end && !data->stopped)
+    {
+      const gchar *newline = memchr (p, '\n', end - p);
+
+      if (newline == NULL)
+        {
+          if (!eof)
+            break;
+
+          json_parser_load_line (data, p, end - p);
+          p = end;
+        }
+      else
+        {
+          /* the scanner treats a carriage return as white space,
+           * so we do not need to strip it from CRLF terminators
+           */
+          json_parser_load_line (data, p, newline - p);
+          p = newline + 1;
+        }
+    }
+
+  return p - text;
+}
+
+/**
+ * JsonParserLineFunc:
+ * @parser: the #JsonParser
+ * @line: the line number of the record, starting from 1
+ * @node: (nullable): the root of the record, or %NULL in case of error
+ * @error: (nullable): the error for the record, or %NULL
+ * @user_data: data passed to the function
+ *
+ * The type of the function called for each record by
+ * json_parser_load_lines_from_data() and the related functions.
+ *
+ * The @node is owned by the parser, and it is released after the
+ * function returns; use json_node_ref() to keep it.
+ *
+ * Return value: %TRUE to continue parsing the following lines, or
+ *   %FALSE to stop
+ *
+ * Since: 1.4
+ */
+
+/**
+ * json_parser_load_lines_from_data:
+ * @parser: a #JsonParser
+ * @data: the buffer to parse
+ * @length: the length of the buffer, or -1
+ * @func: (scope call): the function to call for each record
+ * @user_data: data to pass to @func
+ *
+ * Parses a buffer of newline-delimited JSON records, also known as
+ * JSON Lines: each line of @data contains a single JSON value. Blank
+ * lines are skipped.
+ *
+ * The records are passed to @func one at a time, as soon as they are
+ * parsed, and they are not retained by @parser. A line that cannot be
+ * parsed is passed to @func with its error, and it does not stop the
+ * parsing of the lines that follow it.
+ *
+ * Since: 1.4
+ */
+void
+json_parser_load_lines_from_data (JsonParser         *parser,
+                                  const gchar        *data,
+                                  gssize              length,
+                                  JsonParserLineFunc  func,
+                                  gpointer            user_data)
+{
+  JsonParserPrivate *priv;
+  LinesData lines;
+
+  g_return_if_fail (JSON_IS_PARSER (parser));
+  g_return_if_fail (data != NULL);
+  g_return_if_fail (func != NULL);
+
+  priv = parser->priv;
+
+  if (length < 0)
+    length = strlen (data);
+
+  priv->is_filename = FALSE;
+  g_free (priv->filename);
+  priv->filename = NULL;
+
+  json_parser_lines_begin (parser, &lines, func, user_data);
+  json_parser_load_lines (&lines, data, length, TRUE);
+  json_parser_lines_end (parser, &lines);
+}
+
+/**
+ * json_parser_load_lines_from_file:
+ * @parser: a #JsonParser
+ * @filename: the path for the file to parse
+ * @func: (scope call): the function to call for each record
+ * @user_data: data to pass to @func
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses the newline-delimited JSON records inside @filename. See
+ * json_parser_load_lines_from_data().
+ *
+ * Return value: %TRUE if the file was successfully read. Errors in
+ *   the single records are passed to @func, and they do not cause
+ *   this function to fail
+ *
+ * Since: 1.4
+ */
+gboolean
+json_parser_load_lines_from_file (JsonParser          *parser,
+                                  const gchar         *filename,
+                                  JsonParserLineFunc   func,
+                                  gpointer             user_data,
+                                  GError             **error)
+{
+  JsonParserPrivate *priv;
+  LinesData lines;
+  GBytes *bytes;
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  priv = parser->priv;
+
+  bytes = json_parser_read_file (filename, error);
+  if (bytes == NULL)
+    return FALSE;
+
+  g_free (priv->filename);
+
+  priv->is_filename = TRUE;
+  priv->filename = g_strdup (filename);
+
+  json_parser_lines_begin (parser, &lines, func, user_data);
+  json_parser_load_lines (&lines,
+                          g_bytes_get_data (bytes, NULL),
+                          g_bytes_get_size (bytes),
+                          TRUE);
+  json_parser_lines_end (parser, &lines);
+
+  g_bytes_unref (bytes);
+
+  return TRUE;
+}
+
+/**
+ * json_parser_load_lines_from_stream:
+ * @parser: a #JsonParser
+ * @stream: an open #GInputStream
+ * @cancellable: (nullable): a #GCancellable, or %NULL
+ * @func: (scope call): the function to call for each record
+ * @user_data: data to pass to @func
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses the newline-delimited JSON records read from @stream. See
+ * json_parser_load_lines_from_data().
+ *
+ * Each record is parsed as soon as its line has been read, so the
+ * stream does not need to be held in memory at once.
+ *
+ * Return value: %TRUE if the stream was successfully read. Errors in
+ *   the single records are passed to @func, and they do not cause
+ *   this function to fail
+ *
+ * Since: 1.4
+ */
+gboolean
+json_parser_load_lines_from_stream (JsonParser          *parser,
+                                    GInputStream        *stream,
+                                    GCancellable        *cancellable,
+                                    JsonParserLineFunc   func,
+                                    gpointer             user_data,
+                                    GError             **error)
+{
+  JsonParserPrivate *priv;
+  LinesData lines;
+  GByteArray *content;
+  gboolean retval = TRUE;
+  gsize pos;
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), FALSE);
+  g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  priv = parser->priv;
+
+  if (g_cancellable_set_error_if_cancelled (cancellable, error))
+    return FALSE;
+
+  priv->is_filename = FALSE;
+  g_free (priv->filename);
+  priv->filename = NULL;
+
+  json_parser_lines_begin (parser, &lines, func, user_data);
+
+  /* the buffer only holds the line being read */
+  content = g_byte_array_new ();
+  pos = 0;
+
+  while (!lines.stopped)
+    {
+      gsize consumed;
+      gssize res;
+
+      g_byte_array_set_size (content, pos + GET_DATA_BLOCK_SIZE);
+      res = g_input_stream_read (stream, content->data + pos,
+                                 GET_DATA_BLOCK_SIZE,
+                                 cancellable, error);
+      if (res < 0)
+        {
+          /* error has already been set */
+          retval = FALSE;
+          break;
+        }
+
+      /* lines longer than a block are only parsed once complete */
+      if (res > 0 && memchr (content->data + pos, '\n', res) == NULL)
+        {
+          pos += res;
+          continue;
+        }
+
+      pos += res;
+
+      consumed = json_parser_load_lines (&lines, (const gchar *) content->data, pos, res == 0);
+      if (consumed > 0)
+        {
+          memmove (content->data, content->data + consumed, pos - consumed);
+          pos -= consumed;
+        }
+
+      if (res == 0)
+        break;
+    }
+
+  g_byte_array_free (content, TRUE);
+
+  json_parser_lines_end (parser, &lines);
+
+  return retval;
+}
+
+/* files are split in more chunks than threads, to balance the load
+ * between the threads when some chunks take longer to parse; the size
+ * of the chunks is capped, and so is the number of chunks that are
+ * split ahead of the record passed to the function, so that the records
+ * waiting to be passed use a bounded amount of memory regardless of the
+ * size of the file and of the speed of the function
+ */
+#define PARALLEL_CHUNKS_PER_THREAD      4
+#define PARALLEL_CHUNKS_IN_FLIGHT       2
+#define PARALLEL_MIN_CHUNK_SIZE         (64 * 1024)
+#define PARALLEL_MAX_CHUNK_SIZE         (4 * 1024 * 1024)
+
+typedef struct {
+  guint line;
+  JsonNode *node;
+  GError *error;
+} ParallelRecord;
+
+typedef struct {
+  const gchar *data;
+  gsize length;
+
+  guint first_line;
+
+  /* the parsed records, waiting to be passed to the function */
+  GArray *records;
+  gboolean done;
+} ParallelChunk;
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+
+  /* the parsers that are not being used by a worker */
+  GPtrArray *parsers;
+
+  gboolean stopped;
+} ParallelData;
+
+static void
+json_parser_parallel_chunk_free (ParallelChunk *chunk)
+{
+  guint i;
+
+  for (i = 0; i < chunk->records->len; i++)
+    {
+      ParallelRecord *record = &g_array_index (chunk->records, ParallelRecord, i);
+
+      if (record->node != NULL)
+        json_node_unref (record->node);
+      if (record->error != NULL)
+        g_error_free (record->error);
+    }
+
+  g_array_unref (chunk->records);
+  g_free (chunk);
+}
+
+static gboolean
+json_parser_parallel_collect (JsonParser   *parser,
+                              guint         line,
+                              JsonNode     *node,
+                              const GError *error,
+                              gpointer      user_data)
+{
+  ParallelChunk *chunk = user_data;
+  ParallelRecord record;
+
+  record.line = line;
+  record.node = node != NULL ? json_node_ref (node) : NULL;
+  record.error = error != NULL ? g_error_copy (error) : NULL;
+
+  g_array_append_val (chunk->records, record);
+
+  return TRUE;
+}
+
+static void
+json_parser_parallel_worker (gpointer data_,
+                             gpointer user_data)
+{
+  ParallelChunk *chunk = data_;
+  ParallelData *data = user_data;
+  JsonParser *parser = NULL;
+
+  g_mutex_lock (&data->lock);
+  if (!data->stopped)
+    parser = g_ptr_array_remove_index (data->parsers, data->parsers->len - 1);
+  g_mutex_unlock (&data->lock);
+
+  if (parser != NULL)
+    {
+      LinesData lines;
+
+      json_parser_lines_begin (parser, &lines, json_parser_parallel_collect, chunk);
+      lines.line = chunk->first_line;
+      json_parser_load_lines (&lines, chunk->data, chunk->length, TRUE);
+      json_parser_lines_end (parser, &lines);
+    }
+
+  g_mutex_lock (&data->lock);
+  if (parser != NULL)
+    g_ptr_array_add (data->parsers, parser);
+  chunk->done = TRUE;
+  g_cond_broadcast (&data->cond);
+  g_mutex_unlock (&data->lock);
+}
+
+/* splits the next chunk from the data at @p, ending with a newline, and
+ * counts its lines while looking for the end of the chunk
+ */
+static ParallelChunk *
+json_parser_parallel_split (const gchar  *p,
+                            const gchar  *end,
+                            gsize         chunk_size,
+                            guint        *line_inout)
+{
+  ParallelChunk *chunk = g_new0 (ParallelChunk, 1);
+  const gchar *chunk_end = p;
+  const gchar *newline;
+  guint line = *line_inout;
+
+  chunk->data = p;
+  chunk->first_line = line;
+  chunk->records = g_array_new (FALSE, FALSE, sizeof (ParallelRecord));
+
+  while ((newline = memchr (chunk_end, '\n', end - chunk_end)) != NULL)
+    {
+      chunk_end = newline + 1;
+
+      if (line < G_MAXINT)
+        line += 1;
+
+      if ((gsize) (chunk_end - p) >= chunk_size)
+        break;
+    }
+
+  if (newline == NULL)
+    chunk_end = end;
+
+  chunk->length = chunk_end - p;
+  *line_inout = line;
+
+  return chunk;
+}
+
+/**
+ * json_parser_load_lines_from_file_parallel:
+ * @parser: a #JsonParser
+ * @filename: the path for the file to parse
+ * @n_threads: the number of threads to use, or 0 to use one thread
+ *   for each processor
+ * @func: (scope call): the function to call for each record
+ * @user_data: data to pass to @func
+ * @error: return location for a #GError, or %NULL
+ *
+ * Parses the newline-delimited JSON records inside @filename using
+ * multiple threads. See json_parser_load_lines_from_data().
+ *
+ * The file is loaded as in json_parser_load_from_file(), and split at
+ * line boundaries in chunks that are parsed independently by a pool of
+ * worker threads, each with its own #JsonParser using the same
+ * properties as @parser. The workers only parse a few chunks ahead of
+ * the record being passed to @func, so a slow @func does not cause the
+ * records of the whole file to be kept in memory.
+ *
+ * The records are passed to @func in the same order as in the file,
+ * from the thread calling this function. The signals of @parser are
+ * not emitted for the records parsed by the worker threads, and the
+ * records are never thread-local, even if #JsonParser:thread-local
+ * is set.
+ *
+ * Return value: %TRUE if the file was successfully read. Errors in
+ *   the single records are passed to @func, and they do not cause
+ *   this function to fail
+ *
+ * Since: 1.4
+ */
+gboolean
+json_parser_load_lines_from_file_parallel (JsonParser          *parser,
+                                           const gchar         *filename,
+                                           guint                n_threads,
+                                           JsonParserLineFunc   func,
+                                           gpointer             user_data,
+                                           GError             **error)
+{
+  JsonParserPrivate *priv;
+  ParallelData data;
+  GBytes *bytes;
+  GThreadPool *pool;
+  GQueue chunks = G_QUEUE_INIT;
+  ParallelChunk *chunk;
+  const gchar *p, *end;
+  gsize length, chunk_size;
+  gboolean retval = TRUE;
+  gboolean stopped = FALSE;
+  guint max_in_flight;
+  guint line;
+  guint i, j;
+
+  g_return_val_if_fail (JSON_IS_PARSER (parser), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
+  g_return_val_if_fail (func != NULL, FALSE);
+
+  priv = parser->priv;
+
+  bytes = json_parser_read_file (filename, error);
+  if (bytes == NULL)
+    return FALSE;
+
+  json_parser_clear (parser);
+
+  g_free (priv->filename);
+
+  priv->is_filename = TRUE;
+  priv->filename = g_strdup (filename);
+
+  p = g_bytes_get_data (bytes, &length);
+  end = p + length;
+
+  if (length == 0)
+    goto out;
+
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  chunk_size = CLAMP (length / (n_threads * PARALLEL_CHUNKS_PER_THREAD),
+                      PARALLEL_MIN_CHUNK_SIZE,
+                      PARALLEL_MAX_CHUNK_SIZE);
+
+  n_threads = MIN (n_threads, length / chunk_size + 1);
+  max_in_flight = n_threads * PARALLEL_CHUNKS_IN_FLIGHT;
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+  data.parsers = g_ptr_array_new ();
+  data.stopped = FALSE;
+
+  for (i = 0; i < n_threads; i++)
+    {
+      JsonParser *worker = g_object_new (JSON_TYPE_PARSER,
+                                         "immutable", priv->is_immutable,
+                                         "use-arena", priv->use_arena,
+                                         "intern-member-names", priv->intern_member_names,
+                                         NULL);
+
+      worker->priv->is_filename = TRUE;
+      worker->priv->filename = g_strdup (filename);
+
+      g_ptr_array_add (data.parsers, worker);
+    }
+
+  pool = g_thread_pool_new (json_parser_parallel_worker, &data,
+                            n_threads, TRUE,
+                            error);
+  if (pool == NULL)
+    {
+      retval = FALSE;
+      goto out_data;
+    }
+
+  line = 1;
+  while (!stopped)
+    {
+      /* the chunks are split, and their lines counted, while the chunks
+       * that were split before are parsed by the workers
+       */
+      while (p < end && chunks.length < max_in_flight)
+        {
+          chunk = json_parser_parallel_split (p, end, chunk_size, &line);
+          p += chunk->length;
+
+          g_queue_push_tail (&chunks, chunk);
+          g_thread_pool_push (pool, chunk, NULL);
+        }
+
+      chunk = g_queue_pop_head (&chunks);
+      if (chunk == NULL)
+        break;
+
+      /* pass the records of each chunk as soon as it is complete */
+      g_mutex_lock (&data.lock);
+      while (!chunk->done)
+        g_cond_wait (&data.cond, &data.lock);
+      g_mutex_unlock (&data.lock);
+
+      for (j = 0; j < chunk->records->len && !stopped; j++)
+        {
+          ParallelRecord *record = &g_array_index (chunk->records, ParallelRecord, j);
+
+          if (!func (parser, record->line, record->node, record->error, user_data))
+            stopped = TRUE;
+        }
+
+      json_parser_parallel_chunk_free (chunk);
+    }
+
+  /* the chunks that were not parsed yet are skipped */
+  if (stopped)
+    {
+      g_mutex_lock (&data.lock);
+      data.stopped = TRUE;
+      g_mutex_unlock (&data.lock);
+    }
+
+  g_thread_pool_free (pool, FALSE, TRUE);
+
+  while ((chunk = g_queue_pop_head (&chunks)) != NULL)
+    json_parser_parallel_chunk_free (chunk);
+
+out_data:
+  for (i = 0; i < data.parsers->len; i++)
+    g_object_unref (g_ptr_array_index (data.parsers, i));
+
+  g_ptr_array_unref (data.parsers);
+  g_cond_clear (&data.cond);
+  g_mutex_clear (&data.lock);
+
+out:
+  g_bytes_unref (bytes);
+
+  return retval;
+}
@@ -140,6 +140,12 @@ struct _JsonParserClass
   void (* _json_reserved8) (void);
 };
 
+typedef gboolean (* JsonParserLineFunc) (JsonParser   *parser,
+                                         guint         line,
+                                         JsonNode     *node,
+                                         const GError *error,
+                                         gpointer      user_data);
+
 JSON_AVAILABLE_IN_1_0
 GQuark json_parser_error_quark (void);
 JSON_AVAILABLE_IN_1_0
@@ -158,6 +164,14 @@ gboolean    json_parser_load_from_data          (JsonParser           *parser,
                                                  const gchar          *data,
                                                  gssize                length,
                                                  GError              **error);
+JSON_AVAILABLE_IN_1_4
+gboolean    json_parser_feed                    (JsonParser           *parser,
+                                                 const gchar          *data,
+                                                 gssize                length,
+                                                 GError              **error);
+JSON_AVAILABLE_IN_1_4
+gboolean    json_parser_finish                  (JsonParser           *parser,
+                                                 GError              **error);
 JSON_AVAILABLE_IN_1_0
 gboolean    json_parser_load_from_stream        (JsonParser           *parser,
                                                  GInputStream         *stream,
@@ -174,6 +188,33 @@ gboolean    json_parser_load_from_stream_finish (JsonParser           *parser,
                                                  GAsyncResult         *result,
                                                  GError              **error);
 
+JSON_AVAILABLE_IN_1_4
+void        json_parser_load_lines_from_data    (JsonParser           *parser,
+                                                 const gchar          *data,
+                                                 gssize                length,
+                                                 JsonParserLineFunc    func,
+                                                 gpointer              user_data);
+JSON_AVAILABLE_IN_1_4
+gboolean    json_parser_load_lines_from_file    (JsonParser           *parser,
+                                                 const gchar          *filename,
+                                                 JsonParserLineFunc    func,
+                                                 gpointer              user_data,
+                                                 GError              **error);
+JSON_AVAILABLE_IN_1_4
+gboolean    json_parser_load_lines_from_stream  (JsonParser           *parser,
+                                                 GInputStream         *stream,
+                                                 GCancellable         *cancellable,
+                                                 JsonParserLineFunc    func,
+                                                 gpointer              user_data,
+                                                 GError              **error);
+JSON_AVAILABLE_IN_1_4
+gboolean    json_parser_load_lines_from_file_parallel (JsonParser          *parser,
+                                                       const gchar         *filename,
+                                                       guint                n_threads,
+                                                       JsonParserLineFunc   func,
+                                                       gpointer             user_data,
+                                                       GError             **error);
+
 JSON_AVAILABLE_IN_1_0
 JsonNode *  json_parser_get_root                (JsonParser           *parser);
 JSON_AVAILABLE_IN_1_4
@@ -709,7 +709,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_CHILD_MEMBER:
       if (JSON_NODE_HOLDS_OBJECT (root))
         {
-          JsonObject *object = json_node_get_object (root);
+          JsonObject *object = root->data.object;
 
           if (json_object_has_member (object, node->data.member_name))
             {
@@ -729,7 +729,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_CHILD_ELEMENT:
       if (JSON_NODE_HOLDS_ARRAY (root))
         {
-          JsonArray *array = json_node_get_array (root);
+          JsonArray *array = root->data.array;
 
           if (json_array_get_length (array) >= node->data.element_index)
             {
@@ -754,7 +754,7 @@ walk_path_node (GList      *path,
           {
           case JSON_NODE_OBJECT:
             {
-              JsonObject *object = json_node_get_object (root);
+              JsonObject *object = root->data.object;
               GList *members, *l;
 
               members = json_object_get_members (object);
@@ -780,7 +780,7 @@ walk_path_node (GList      *path,
 
           case JSON_NODE_ARRAY:
             {
-              JsonArray *array = json_node_get_array (root);
+              JsonArray *array = root->data.array;
               GList *members, *l;
               int i;
 
@@ -814,7 +814,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_WILDCARD_MEMBER:
       if (JSON_NODE_HOLDS_OBJECT (root))
         {
-          JsonObject *object = json_node_get_object (root);
+          JsonObject *object = root->data.object;
           GList *members, *l;
 
           members = json_object_get_members (object);
@@ -839,7 +839,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_WILDCARD_ELEMENT:
       if (JSON_NODE_HOLDS_ARRAY (root))
         {
-          JsonArray *array = json_node_get_array (root);
+          JsonArray *array = root->data.array;
           GList *elements, *l;
           int i;
 
@@ -865,7 +865,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_ELEMENT_SET:
       if (JSON_NODE_HOLDS_ARRAY (root))
         {
-          JsonArray *array = json_node_get_array (root);
+          JsonArray *array = root->data.array;
           int i;
 
           for (i = 0; i < node->data.set.n_indices; i += 1)
@@ -887,7 +887,7 @@ walk_path_node (GList      *path,
     case JSON_PATH_NODE_ELEMENT_SLICE:
       if (JSON_NODE_HOLDS_ARRAY (root))
         {
-          JsonArray *array = json_node_get_array (root);
+          JsonArray *array = root->data.array;
           int i, start, end;
 
           if (node->data.slice.start < 0)
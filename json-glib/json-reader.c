@@ -191,7 +191,7 @@ static void
 json_reader_init (JsonReader *self)
 {
   self->priv = json_reader_get_instance_private (self);
-  self->priv->members = g_ptr_array_new_with_free_func (g_free);
+  self->priv->members = g_ptr_array_new_with_free_func ((GDestroyNotify) json_key_unref);
 }
 
 /**
@@ -510,7 +510,7 @@ json_reader_read_element (JsonReader *reader,
         name = g_list_nth_data (members, index_);
 
         priv->current_node = json_object_get_member (object, name);
-        g_ptr_array_add (priv->members, g_strdup (name));
+        g_ptr_array_add (priv->members, json_key_new (name));
 
         g_list_free (members);
       }
@@ -655,6 +655,7 @@ json_reader_read_member (JsonReader  *reader,
 {
   JsonReaderPrivate *priv;
   JsonObject *object;
+  JsonNode *node;
 
   g_return_val_if_fail (JSON_READER (reader), FALSE);
   g_return_val_if_fail (member_name != NULL, FALSE);
@@ -672,15 +673,70 @@ json_reader_read_member (JsonReader  *reader,
                                   json_node_type_name (priv->current_node));
 
   object = json_node_get_object (priv->current_node);
-  if (!json_object_has_member (object, member_name))
+  node = json_object_get_member (object, member_name);
+  if (node == NULL)
     return json_reader_set_error (reader, JSON_READER_ERROR_INVALID_MEMBER,
                                   _("The member “%s” is not defined in the "
                                     "object at the current position."),
                                   member_name);
 
   priv->previous_node = priv->current_node;
-  priv->current_node = json_object_get_member (object, member_name);
-  g_ptr_array_add (priv->members, g_strdup (member_name));
+  priv->current_node = node;
+  g_ptr_array_add (priv->members, json_key_new (member_name));
+
+  return TRUE;
+}
+
+/**
+ * json_reader_read_member_by_key:
+ * @reader: a #JsonReader
+ * @key: the key of the member to read
+ *
+ * Advances the cursor of @reader to the member named by @key of the
+ * object at the current position.
+ *
+ * This function is the same as json_reader_read_member(), but it does
+ * not need to hash the name of the member, or copy it; using a #JsonKey
+ * is faster when reading the same member of many objects.
+ *
+ * Return value: %TRUE on success, and %FALSE otherwise
+ *
+ * Since: 1.4
+ */
+gboolean
+json_reader_read_member_by_key (JsonReader *reader,
+                                JsonKey    *key)
+{
+  JsonReaderPrivate *priv;
+  JsonObject *object;
+  JsonNode *node;
+
+  g_return_val_if_fail (JSON_READER (reader), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+  json_reader_return_val_if_error_set (reader, FALSE);
+
+  priv = reader->priv;
+
+  if (priv->current_node == NULL)
+    priv->current_node = priv->root;
+
+  if (!JSON_NODE_HOLDS_OBJECT (priv->current_node))
+    return json_reader_set_error (reader, JSON_READER_ERROR_NO_OBJECT,
+                                  _("The current node is of type “%s”, but "
+                                    "an object was expected."),
+                                  json_node_type_name (priv->current_node));
+
+  object = json_node_get_object (priv->current_node);
+  node = json_object_get_member_by_key (object, key);
+  if (node == NULL)
+    return json_reader_set_error (reader, JSON_READER_ERROR_INVALID_MEMBER,
+                                  _("The member “%s” is not defined in the "
+                                    "object at the current position."),
+                                  json_key_get_name (key));
+
+  priv->previous_node = priv->current_node;
+  priv->current_node = node;
+  g_ptr_array_add (priv->members, json_key_ref (key));
 
   return TRUE;
 }
@@ -1065,6 +1121,6 @@ json_reader_get_member_name (JsonReader *reader)
   if (reader->priv->members->len == 0)
     return NULL;
 
-  return g_ptr_array_index (reader->priv->members,
-                            reader->priv->members->len - 1);
+  return json_key_get_name (g_ptr_array_index (reader->priv->members,
+                                               reader->priv->members->len - 1));
 }
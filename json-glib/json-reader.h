@@ -142,6 +142,9 @@ gboolean               json_reader_is_object         (JsonReader   *reader);
 JSON_AVAILABLE_IN_1_0
 gboolean               json_reader_read_member       (JsonReader   *reader,
                                                       const gchar  *member_name);
+JSON_AVAILABLE_IN_1_4
+gboolean               json_reader_read_member_by_key (JsonReader   *reader,
+                                                       JsonKey      *key);
 JSON_AVAILABLE_IN_1_0
 void                   json_reader_end_member        (JsonReader   *reader);
 JSON_AVAILABLE_IN_1_0
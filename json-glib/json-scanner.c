@@ -20,287 +20,136 @@
  * License along with this library; if not, see <http://www.gnu.org/licenses/>.
  */
 
+/*
+ * The tokenizer only knows about the JSON grammar, plus the barewords
+ * needed by the "var name = ..." assignment extension; it dispatches on
+ * the first byte of each token, and it matches the 'true', 'false', 'null'
+ * and 'var' keywords directly instead of going through a symbol table.
+ *
+ * Tokens follow the GScanner conventions, which are what JsonParser
+ * expects:
+ *
+ *  - structural characters, and any other unexpected byte, are returned
+ *    as their own token, e.g. '[' or '-'; JSON numbers are unsigned, and
+ *    the parser is responsible for the minus sign
+ *  - integers are returned as %G_TOKEN_INT, with their value stored
+ *    in v_int64; numbers with a fractional part or an exponent are
+ *    returned as %G_TOKEN_FLOAT, with their value stored in v_float
+ *  - strings are returned as %G_TOKEN_STRING, with the unescaped
+ *    contents stored in v_string and their length in string_len; strings
+ *    without escape sequences are not copied, and v_string points
+ *    inside the input text instead
+ *  - keywords are returned as one of the #JsonTokenType values, and any
+ *    other bareword as %G_TOKEN_IDENTIFIER, with its name stored in
+ *    v_identifier
+ *  - malformed tokens are returned as %G_TOKEN_ERROR, with a #GErrorType
+ *    stored in v_error
+ */
+
 #include "config.h"
 
-#include <errno.h>
-#include <stdlib.h>
-#include <stdarg.h>
+#include <float.h>
 #include <string.h>
-#include <stdio.h>
-#ifdef HAVE_UNISTD_H
-#include <unistd.h>
-#endif
 
 #include <glib.h>
 #include <glib/gprintf.h>
 
 #include "json-scanner.h"
 
-#ifdef G_OS_WIN32
-#include <io.h> /* For _read() */
-#endif
-
-struct _JsonScannerConfig
-{
-  /* Character sets
-   */
-  gchar *cset_skip_characters; /* default: " \t\n" */
-  gchar *cset_identifier_first;
-  gchar *cset_identifier_nth;
-  gchar *cpair_comment_single; /* default: "#\n" */
-  
-  /* Should symbol lookup work case sensitive? */
-  guint case_sensitive : 1;
-  
-  /* Boolean values to be adjusted "on the fly"
-   * to configure scanning behaviour.
-   */
-  guint skip_comment_multi : 1;  /* C like comment */
-  guint skip_comment_single : 1; /* single line comment */
-  guint scan_comment_multi : 1;  /* scan multi line comments? */
-  guint scan_identifier : 1;
-  guint scan_identifier_1char : 1;
-  guint scan_identifier_NULL : 1;
-  guint scan_symbols : 1;
-  guint scan_binary : 1;
-  guint scan_octal : 1;
-  guint scan_float : 1;
-  guint scan_hex : 1;            /* `0x0ff0' */
-  guint scan_hex_dollar : 1;     /* `$0ff0' */
-  guint scan_string_sq : 1;      /* string: 'anything' */
-  guint scan_string_dq : 1;      /* string: "\\-escapes!\n" */
-  guint numbers_2_int : 1;       /* bin, octal, hex => int */
-  guint int_2_float : 1;         /* int => G_TOKEN_FLOAT? */
-  guint identifier_2_string : 1;
-  guint char_2_token : 1;        /* return G_TOKEN_CHAR? */
-  guint symbol_2_token : 1;
-  guint scope_0_fallback : 1;    /* try scope 0 on lookups? */
-  guint store_int64 : 1;         /* use value.v_int64 rather than v_int */
-  guint padding_dummy;
-};
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_SCANNER_USE_SSE2 1
 
-static JsonScannerConfig json_scanner_config_template =
-{
-  ( " \t\r\n" )		/* cset_skip_characters */,
-  (
-   "_"
-   G_CSET_a_2_z
-   G_CSET_A_2_Z
-  )			/* cset_identifier_first */,
-  (
-   G_CSET_DIGITS
-   "-_"
-   G_CSET_a_2_z
-   G_CSET_A_2_Z
-  )			/* cset_identifier_nth */,
-  ( "//\n" )		/* cpair_comment_single */,
-  TRUE			/* case_sensitive */,
-  TRUE			/* skip_comment_multi */,
-  TRUE			/* skip_comment_single */,
-  FALSE			/* scan_comment_multi */,
-  TRUE			/* scan_identifier */,
-  TRUE			/* scan_identifier_1char */,
-  FALSE			/* scan_identifier_NULL */,
-  TRUE			/* scan_symbols */,
-  TRUE			/* scan_binary */,
-  TRUE			/* scan_octal */,
-  TRUE			/* scan_float */,
-  TRUE			/* scan_hex */,
-  TRUE			/* scan_hex_dollar */,
-  TRUE			/* scan_string_sq */,
-  TRUE			/* scan_string_dq */,
-  TRUE			/* numbers_2_int */,
-  FALSE			/* int_2_float */,
-  FALSE			/* identifier_2_string */,
-  TRUE			/* char_2_token */,
-  TRUE			/* symbol_2_token */,
-  FALSE			/* scope_0_fallback */,
-  TRUE                  /* store_int64 */
-};
+#if defined(__GNUC__)
+#define json_ctz(x)             __builtin_ctz (x)
+#else
+#define json_ctz(x)             g_bit_nth_lsf ((x), -1)
+#endif
+#endif
 
-/* --- defines --- */
-#define	to_lower(c)				( \
-	(guchar) (							\
-	  ( (((guchar)(c))>='A' && ((guchar)(c))<='Z') * ('a'-'A') ) |	\
-	  ( (((guchar)(c))>=192 && ((guchar)(c))<=214) * (224-192) ) |	\
-	  ( (((guchar)(c))>=216 && ((guchar)(c))<=222) * (248-216) ) |	\
-	  ((guchar)(c))							\
-	)								\
-)
+/* numbers that need to be converted by g_ascii_strtod(), and that are
+ * longer than this, are copied on the heap
+ */
+#define NUMBER_BUFFER_SIZE      64
 
-#define	READ_BUFFER_SIZE	(4000)
+#define is_hex_digit(c)         (((c) >= '0' && (c) <= '9') || \
+                                 ((c) >= 'a' && (c) <= 'f') || \
+                                 ((c) >= 'A' && (c) <= 'F'))
+#define to_hex_digit(c)         (((c) <= '9') ? (c) - '0' : ((c) & 7) + 9)
 
-/* --- typedefs --- */
-typedef	struct	_JsonScannerKey JsonScannerKey;
+#define is_digit(c)             ((c) >= '0' && (c) <= '9')
 
-struct	_JsonScannerKey
-{
-  guint scope_id;
-  gchar *symbol;
-  gpointer value;
-};
+#define is_string_special(c)    ((c) == '"' || (c) == '\\' || \
+                                 (guchar) (c) < 0x20 || (guchar) (c) >= 0x80)
 
-/* --- prototypes --- */
-static gboolean	json_scanner_key_equal (gconstpointer v1,
-                                        gconstpointer v2);
-static guint    json_scanner_key_hash  (gconstpointer v);
-
-static inline
-JsonScannerKey *json_scanner_lookup_internal (JsonScanner *scanner,
-                                              guint        scope_id,
-                                              const gchar *symbol);
-static void     json_scanner_get_token_ll    (JsonScanner *scanner,
-                                              GTokenType  *token_p,
-                                              GTokenValue *value_p,
-                                              guint       *line_p,
-                                              guint       *position_p);
-static void	json_scanner_get_token_i     (JsonScanner *scanner,
-                                              GTokenType  *token_p,
-                                              GTokenValue *value_p,
-                                              guint       *line_p,
-                                              guint       *position_p);
-
-static guchar   json_scanner_peek_next_char  (JsonScanner *scanner);
-static guchar   json_scanner_get_char        (JsonScanner *scanner,
-                                              guint       *line_p,
-                                              guint       *position_p);
-static gunichar json_scanner_get_unichar     (JsonScanner *scanner,
-                                              guint       *line_p,
-                                              guint       *position_p);
-
-/* --- functions --- */
-static inline gint
-json_scanner_char_2_num (guchar c,
-                         guchar base)
-{
-  if (c >= '0' && c <= '9')
-    c -= '0';
-  else if (c >= 'A' && c <= 'Z')
-    c -= 'A' - 10;
-  else if (c >= 'a' && c <= 'z')
-    c -= 'a' - 10;
-  else
-    return -1;
-  
-  if (c < base)
-    return c;
-  
-  return -1;
-}
+#define is_identifier_first(c)  (((c) >= 'a' && (c) <= 'z') || \
+                                 ((c) >= 'A' && (c) <= 'Z') || \
+                                 (c) == '_')
+#define is_identifier_nth(c)    (is_identifier_first (c) || \
+                                 is_digit (c) || \
+                                 (c) == '-')
 
 JsonScanner *
 json_scanner_new (void)
 {
   JsonScanner *scanner;
-  JsonScannerConfig *config_templ;
-  
-  config_templ = &json_scanner_config_template;
-  
+
   scanner = g_new0 (JsonScanner, 1);
-  
+
   scanner->user_data = NULL;
-  scanner->max_parse_errors = 1;
-  scanner->parse_errors	= 0;
-  scanner->input_name = NULL;
-  g_datalist_init (&scanner->qdata);
-  
-  scanner->config = g_new0 (JsonScannerConfig, 1);
-  
-  scanner->config->case_sensitive	 = config_templ->case_sensitive;
-  scanner->config->cset_skip_characters	 = config_templ->cset_skip_characters;
-  if (!scanner->config->cset_skip_characters)
-    scanner->config->cset_skip_characters = "";
-  scanner->config->cset_identifier_first = config_templ->cset_identifier_first;
-  scanner->config->cset_identifier_nth	 = config_templ->cset_identifier_nth;
-  scanner->config->cpair_comment_single	 = config_templ->cpair_comment_single;
-  scanner->config->skip_comment_multi	 = config_templ->skip_comment_multi;
-  scanner->config->skip_comment_single	 = config_templ->skip_comment_single;
-  scanner->config->scan_comment_multi	 = config_templ->scan_comment_multi;
-  scanner->config->scan_identifier	 = config_templ->scan_identifier;
-  scanner->config->scan_identifier_1char = config_templ->scan_identifier_1char;
-  scanner->config->scan_identifier_NULL	 = config_templ->scan_identifier_NULL;
-  scanner->config->scan_symbols		 = config_templ->scan_symbols;
-  scanner->config->scan_binary		 = config_templ->scan_binary;
-  scanner->config->scan_octal		 = config_templ->scan_octal;
-  scanner->config->scan_float		 = config_templ->scan_float;
-  scanner->config->scan_hex		 = config_templ->scan_hex;
-  scanner->config->scan_hex_dollar	 = config_templ->scan_hex_dollar;
-  scanner->config->scan_string_sq	 = config_templ->scan_string_sq;
-  scanner->config->scan_string_dq	 = config_templ->scan_string_dq;
-  scanner->config->numbers_2_int	 = config_templ->numbers_2_int;
-  scanner->config->int_2_float		 = config_templ->int_2_float;
-  scanner->config->identifier_2_string	 = config_templ->identifier_2_string;
-  scanner->config->char_2_token		 = config_templ->char_2_token;
-  scanner->config->symbol_2_token	 = config_templ->symbol_2_token;
-  scanner->config->scope_0_fallback	 = config_templ->scope_0_fallback;
-  scanner->config->store_int64		 = config_templ->store_int64;
-  
+  scanner->parse_errors = 0;
+
   scanner->token = G_TOKEN_NONE;
   scanner->value.v_int64 = 0;
   scanner->line = 1;
   scanner->position = 0;
-  
+
   scanner->next_token = G_TOKEN_NONE;
   scanner->next_value.v_int64 = 0;
   scanner->next_line = 1;
   scanner->next_position = 0;
-  
-  scanner->symbol_table = g_hash_table_new (json_scanner_key_hash,
-                                            json_scanner_key_equal);
+
   scanner->text = NULL;
   scanner->text_end = NULL;
-  scanner->buffer = NULL;
-  scanner->scope_id = 0;
-  
+  scanner->line_start = NULL;
+  scanner->line_start_position = 0;
+  scanner->text_line = 1;
+
   return scanner;
 }
 
 static inline void
 json_scanner_free_value (GTokenType  *token_p,
-                         GTokenValue *value_p)
+                         GTokenValue *value_p,
+                         gboolean     is_slice)
 {
   switch (*token_p)
     {
     case G_TOKEN_STRING:
+      if (!is_slice)
+        g_free (value_p->v_string);
+      break;
+
     case G_TOKEN_IDENTIFIER:
-    case G_TOKEN_IDENTIFIER_NULL:
-    case G_TOKEN_COMMENT_SINGLE:
-    case G_TOKEN_COMMENT_MULTI:
-      g_free (value_p->v_string);
+      g_free (value_p->v_identifier);
       break;
-      
+
     default:
       break;
     }
-  
-  *token_p = G_TOKEN_NONE;
-}
 
-static void
-json_scanner_destroy_symbol_table_entry (gpointer _key,
-                                         gpointer _value,
-                                         gpointer _data)
-{
-  JsonScannerKey *key = _key;
-  
-  g_free (key->symbol);
-  g_slice_free (JsonScannerKey, key);
+  *token_p = G_TOKEN_NONE;
 }
 
 void
 json_scanner_destroy (JsonScanner *scanner)
 {
   g_return_if_fail (scanner != NULL);
-  
-  g_datalist_clear (&scanner->qdata);
-  g_hash_table_foreach (scanner->symbol_table, 
-			json_scanner_destroy_symbol_table_entry,
-                        NULL);
-  g_hash_table_destroy (scanner->symbol_table);
-  json_scanner_free_value (&scanner->token, &scanner->value);
-  json_scanner_free_value (&scanner->next_token, &scanner->next_value);
-  g_free (scanner->config);
-  g_free (scanner->buffer);
+
+  json_scanner_free_value (&scanner->token, &scanner->value,
+                           scanner->string_is_slice);
+  json_scanner_free_value (&scanner->next_token, &scanner->next_value,
+                           scanner->next_string_is_slice);
   g_free (scanner);
 }
 
@@ -311,115 +160,31 @@ json_scanner_error (JsonScanner *scanner,
 {
   g_return_if_fail (scanner != NULL);
   g_return_if_fail (format != NULL);
-  
+
   scanner->parse_errors++;
-  
+
   if (scanner->msg_handler)
     {
       va_list args;
       gchar *string;
-      
+
       va_start (args, format);
       string = g_strdup_vprintf (format, args);
       va_end (args);
-      
+
       scanner->msg_handler (scanner, string);
-      
+
       g_free (string);
     }
 }
 
-static gboolean
-json_scanner_key_equal (gconstpointer v1,
-                        gconstpointer v2)
-{
-  const JsonScannerKey *key1 = v1;
-  const JsonScannerKey *key2 = v2;
-  
-  return (key1->scope_id == key2->scope_id) &&
-         (strcmp (key1->symbol, key2->symbol) == 0);
-}
-
-static guint
-json_scanner_key_hash (gconstpointer v)
-{
-  const JsonScannerKey *key = v;
-  gchar *c;
-  guint h;
-  
-  h = key->scope_id;
-  for (c = key->symbol; *c; c++)
-    h = (h << 5) - h + *c;
-  
-  return h;
-}
-
-static inline JsonScannerKey *
-json_scanner_lookup_internal (JsonScanner *scanner,
-                              guint        scope_id,
-                              const gchar *symbol)
-{
-  JsonScannerKey *key_p;
-  JsonScannerKey key;
-  
-  key.scope_id = scope_id;
-  
-  if (!scanner->config->case_sensitive)
-    {
-      gchar *d;
-      const gchar *c;
-      
-      key.symbol = g_new (gchar, strlen (symbol) + 1);
-      for (d = key.symbol, c = symbol; *c; c++, d++)
-	*d = to_lower (*c);
-      *d = 0;
-      key_p = g_hash_table_lookup (scanner->symbol_table, &key);
-      g_free (key.symbol);
-    }
-  else
-    {
-      key.symbol = (gchar*) symbol;
-      key_p = g_hash_table_lookup (scanner->symbol_table, &key);
-    }
-  
-  return key_p;
-}
-
-void
-json_scanner_scope_add_symbol (JsonScanner *scanner,
-                               guint        scope_id,
-                               const gchar *symbol,
-                               gpointer     value)
-{
-  JsonScannerKey *key;
-
-  g_return_if_fail (scanner != NULL);
-  g_return_if_fail (symbol != NULL);
-
-  key = json_scanner_lookup_internal (scanner, scope_id, symbol);
-  if (!key)
-    {
-      key = g_slice_new (JsonScannerKey);
-      key->scope_id = scope_id;
-      key->symbol = g_strdup (symbol);
-      key->value = value;
-      if (!scanner->config->case_sensitive)
-	{
-	  gchar *c;
-
-	  c = key->symbol;
-	  while (*c != 0)
-	    {
-	      *c = to_lower (*c);
-	      c++;
-	    }
-	}
-
-      g_hash_table_insert (scanner->symbol_table, key, key);
-    }
-  else
-    key->value = value;
-}
+static void json_scanner_get_token_i (JsonScanner *scanner,
+                                      GTokenType  *token_p,
+                                      GTokenValue *value_p,
+                                      guint       *line_p,
+                                      guint       *position_p,
+                                      gsize       *string_len_p,
+                                      gboolean    *string_is_slice_p);
 
 GTokenType
 json_scanner_peek_next_token (JsonScanner *scanner)
@@ -434,7 +199,9 @@ json_scanner_peek_next_token (JsonScanner *scanner)
                                 &scanner->next_token,
                                 &scanner->next_value,
                                 &scanner->next_line,
-                                &scanner->next_position);
+                                &scanner->next_position,
+                                &scanner->next_string_len,
+                                &scanner->next_string_is_slice);
     }
 
   return scanner->next_token;
@@ -447,12 +214,15 @@ json_scanner_get_next_token (JsonScanner *scanner)
 
   if (scanner->next_token != G_TOKEN_NONE)
     {
-      json_scanner_free_value (&scanner->token, &scanner->value);
+      json_scanner_free_value (&scanner->token, &scanner->value,
+                               scanner->string_is_slice);
 
       scanner->token = scanner->next_token;
       scanner->value = scanner->next_value;
       scanner->line = scanner->next_line;
       scanner->position = scanner->next_position;
+      scanner->string_len = scanner->next_string_len;
+      scanner->string_is_slice = scanner->next_string_is_slice;
       scanner->next_token = G_TOKEN_NONE;
     }
   else
@@ -460,7 +230,9 @@ json_scanner_get_next_token (JsonScanner *scanner)
                               &scanner->token,
                               &scanner->value,
                               &scanner->line,
-                              &scanner->position);
+                              &scanner->position,
+                              &scanner->string_len,
+                              &scanner->string_is_slice);
 
   return scanner->token;
 }
@@ -468,7 +240,7 @@ json_scanner_get_next_token (JsonScanner *scanner)
 void
 json_scanner_input_text (JsonScanner *scanner,
                          const gchar *text,
-                         guint        text_len)
+                         gsize        text_len)
 {
   g_return_if_fail (scanner != NULL);
   if (text_len)
@@ -476,84 +248,100 @@ json_scanner_input_text (JsonScanner *scanner,
   else
     text = NULL;
 
+  json_scanner_free_value (&scanner->token, &scanner->value,
+                           scanner->string_is_slice);
+  json_scanner_free_value (&scanner->next_token, &scanner->next_value,
+                           scanner->next_string_is_slice);
+
   scanner->token = G_TOKEN_NONE;
   scanner->value.v_int64 = 0;
   scanner->line = 1;
   scanner->position = 0;
   scanner->next_token = G_TOKEN_NONE;
 
+  scanner->string_len = 0;
+  scanner->string_is_slice = FALSE;
+  scanner->invalid_data = FALSE;
+
   scanner->text = text;
   scanner->text_end = text + text_len;
-
-  if (scanner->buffer)
-    {
-      g_free (scanner->buffer);
-      scanner->buffer = NULL;
-    }
+  scanner->line_start = text;
+  scanner->line_start_position = 0;
+  scanner->text_line = 1;
 }
 
-static guchar
-json_scanner_peek_next_char (JsonScanner *scanner)
+/*
+ * json_scanner_input_partial_text:
+ * @scanner: a #JsonScanner
+ * @text: the text to scan
+ * @text_len: the length of @text
+ * @line: the line of the first character of @text
+ * @position: the position of the first character of @text on its line
+ *
+ * Replaces the input text of @scanner with a fragment of a larger
+ * input, which starts at the given @line and @position; this is used
+ * when the input is read in chunks, to scan it again from the start
+ * of a token that was truncated by the end of the previous chunk.
+ *
+ * Any token that was already read is discarded.
+ */
+void
+json_scanner_input_partial_text (JsonScanner *scanner,
+                                 const gchar *text,
+                                 gsize        text_len,
+                                 guint        line,
+                                 guint        position)
 {
-  if (scanner->text < scanner->text_end)
-    return *scanner->text;
-  else
-    return 0;
-}
+  g_return_if_fail (scanner != NULL);
 
-static guchar
-json_scanner_get_char (JsonScanner *scanner,
-                       guint       *line_p,
-                       guint       *position_p)
-{
-  guchar fchar;
+  json_scanner_free_value (&scanner->token, &scanner->value,
+                           scanner->string_is_slice);
+  json_scanner_free_value (&scanner->next_token, &scanner->next_value,
+                           scanner->next_string_is_slice);
 
-  if (scanner->text < scanner->text_end)
-    fchar = *(scanner->text++);
-  else
-    fchar = 0;
-  
-  if (fchar == '\n')
-    {
-      (*position_p) = 0;
-      (*line_p)++;
-    }
-  else if (fchar)
-    {
-      (*position_p)++;
-    }
-  
-  return fchar;
-}
+  scanner->token = G_TOKEN_NONE;
+  scanner->value.v_int64 = 0;
+  scanner->next_token = G_TOKEN_NONE;
 
-#define is_hex_digit(c)         (((c) >= '0' && (c) <= '9') || \
-                                 ((c) >= 'a' && (c) <= 'f') || \
-                                 ((c) >= 'A' && (c) <= 'F'))
-#define to_hex_digit(c)         (((c) <= '9') ? (c) - '0' : ((c) & 7) + 9)
+  scanner->string_len = 0;
+  scanner->string_is_slice = FALSE;
+  scanner->invalid_data = FALSE;
 
-static gunichar
-json_scanner_get_unichar (JsonScanner *scanner,
-                          guint       *line_p,
-                          guint       *position_p)
-{
-  gunichar uchar;
-  gchar ch;
-  gint i;
+  scanner->text = text;
+  scanner->text_end = text + text_len;
+  scanner->line_start = text;
+  scanner->line_start_position = position;
+  scanner->text_line = line;
+}
 
-  uchar = 0;
-  for (i = 0; i < 4; i++)
+/*
+ * json_token_type_to_string:
+ * @token: a #JsonTokenType
+ *
+ * Retrieves the bareword for a keyword token.
+ *
+ * Returns: (transfer none) (nullable): the keyword, or %NULL
+ */
+const gchar *
+json_token_type_to_string (guint token)
+{
+  switch (token)
     {
-      ch = json_scanner_get_char (scanner, line_p, position_p);
+    case JSON_TOKEN_TRUE:
+      return "true";
 
-      if (is_hex_digit (ch))
-        uchar += ((gunichar) to_hex_digit (ch) << ((3 - i) * 4));
-      else
-        break;
-    }
+    case JSON_TOKEN_FALSE:
+      return "false";
+
+    case JSON_TOKEN_NULL:
+      return "null";
 
-  g_assert (g_unichar_validate (uchar) || g_unichar_type (uchar) == G_UNICODE_SURROGATE);
+    case JSON_TOKEN_VAR:
+      return "var";
 
-  return uchar;
+    default:
+      return NULL;
+    }
 }
 
 /*
@@ -580,6 +368,739 @@ decode_utf16_surrogate_pair (const gunichar units[2])
   return ucs;
 }
 
+/*
+ * json_scanner_read_unichar:
+ * @p: the first of the four hexadecimal digits of a "\u" escape
+ * @end: the end of the input
+ * @ucs: (out): return location for the UTF-16 code unit
+ *
+ * Reads the four hexadecimal digits of a "\u" escape.
+ *
+ * Returns: %TRUE if @p points to four hexadecimal digits
+ */
+static inline gboolean
+json_scanner_read_unichar (const gchar *p,
+                           const gchar *end,
+                           gunichar    *ucs)
+{
+  gunichar res = 0;
+  gint i;
+
+  if (end - p < 4)
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      guchar ch = p[i];
+
+      if (!is_hex_digit (ch))
+        return FALSE;
+
+      res = (res << 4) | to_hex_digit (ch);
+    }
+
+  *ucs = res;
+
+  return TRUE;
+}
+
+/*
+ * json_scanner_skip_plain:
+ * @p: the current position inside a string
+ * @end: the end of the input
+ *
+ * Skips the bytes of a string that can be copied verbatim, that is
+ * anything except quotes, backslashes, control characters, and the
+ * bytes of multi-byte UTF-8 sequences, which need to be validated.
+ *
+ * Returns: the position of the first byte that needs to be looked at
+ *   by the scanner, or @end
+ */
+static inline const gchar *
+json_scanner_skip_plain (const gchar *p,
+                         const gchar *end)
+{
+#ifdef JSON_SCANNER_USE_SSE2
+  const __m128i quote = _mm_set1_epi8 ('"');
+  const __m128i backslash = _mm_set1_epi8 ('\\');
+  const __m128i space = _mm_set1_epi8 (0x20);
+
+  while (end - p >= 16)
+    {
+      __m128i block = _mm_loadu_si128 ((const __m128i *) p);
+      __m128i special;
+      int mask;
+
+      /* a signed comparison against ' ' matches both the control
+       * characters and the bytes with the high bit set
+       */
+      special = _mm_or_si128 (_mm_cmpeq_epi8 (block, quote),
+                              _mm_cmpeq_epi8 (block, backslash));
+      special = _mm_or_si128 (special, _mm_cmplt_epi8 (block, space));
+
+      mask = _mm_movemask_epi8 (special);
+      if (mask != 0)
+        return p + json_ctz (mask);
+
+      p += 16;
+    }
+#else
+  /* look at a word at a time, using the usual bit twiddling tricks to
+   * check whether any of its bytes is interesting
+   */
+  while (end - p >= 8)
+    {
+      const guint64 ones = G_GUINT64_CONSTANT (0x0101010101010101);
+      const guint64 highs = G_GUINT64_CONSTANT (0x8080808080808080);
+      guint64 word, quote, backslash;
+
+      memcpy (&word, p, sizeof (guint64));
+
+      quote = word ^ (ones * '"');
+      backslash = word ^ (ones * '\\');
+
+      if ((((quote - ones) & ~quote) |
+           ((backslash - ones) & ~backslash) |
+           ((word - ones * 0x20) & ~word) |
+           word) & highs)
+        break;
+
+      p += 8;
+    }
+#endif
+
+  while (p < end && !is_string_special (*p))
+    p++;
+
+  return p;
+}
+
+/* line numbers and positions are only used to report errors, and since
+ * the input can be larger than 4 GiB they stop at G_MAXINT, which can
+ * still be printed in the error messages, instead of wrapping around
+ */
+static inline void
+json_scanner_new_line (JsonScanner *scanner,
+                       const gchar *line_start)
+{
+  if (scanner->text_line < G_MAXINT)
+    scanner->text_line += 1;
+
+  scanner->line_start = line_start;
+  scanner->line_start_position = 0;
+}
+
+/*
+ * json_scanner_get_position:
+ * @scanner: a #JsonScanner
+ * @p: a pointer inside the input text of @scanner, on the current line
+ *
+ * Retrieves the position of @p on its line.
+ *
+ * Returns: the position, or %G_MAXINT if the line is too long
+ */
+guint
+json_scanner_get_position (JsonScanner *scanner,
+                           const gchar *p)
+{
+  gsize position = (gsize) (p - scanner->line_start);
+
+  if (scanner->line_start_position >= G_MAXINT ||
+      position >= G_MAXINT - scanner->line_start_position)
+    return G_MAXINT;
+
+  return position + scanner->line_start_position;
+}
+
+static GTokenType
+json_scanner_scan_string (JsonScanner  *scanner,
+                          const gchar **p_inout,
+                          GTokenValue  *value_p,
+                          gsize        *len_p,
+                          gboolean     *is_slice_p)
+{
+  const gchar *p = *p_inout;
+  const gchar *end = scanner->text_end;
+  const gchar *run = p;
+  GString *gstring = NULL;
+
+  /* strings are validated as they are scanned, and strings without escape
+   * sequences are returned as a slice of the input, so that we can copy
+   * them only once; the escape sequences are decoded into a new buffer
+   * only once we find the first backslash
+   */
+  while (TRUE)
+    {
+      guchar ch;
+
+      p = json_scanner_skip_plain (p, end);
+      if (p == end)
+        goto unterminated;
+
+      ch = *p;
+
+      if (ch >= 0x80)
+        {
+          gunichar ucs = g_utf8_get_char_validated (p, end - p);
+
+          if (ucs == (gunichar) -1 || ucs == (gunichar) -2)
+            goto invalid_data;
+
+          p = g_utf8_next_char (p);
+          continue;
+        }
+
+      if (ch == '\0')
+        goto invalid_data;
+
+      if (ch == '\n')
+        {
+          p++;
+          json_scanner_new_line (scanner, p);
+          continue;
+        }
+
+      /* other control characters are kept as they are */
+      if (ch < 0x20)
+        {
+          p++;
+          continue;
+        }
+
+      if (ch == '"')
+        break;
+
+      /* escape sequences */
+      if (gstring == NULL)
+        gstring = g_string_sized_new ((p - run) + 16);
+
+      g_string_append_len (gstring, run, p - run);
+
+      p++;
+      if (p == end)
+        goto unterminated;
+
+      ch = *p++;
+      switch (ch)
+        {
+        case '"':
+        case '\\':
+        case '/':
+          g_string_append_c (gstring, ch);
+          break;
+
+        case 'b':
+          g_string_append_c (gstring, '\b');
+          break;
+
+        case 'f':
+          g_string_append_c (gstring, '\f');
+          break;
+
+        case 'n':
+          g_string_append_c (gstring, '\n');
+          break;
+
+        case 'r':
+          g_string_append_c (gstring, '\r');
+          break;
+
+        case 't':
+          g_string_append_c (gstring, '\t');
+          break;
+
+        case 'u':
+          {
+            gunichar units[2];
+            gunichar ucs;
+
+            if (!json_scanner_read_unichar (p, end, &units[0]))
+              break;
+
+            p += 4;
+            ucs = units[0];
+
+            /* resolve UTF-16 surrogates for Unicode characters not in the BMP,
+             * as per ECMA 404, § 9, "String"
+             */
+            if (0xd800 <= ucs && ucs <= 0xdbff)
+              {
+                if (end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    json_scanner_read_unichar (p + 2, end, &units[1]) &&
+                    0xdc00 <= units[1] && units[1] <= 0xdfff)
+                  {
+                    p += 6;
+                    ucs = decode_utf16_surrogate_pair (units);
+                  }
+                else
+                  ucs = 0xfffd;
+              }
+            else if (0xdc00 <= ucs && ucs <= 0xdfff)
+              ucs = 0xfffd;
+
+            g_string_append_unichar (gstring, ucs);
+          }
+          break;
+
+        default:
+          /* unknown escapes are kept verbatim, but they still need to
+           * go through the checks above
+           */
+          p--;
+          break;
+        }
+
+      run = p;
+    }
+
+  *p_inout = p + 1;
+
+  if (gstring == NULL)
+    {
+      value_p->v_string = (gchar *) run;
+      *len_p = p - run;
+      *is_slice_p = TRUE;
+    }
+  else
+    {
+      g_string_append_len (gstring, run, p - run);
+
+      *len_p = gstring->len;
+      *is_slice_p = FALSE;
+      value_p->v_string = g_string_free (gstring, FALSE);
+    }
+
+  return G_TOKEN_STRING;
+
+invalid_data:
+  if (gstring != NULL)
+    g_string_free (gstring, TRUE);
+
+  *p_inout = p;
+  scanner->invalid_data = TRUE;
+  value_p->v_error = G_ERR_UNKNOWN;
+
+  return G_TOKEN_ERROR;
+
+unterminated:
+  if (gstring != NULL)
+    g_string_free (gstring, TRUE);
+
+  *p_inout = p;
+  value_p->v_error = G_ERR_UNEXP_EOF_IN_STRING;
+
+  return G_TOKEN_ERROR;
+}
+
+/* all the powers of ten that can be exactly represented by a double */
+static const gdouble exact_powers_of_ten[] = {
+  1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+#define MAX_EXACT_POWER_OF_TEN  22
+#define MAX_EXACT_MANTISSA      (G_GUINT64_CONSTANT (1) << 53)
+
+/*
+ * json_scanner_fast_double:
+ * @mantissa: the decimal digits of the number, without the decimal point
+ * @exponent: the power of ten to apply to @mantissa
+ * @value: (out): return location for the result
+ *
+ * Computes `mantissa * 10^exponent` if it can be done exactly using
+ * double precision arithmetic, which is the case when both the mantissa
+ * and the power of ten fit inside 53 bits; the only rounding step is the
+ * final multiplication or division, which is correctly rounded.
+ *
+ * See: W. D. Clinger, "How to Read Floating Point Numbers Accurately"
+ *
+ * Returns: %TRUE if the fast path could be used
+ */
+static inline gboolean
+json_scanner_fast_double (guint64  mantissa,
+                          gint     exponent,
+                          gdouble *value)
+{
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  if (mantissa > MAX_EXACT_MANTISSA)
+    return FALSE;
+
+  if (exponent >= 0 && exponent <= MAX_EXACT_POWER_OF_TEN)
+    {
+      *value = (gdouble) mantissa * exact_powers_of_ten[exponent];
+      return TRUE;
+    }
+
+  if (exponent < 0 && exponent >= -MAX_EXACT_POWER_OF_TEN)
+    {
+      *value = (gdouble) mantissa / exact_powers_of_ten[-exponent];
+      return TRUE;
+    }
+
+  /* numbers like 123e30 can still be computed exactly, by moving some
+   * of the power of ten into the mantissa, as long as it still fits
+   */
+  if (exponent < 0)
+    return FALSE;
+
+  while (exponent > MAX_EXACT_POWER_OF_TEN && mantissa <= MAX_EXACT_MANTISSA / 10)
+    {
+      mantissa *= 10;
+      exponent -= 1;
+    }
+
+  if (exponent <= MAX_EXACT_POWER_OF_TEN)
+    {
+      *value = (gdouble) mantissa * exact_powers_of_ten[exponent];
+      return TRUE;
+    }
+#endif
+
+  /* with extended precision intermediate results, the double rounding
+   * would make the result inexact
+   */
+  return FALSE;
+}
+
+static GTokenType
+json_scanner_scan_number (const gchar **p_inout,
+                          const gchar  *end,
+                          GTokenValue  *value_p)
+{
+  const gchar *start = *p_inout;
+  const gchar *p = start;
+  gboolean is_float = FALSE;
+  gboolean overflow = FALSE;
+  guint64 mantissa = 0;
+  gint exponent = 0;
+  gchar stack_buf[NUMBER_BUFFER_SIZE];
+  gchar *buf;
+  gsize len;
+
+  /* the digits of the integer and fractional parts are accumulated into
+   * the mantissa while we validate the number, so that we only have to
+   * go back to the input text for the numbers that do not fit into it
+   */
+#define ACCUMULATE_DIGIT(c) G_STMT_START { \
+  guint digit = (c) - '0'; \
+  if (G_LIKELY (mantissa <= (G_MAXUINT64 - digit) / 10)) \
+    mantissa = mantissa * 10 + digit; \
+  else \
+    overflow = TRUE; \
+} G_STMT_END
+
+  /* int = zero / ( digit1-9 *DIGIT ) */
+  if (*p == '0')
+    {
+      p++;
+
+      if (p < end && is_digit (*p))
+        goto non_digit;
+    }
+  else
+    {
+      while (p < end && is_digit (*p))
+        {
+          ACCUMULATE_DIGIT (*p);
+          p++;
+        }
+    }
+
+  /* frac = decimal-point 1*DIGIT */
+  if (p < end && *p == '.')
+    {
+      p++;
+
+      if (p == end || !is_digit (*p))
+        goto malformed;
+
+      while (p < end && is_digit (*p))
+        {
+          ACCUMULATE_DIGIT (*p);
+          exponent -= 1;
+          p++;
+        }
+
+      is_float = TRUE;
+    }
+
+#undef ACCUMULATE_DIGIT
+
+  /* exp = e [ minus / plus ] 1*DIGIT */
+  if (p < end && (*p == 'e' || *p == 'E'))
+    {
+      gboolean exp_negative = FALSE;
+      gint exp_value = 0;
+
+      p++;
+
+      if (p < end && (*p == '+' || *p == '-'))
+        {
+          exp_negative = *p == '-';
+          p++;
+        }
+
+      if (p == end || !is_digit (*p))
+        goto malformed;
+
+      while (p < end && is_digit (*p))
+        {
+          /* anything this large is going to be an infinity or a zero,
+           * and g_ascii_strtod() will take care of it
+           */
+          if (exp_value < 100000)
+            exp_value = exp_value * 10 + (*p - '0');
+          p++;
+        }
+
+      exponent += exp_negative ? -exp_value : exp_value;
+      is_float = TRUE;
+    }
+
+  if (p < end && (is_identifier_nth (*p) || *p == '.'))
+    goto non_digit;
+
+  *p_inout = p;
+
+  if (!overflow)
+    {
+      if (!is_float)
+        {
+          value_p->v_int64 = mantissa;
+          return G_TOKEN_INT;
+        }
+
+      if (mantissa == 0)
+        {
+          value_p->v_float = 0.0;
+          return G_TOKEN_FLOAT;
+        }
+
+      if (json_scanner_fast_double (mantissa, exponent, &value_p->v_float))
+        return G_TOKEN_FLOAT;
+    }
+
+  /* integers that do not fit into 64 bits are returned as doubles,
+   * instead of being clamped
+   */
+
+  /* the input is not guaranteed to be nul-terminated */
+  len = p - start;
+  if (len < NUMBER_BUFFER_SIZE)
+    {
+      memcpy (stack_buf, start, len);
+      stack_buf[len] = '\0';
+      buf = stack_buf;
+    }
+  else
+    buf = g_strndup (start, len);
+
+  value_p->v_float = g_ascii_strtod (buf, NULL);
+
+  if (buf != stack_buf)
+    g_free (buf);
+
+  return G_TOKEN_FLOAT;
+
+malformed:
+  *p_inout = p;
+  value_p->v_error = G_ERR_FLOAT_MALFORMED;
+  return G_TOKEN_ERROR;
+
+non_digit:
+  /* swallow the rest of the bareword, like the old scanner did */
+  while (p < end && (is_identifier_nth (*p) || *p == '.'))
+    p++;
+
+  *p_inout = p;
+  value_p->v_error = G_ERR_NON_DIGIT_IN_CONST;
+  return G_TOKEN_ERROR;
+}
+
+static inline gboolean
+json_scanner_match_keyword (const gchar *p,
+                            gsize        len,
+                            const gchar *keyword,
+                            gsize        keyword_len)
+{
+  return len == keyword_len && memcmp (p, keyword, keyword_len) == 0;
+}
+
+static void
+json_scanner_get_token_i (JsonScanner *scanner,
+                          GTokenType  *token_p,
+                          GTokenValue *value_p,
+                          guint       *line_p,
+                          guint       *position_p,
+                          gsize       *string_len_p,
+                          gboolean    *string_is_slice_p)
+{
+  const gchar *p = scanner->text;
+  const gchar *end = scanner->text_end;
+  GTokenType token;
+  GTokenValue value;
+  gsize string_len = 0;
+  gboolean string_is_slice = FALSE;
+  gboolean eof_position = FALSE;
+
+  json_scanner_free_value (token_p, value_p, *string_is_slice_p);
+
+  value.v_int64 = 0;
+
+  if (scanner->token == G_TOKEN_EOF)
+    {
+      token = G_TOKEN_EOF;
+      goto out;
+    }
+
+  /* skip whitespace */
+  while (p < end)
+    {
+      if (*p == ' ' || *p == '\t' || *p == '\r')
+        p++;
+      else if (*p == '\n')
+        {
+          p++;
+          json_scanner_new_line (scanner, p);
+        }
+      else
+        break;
+    }
+
+  if (p == end)
+    {
+      token = G_TOKEN_EOF;
+      goto out;
+    }
+
+  switch (*p)
+    {
+    case '\0':
+      /* embedded nul characters are not valid UTF-8 text */
+      scanner->invalid_data = TRUE;
+      token = G_TOKEN_ERROR;
+      value.v_error = G_ERR_UNKNOWN;
+      p++;
+      break;
+
+    case '{':
+    case '}':
+    case '[':
+    case ']':
+    case ':':
+    case ',':
+      token = (GTokenType) *p++;
+      break;
+
+    case '"':
+      p++;
+      token = json_scanner_scan_string (scanner, &p, &value,
+                                        &string_len,
+                                        &string_is_slice);
+      if (token == G_TOKEN_ERROR)
+        eof_position = TRUE;
+      break;
+
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      token = json_scanner_scan_number (&p, end, &value);
+      break;
+
+    default:
+      if (is_identifier_first (*p))
+        {
+          const gchar *start = p;
+          gsize len;
+
+          p++;
+          while (p < end && is_identifier_nth (*p))
+            p++;
+
+          len = p - start;
+
+          /* match the keywords before falling back to barewords */
+          switch (*start)
+            {
+            case 't':
+              if (json_scanner_match_keyword (start, len, "true", 4))
+                {
+                  token = (GTokenType) JSON_TOKEN_TRUE;
+                  goto out;
+                }
+              break;
+
+            case 'f':
+              if (json_scanner_match_keyword (start, len, "false", 5))
+                {
+                  token = (GTokenType) JSON_TOKEN_FALSE;
+                  goto out;
+                }
+              break;
+
+            case 'n':
+              if (json_scanner_match_keyword (start, len, "null", 4))
+                {
+                  token = (GTokenType) JSON_TOKEN_NULL;
+                  goto out;
+                }
+              break;
+
+            case 'v':
+              if (json_scanner_match_keyword (start, len, "var", 3))
+                {
+                  token = (GTokenType) JSON_TOKEN_VAR;
+                  goto out;
+                }
+              break;
+
+            default:
+              break;
+            }
+
+          token = G_TOKEN_IDENTIFIER;
+          value.v_identifier = g_strndup (start, len);
+        }
+      else
+        {
+          /* any other character is returned as is, and it's up to
+           * the parser to decide whether it's valid or not; the only
+           * thing we need to check is that the input is valid UTF-8
+           */
+          if ((guchar) *p >= 0x80)
+            {
+              gunichar ucs = g_utf8_get_char_validated (p, end - p);
+
+              if (ucs == (gunichar) -1 || ucs == (gunichar) -2)
+                {
+                  scanner->invalid_data = TRUE;
+                  token = G_TOKEN_ERROR;
+                  value.v_error = G_ERR_UNKNOWN;
+                  p++;
+                  break;
+                }
+            }
+
+          token = (GTokenType) (guchar) *p++;
+        }
+      break;
+    }
+
+out:
+  scanner->text = p;
+
+  *token_p = token;
+  *value_p = value;
+  *string_len_p = string_len;
+  *string_is_slice_p = string_is_slice;
+  *line_p = scanner->text_line;
+  *position_p = json_scanner_get_position (scanner, p);
+
+  /* errors at the end of the input point past the last character */
+  if (eof_position && *position_p < G_MAXINT)
+    *position_p += 1;
+}
+
 void
 json_scanner_unexp_token (JsonScanner *scanner,
                           GTokenType   expected_token,
@@ -594,47 +1115,38 @@ json_scanner_unexp_token (JsonScanner *scanner,
   guint	expected_string_len;
   gchar	*message_prefix;
   gboolean print_unexp;
-  
+
   g_return_if_fail (scanner != NULL);
-  
+
   if (!identifier_spec)
     identifier_spec = "identifier";
   if (!symbol_spec)
     symbol_spec = "symbol";
-  
+
   token_string_len = 56;
   token_string = g_new (gchar, token_string_len + 1);
   expected_string_len = 64;
   expected_string = g_new (gchar, expected_string_len + 1);
   print_unexp = TRUE;
-  
+
   switch (scanner->token)
     {
     case G_TOKEN_EOF:
       g_snprintf (token_string, token_string_len, "end of file");
       break;
-      
+
     default:
       if (scanner->token >= 1 && scanner->token <= 255)
 	{
-	  if ((scanner->token >= ' ' && scanner->token <= '~') ||
-	      strchr (scanner->config->cset_identifier_first, scanner->token) ||
-	      strchr (scanner->config->cset_identifier_nth, scanner->token))
+	  if (scanner->token >= ' ' && scanner->token <= '~')
 	    g_snprintf (token_string, token_string_len, "character `%c'", scanner->token);
 	  else
 	    g_snprintf (token_string, token_string_len, "character `\\%o'", scanner->token);
 	  break;
 	}
-      else if (!scanner->config->symbol_2_token)
-	{
-	  g_snprintf (token_string, token_string_len, "(unknown) token <%d>", scanner->token);
-	  break;
-	}
       /* fall through */
     case G_TOKEN_SYMBOL:
-      if (expected_token == G_TOKEN_SYMBOL ||
-	  (scanner->config->symbol_2_token &&
-	   expected_token > G_TOKEN_LAST))
+      if (expected_token == G_TOKEN_SYMBOL || expected_token > G_TOKEN_LAST)
 	print_unexp = FALSE;
       if (symbol_name)
 	g_snprintf (token_string, token_string_len,
@@ -648,7 +1160,7 @@ json_scanner_unexp_token (JsonScanner *scanner,
                     print_unexp ? "" : "invalid ",
                     symbol_spec);
       break;
- 
+
     case G_TOKEN_ERROR:
       print_unexp = FALSE;
       expected_token = G_TOKEN_NONE;
@@ -657,85 +1169,57 @@ json_scanner_unexp_token (JsonScanner *scanner,
 	case G_ERR_UNEXP_EOF:
 	  g_snprintf (token_string, token_string_len, "scanner: unexpected end of file");
 	  break;
-	  
+
 	case G_ERR_UNEXP_EOF_IN_STRING:
 	  g_snprintf (token_string, token_string_len, "scanner: unterminated string constant");
 	  break;
-	  
-	case G_ERR_UNEXP_EOF_IN_COMMENT:
-	  g_snprintf (token_string, token_string_len, "scanner: unterminated comment");
-	  break;
-	  
+
 	case G_ERR_NON_DIGIT_IN_CONST:
 	  g_snprintf (token_string, token_string_len, "scanner: non digit in constant");
 	  break;
-	  
-	case G_ERR_FLOAT_RADIX:
-	  g_snprintf (token_string, token_string_len, "scanner: invalid radix for floating constant");
-	  break;
-	  
+
 	case G_ERR_FLOAT_MALFORMED:
 	  g_snprintf (token_string, token_string_len, "scanner: malformed floating constant");
 	  break;
-	  
-	case G_ERR_DIGIT_RADIX:
-	  g_snprintf (token_string, token_string_len, "scanner: digit is beyond radix");
-	  break;
-	  
+
 	case G_ERR_UNKNOWN:
 	default:
 	  g_snprintf (token_string, token_string_len, "scanner: unknown error");
 	  break;
 	}
       break;
-      
-    case G_TOKEN_CHAR:
-      g_snprintf (token_string, token_string_len, "character `%c'", scanner->value.v_char);
-      break;
-      
+
     case G_TOKEN_IDENTIFIER:
-    case G_TOKEN_IDENTIFIER_NULL:
-      if (expected_token == G_TOKEN_IDENTIFIER ||
-	  expected_token == G_TOKEN_IDENTIFIER_NULL)
+      if (expected_token == G_TOKEN_IDENTIFIER)
 	print_unexp = FALSE;
       g_snprintf (token_string, token_string_len,
                   "%s%s `%s'",
                   print_unexp ? "" : "invalid ",
                   identifier_spec,
-                  scanner->token == G_TOKEN_IDENTIFIER ? scanner->value.v_string : "null");
+                  scanner->value.v_string);
       break;
-      
-    case G_TOKEN_BINARY:
-    case G_TOKEN_OCTAL:
+
     case G_TOKEN_INT:
-    case G_TOKEN_HEX:
-      if (scanner->config->store_int64)
-	g_snprintf (token_string, token_string_len, "number `%" G_GUINT64_FORMAT "'", scanner->value.v_int64);
-      else
-	g_snprintf (token_string, token_string_len, "number `%lu'", scanner->value.v_int);
+      g_snprintf (token_string, token_string_len, "number `%" G_GUINT64_FORMAT "'", scanner->value.v_int64);
       break;
-      
+
     case G_TOKEN_FLOAT:
       g_snprintf (token_string, token_string_len, "number `%.3f'", scanner->value.v_float);
       break;
-      
+
     case G_TOKEN_STRING:
       if (expected_token == G_TOKEN_STRING)
 	print_unexp = FALSE;
       g_snprintf (token_string, token_string_len,
-                  "%s%sstring constant \"%s\"",
+                  "%s%sstring constant \"%.*s\"",
                   print_unexp ? "" : "invalid ",
-                  scanner->value.v_string[0] == 0 ? "empty " : "",
+                  scanner->string_len == 0 ? "empty " : "",
+                  (int) MIN (scanner->string_len, token_string_len),
                   scanner->value.v_string);
       token_string[token_string_len - 2] = '"';
       token_string[token_string_len - 1] = 0;
       break;
-      
-    case G_TOKEN_COMMENT_SINGLE:
-    case G_TOKEN_COMMENT_MULTI:
-      g_snprintf (token_string, token_string_len, "comment");
-      break;
-      
+
     case G_TOKEN_NONE:
       /* somehow the user's parsing code is screwed, there isn't much
        * we can do about it.
@@ -746,8 +1230,7 @@ json_scanner_unexp_token (JsonScanner *scanner,
       g_assert_not_reached ();
       break;
     }
-  
-  
+
   switch (expected_token)
     {
       gboolean need_valid;
@@ -758,54 +1241,25 @@ json_scanner_unexp_token (JsonScanner *scanner,
     default:
       if (expected_token >= 1 && expected_token <= 255)
 	{
-	  if ((expected_token >= ' ' && expected_token <= '~') ||
-	      strchr (scanner->config->cset_identifier_first, expected_token) ||
-	      strchr (scanner->config->cset_identifier_nth, expected_token))
+	  if (expected_token >= ' ' && expected_token <= '~')
 	    g_snprintf (expected_string, expected_string_len, "character `%c'", expected_token);
 	  else
 	    g_snprintf (expected_string, expected_string_len, "character `\\%o'", expected_token);
 	  break;
 	}
-      else if (!scanner->config->symbol_2_token)
-	{
-	  g_snprintf (expected_string, expected_string_len, "(unknown) token <%d>", expected_token);
-	  break;
-	}
       /* fall through */
     case G_TOKEN_SYMBOL:
-      need_valid = (scanner->token == G_TOKEN_SYMBOL ||
-		    (scanner->config->symbol_2_token &&
-		     scanner->token > G_TOKEN_LAST));
+      need_valid = (scanner->token == G_TOKEN_SYMBOL || scanner->token > G_TOKEN_LAST);
       g_snprintf (expected_string, expected_string_len,
                   "%s%s",
                   need_valid ? "valid " : "",
                   symbol_spec);
-      /* FIXME: should we attempt to lookup the symbol_name for symbol_2_token? */
-      break;
-    case G_TOKEN_CHAR:
-      g_snprintf (expected_string, expected_string_len, "%scharacter",
-		  scanner->token == G_TOKEN_CHAR ? "valid " : "");
-      break;
-    case G_TOKEN_BINARY:
-      tstring = "binary";
-      g_snprintf (expected_string, expected_string_len, "%snumber (%s)",
-		  scanner->token == expected_token ? "valid " : "", tstring);
-      break;
-    case G_TOKEN_OCTAL:
-      tstring = "octal";
-      g_snprintf (expected_string, expected_string_len, "%snumber (%s)",
-		  scanner->token == expected_token ? "valid " : "", tstring);
       break;
     case G_TOKEN_INT:
       tstring = "integer";
       g_snprintf (expected_string, expected_string_len, "%snumber (%s)",
 		  scanner->token == expected_token ? "valid " : "", tstring);
       break;
-    case G_TOKEN_HEX:
-      tstring = "hexadecimal";
-      g_snprintf (expected_string, expected_string_len, "%snumber (%s)",
-		  scanner->token == expected_token ? "valid " : "", tstring);
-      break;
     case G_TOKEN_FLOAT:
       tstring = "float";
       g_snprintf (expected_string, expected_string_len, "%snumber (%s)",
@@ -818,31 +1272,19 @@ json_scanner_unexp_token (JsonScanner *scanner,
 		  scanner->token == G_TOKEN_STRING ? "valid " : "");
       break;
     case G_TOKEN_IDENTIFIER:
-    case G_TOKEN_IDENTIFIER_NULL:
-      need_valid = (scanner->token == G_TOKEN_IDENTIFIER_NULL ||
-		    scanner->token == G_TOKEN_IDENTIFIER);
+      need_valid = (scanner->token == G_TOKEN_IDENTIFIER);
       g_snprintf (expected_string,
 		  expected_string_len,
 		  "%s%s",
 		  need_valid ? "valid " : "",
 		  identifier_spec);
       break;
-    case G_TOKEN_COMMENT_SINGLE:
-      tstring = "single-line";
-      g_snprintf (expected_string, expected_string_len, "%scomment (%s)",
-		  scanner->token == expected_token ? "valid " : "", tstring);
-      break;
-    case G_TOKEN_COMMENT_MULTI:
-      tstring = "multi-line";
-      g_snprintf (expected_string, expected_string_len, "%scomment (%s)",
-		  scanner->token == expected_token ? "valid " : "", tstring);
-      break;
     case G_TOKEN_NONE:
     case G_TOKEN_ERROR:
       /* this is handled upon printout */
       break;
     }
-  
+
   if (message && message[0] != 0)
     message_prefix = " - ";
   else
@@ -890,654 +1332,7 @@ json_scanner_unexp_token (JsonScanner *scanner,
                             message_prefix,
                             message);
     }
-  
+
   g_free (token_string);
   g_free (expected_string);
 }
-
-static void
-json_scanner_get_token_i (JsonScanner	*scanner,
-		          GTokenType	*token_p,
-		          GTokenValue	*value_p,
-		          guint		*line_p,
-		          guint		*position_p)
-{
-  do
-    {
-      json_scanner_free_value (token_p, value_p);
-      json_scanner_get_token_ll (scanner, token_p, value_p, line_p, position_p);
-    }
-  while (((*token_p > 0 && *token_p < 256) &&
-	  strchr (scanner->config->cset_skip_characters, *token_p)) ||
-	 (*token_p == G_TOKEN_CHAR &&
-	  strchr (scanner->config->cset_skip_characters, value_p->v_char)) ||
-	 (*token_p == G_TOKEN_COMMENT_MULTI &&
-	  scanner->config->skip_comment_multi) ||
-	 (*token_p == G_TOKEN_COMMENT_SINGLE &&
-	  scanner->config->skip_comment_single));
-  
-  switch (*token_p)
-    {
-    case G_TOKEN_IDENTIFIER:
-      if (scanner->config->identifier_2_string)
-	*token_p = G_TOKEN_STRING;
-      break;
-      
-    case G_TOKEN_SYMBOL:
-      if (scanner->config->symbol_2_token)
-	*token_p = (GTokenType) value_p->v_symbol;
-      break;
-      
-    case G_TOKEN_BINARY:
-    case G_TOKEN_OCTAL:
-    case G_TOKEN_HEX:
-      if (scanner->config->numbers_2_int)
-	*token_p = G_TOKEN_INT;
-      break;
-      
-    default:
-      break;
-    }
-  
-  if (*token_p == G_TOKEN_INT &&
-      scanner->config->int_2_float)
-    {
-      *token_p = G_TOKEN_FLOAT;
-      if (scanner->config->store_int64)
-        {
-#ifdef _MSC_VER
-          /* work around error C2520, see gvaluetransform.c */
-          value_p->v_float = (__int64)value_p->v_int64;
-#else
-          value_p->v_float = value_p->v_int64;
-#endif
-        }
-      else
-	value_p->v_float = value_p->v_int;
-    }
-  
-  errno = 0;
-}
-
-static void
-json_scanner_get_token_ll (JsonScanner *scanner,
-                           GTokenType  *token_p,
-                           GTokenValue *value_p,
-                           guint       *line_p,
-                           guint       *position_p)
-{
-  JsonScannerConfig *config;
-  GTokenType	   token;
-  gboolean	   in_comment_multi;
-  gboolean	   in_comment_single;
-  gboolean	   in_string_sq;
-  gboolean	   in_string_dq;
-  GString	  *gstring;
-  GTokenValue	   value;
-  guchar	   ch;
-  
-  config = scanner->config;
-  (*value_p).v_int64 = 0;
-  
-  if (scanner->text >= scanner->text_end ||
-      scanner->token == G_TOKEN_EOF)
-    {
-      *token_p = G_TOKEN_EOF;
-      return;
-    }
-  
-  in_comment_multi = FALSE;
-  in_comment_single = FALSE;
-  in_string_sq = FALSE;
-  in_string_dq = FALSE;
-  gstring = NULL;
-  
-  do /* while (ch != 0) */
-    {
-      gboolean dotted_float = FALSE;
-      
-      ch = json_scanner_get_char (scanner, line_p, position_p);
-      
-      value.v_int64 = 0;
-      token = G_TOKEN_NONE;
-      
-      /* this is *evil*, but needed ;(
-       * we first check for identifier first character, because	 it
-       * might interfere with other key chars like slashes or numbers
-       */
-      if (config->scan_identifier &&
-	  ch && strchr (config->cset_identifier_first, ch))
-	goto identifier_precedence;
-      
-      switch (ch)
-	{
-	case 0:
-	  token = G_TOKEN_EOF;
-	  (*position_p)++;
-	  /* ch = 0; */
-	  break;
-	  
-	case '/':
-	  if (!config->scan_comment_multi ||
-	      json_scanner_peek_next_char (scanner) != '*')
-	    goto default_case;
-	  json_scanner_get_char (scanner, line_p, position_p);
-	  token = G_TOKEN_COMMENT_MULTI;
-	  in_comment_multi = TRUE;
-	  gstring = g_string_new (NULL);
-	  while ((ch = json_scanner_get_char (scanner, line_p, position_p)) != 0)
-	    {
-	      if (ch == '*' && json_scanner_peek_next_char (scanner) == '/')
-		{
-		  json_scanner_get_char (scanner, line_p, position_p);
-		  in_comment_multi = FALSE;
-		  break;
-		}
-	      else
-		gstring = g_string_append_c (gstring, ch);
-	    }
-	  ch = 0;
-	  break;
-	  
-	case '\'':
-	  if (!config->scan_string_sq)
-	    goto default_case;
-	  token = G_TOKEN_STRING;
-	  in_string_sq = TRUE;
-	  gstring = g_string_new (NULL);
-	  while ((ch = json_scanner_get_char (scanner, line_p, position_p)) != 0)
-	    {
-	      if (ch == '\'')
-		{
-		  in_string_sq = FALSE;
-		  break;
-		}
-	      else
-		gstring = g_string_append_c (gstring, ch);
-	    }
-	  ch = 0;
-	  break;
-	  
-	case '"':
-	  if (!config->scan_string_dq)
-	    goto default_case;
-	  token = G_TOKEN_STRING;
-	  in_string_dq = TRUE;
-	  gstring = g_string_new (NULL);
-	  while ((ch = json_scanner_get_char (scanner, line_p, position_p)) != 0)
-	    {
-	      if (ch == '"')
-		{
-		  in_string_dq = FALSE;
-		  break;
-		}
-	      else
-		{
-		  if (ch == '\\')
-		    {
-		      ch = json_scanner_get_char (scanner, line_p, position_p);
-		      switch (ch)
-			{
-			  guint	i;
-			  guint	fchar;
-			  
-			case 0:
-			  break;
-			  
-			case '\\':
-			  gstring = g_string_append_c (gstring, '\\');
-			  break;
-			  
-			case 'n':
-			  gstring = g_string_append_c (gstring, '\n');
-			  break;
-			  
-			case 't':
-			  gstring = g_string_append_c (gstring, '\t');
-			  break;
-			  
-			case 'r':
-			  gstring = g_string_append_c (gstring, '\r');
-			  break;
-			  
-			case 'b':
-			  gstring = g_string_append_c (gstring, '\b');
-			  break;
-			  
-			case 'f':
-			  gstring = g_string_append_c (gstring, '\f');
-			  break;
-
-                        case 'u':
-                          fchar = json_scanner_peek_next_char (scanner);
-                          if (is_hex_digit (fchar))
-                            {
-                              gunichar ucs;
-
-                              ucs = json_scanner_get_unichar (scanner, line_p, position_p);
-
-                              /* resolve UTF-16 surrogates for Unicode characters not in the BMP,
-                                * as per ECMA 404, § 9, "String"
-                                */
-                              if (g_unichar_type (ucs) == G_UNICODE_SURROGATE)
-                                {
-                                  /* read next surrogate */
-                                  if ('\\' == json_scanner_get_char (scanner, line_p, position_p) &&
-                                      'u' == json_scanner_get_char (scanner, line_p, position_p))
-                                    {
-                                      gunichar units[2];
-
-                                      units[0] = ucs;
-                                      units[1] = json_scanner_get_unichar (scanner, line_p, position_p);
-
-                                      ucs = decode_utf16_surrogate_pair (units);
-                                      g_assert (g_unichar_validate (ucs));
-                                    }
-                                }
-
-                              gstring = g_string_append_unichar (gstring, ucs);
-                            }
-                          break;
-			  
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			  i = ch - '0';
-			  fchar = json_scanner_peek_next_char (scanner);
-			  if (fchar >= '0' && fchar <= '7')
-			    {
-			      ch = json_scanner_get_char (scanner, line_p, position_p);
-			      i = i * 8 + ch - '0';
-			      fchar = json_scanner_peek_next_char (scanner);
-			      if (fchar >= '0' && fchar <= '7')
-				{
-				  ch = json_scanner_get_char (scanner, line_p, position_p);
-				  i = i * 8 + ch - '0';
-				}
-			    }
-			  gstring = g_string_append_c (gstring, i);
-			  break;
-			  
-			default:
-			  gstring = g_string_append_c (gstring, ch);
-			  break;
-			}
-		    }
-		  else
-		    gstring = g_string_append_c (gstring, ch);
-		}
-	    }
-	  ch = 0;
-	  break;
-	  
-	case '.':
-	  if (!config->scan_float)
-	    goto default_case;
-	  token = G_TOKEN_FLOAT;
-	  dotted_float = TRUE;
-	  ch = json_scanner_get_char (scanner, line_p, position_p);
-	  goto number_parsing;
-	  
-	case '$':
-	  if (!config->scan_hex_dollar)
-	    goto default_case;
-	  token = G_TOKEN_HEX;
-	  ch = json_scanner_get_char (scanner, line_p, position_p);
-	  goto number_parsing;
-	  
-	case '0':
-	  if (config->scan_octal)
-	    token = G_TOKEN_OCTAL;
-	  else
-	    token = G_TOKEN_INT;
-	  ch = json_scanner_peek_next_char (scanner);
-	  if (config->scan_hex && (ch == 'x' || ch == 'X'))
-	    {
-	      token = G_TOKEN_HEX;
-	      json_scanner_get_char (scanner, line_p, position_p);
-	      ch = json_scanner_get_char (scanner, line_p, position_p);
-	      if (ch == 0)
-		{
-		  token = G_TOKEN_ERROR;
-		  value.v_error = G_ERR_UNEXP_EOF;
-		  (*position_p)++;
-		  break;
-		}
-	      if (json_scanner_char_2_num (ch, 16) < 0)
-		{
-		  token = G_TOKEN_ERROR;
-		  value.v_error = G_ERR_DIGIT_RADIX;
-		  ch = 0;
-		  break;
-		}
-	    }
-	  else if (config->scan_binary && (ch == 'b' || ch == 'B'))
-	    {
-	      token = G_TOKEN_BINARY;
-	      json_scanner_get_char (scanner, line_p, position_p);
-	      ch = json_scanner_get_char (scanner, line_p, position_p);
-	      if (ch == 0)
-		{
-		  token = G_TOKEN_ERROR;
-		  value.v_error = G_ERR_UNEXP_EOF;
-		  (*position_p)++;
-		  break;
-		}
-	      if (json_scanner_char_2_num (ch, 10) < 0)
-		{
-		  token = G_TOKEN_ERROR;
-		  value.v_error = G_ERR_NON_DIGIT_IN_CONST;
-		  ch = 0;
-		  break;
-		}
-	    }
-	  else
-	    ch = '0';
-	  /* fall through */
-	case '1':
-	case '2':
-	case '3':
-	case '4':
-	case '5':
-	case '6':
-	case '7':
-	case '8':
-	case '9':
-	number_parsing:
-	{
-          gboolean in_number = TRUE;
-	  gchar *endptr;
-	  
-	  if (token == G_TOKEN_NONE)
-	    token = G_TOKEN_INT;
-	  
-	  gstring = g_string_new (dotted_float ? "0." : "");
-	  gstring = g_string_append_c (gstring, ch);
-	  
-	  do /* while (in_number) */
-	    {
-	      gboolean is_E;
-	      
-	      is_E = token == G_TOKEN_FLOAT && (ch == 'e' || ch == 'E');
-	      
-	      ch = json_scanner_peek_next_char (scanner);
-	      
-	      if (json_scanner_char_2_num (ch, 36) >= 0 ||
-		  (config->scan_float && ch == '.') ||
-		  (is_E && (ch == '+' || ch == '-')))
-		{
-		  ch = json_scanner_get_char (scanner, line_p, position_p);
-		  
-		  switch (ch)
-		    {
-		    case '.':
-		      if (token != G_TOKEN_INT && token != G_TOKEN_OCTAL)
-			{
-			  value.v_error = token == G_TOKEN_FLOAT ? G_ERR_FLOAT_MALFORMED : G_ERR_FLOAT_RADIX;
-			  token = G_TOKEN_ERROR;
-			  in_number = FALSE;
-			}
-		      else
-			{
-			  token = G_TOKEN_FLOAT;
-			  gstring = g_string_append_c (gstring, ch);
-			}
-		      break;
-		      
-		    case '0':
-		    case '1':
-		    case '2':
-		    case '3':
-		    case '4':
-		    case '5':
-		    case '6':
-		    case '7':
-		    case '8':
-		    case '9':
-		      gstring = g_string_append_c (gstring, ch);
-		      break;
-		      
-		    case '-':
-		    case '+':
-		      if (token != G_TOKEN_FLOAT)
-			{
-			  token = G_TOKEN_ERROR;
-			  value.v_error = G_ERR_NON_DIGIT_IN_CONST;
-			  in_number = FALSE;
-			}
-		      else
-			gstring = g_string_append_c (gstring, ch);
-		      break;
-		      
-		    case 'e':
-		    case 'E':
-		      if ((token != G_TOKEN_HEX && !config->scan_float) ||
-			  (token != G_TOKEN_HEX &&
-			   token != G_TOKEN_OCTAL &&
-			   token != G_TOKEN_FLOAT &&
-			   token != G_TOKEN_INT))
-			{
-			  token = G_TOKEN_ERROR;
-			  value.v_error = G_ERR_NON_DIGIT_IN_CONST;
-			  in_number = FALSE;
-			}
-		      else
-			{
-			  if (token != G_TOKEN_HEX)
-			    token = G_TOKEN_FLOAT;
-			  gstring = g_string_append_c (gstring, ch);
-			}
-		      break;
-		      
-		    default:
-		      if (token != G_TOKEN_HEX)
-			{
-			  token = G_TOKEN_ERROR;
-			  value.v_error = G_ERR_NON_DIGIT_IN_CONST;
-			  in_number = FALSE;
-			}
-		      else
-			gstring = g_string_append_c (gstring, ch);
-		      break;
-		    }
-		}
-	      else
-		in_number = FALSE;
-	    }
-	  while (in_number);
-	  
-	  endptr = NULL;
-	  if (token == G_TOKEN_FLOAT)
-	    value.v_float = g_strtod (gstring->str, &endptr);
-	  else
-	    {
-	      guint64 ui64 = 0;
-	      switch (token)
-		{
-		case G_TOKEN_BINARY:
-		  ui64 = g_ascii_strtoull (gstring->str, &endptr, 2);
-		  break;
-		case G_TOKEN_OCTAL:
-		  ui64 = g_ascii_strtoull (gstring->str, &endptr, 8);
-		  break;
-		case G_TOKEN_INT:
-		  ui64 = g_ascii_strtoull (gstring->str, &endptr, 10);
-		  break;
-		case G_TOKEN_HEX:
-		  ui64 = g_ascii_strtoull (gstring->str, &endptr, 16);
-		  break;
-		default: ;
-		}
-	      if (scanner->config->store_int64)
-		value.v_int64 = ui64;
-	      else
-		value.v_int = ui64;
-	    }
-	  if (endptr && *endptr)
-	    {
-	      token = G_TOKEN_ERROR;
-	      if (*endptr == 'e' || *endptr == 'E')
-		value.v_error = G_ERR_NON_DIGIT_IN_CONST;
-	      else
-		value.v_error = G_ERR_DIGIT_RADIX;
-	    }
-	  g_string_free (gstring, TRUE);
-	  gstring = NULL;
-	  ch = 0;
-	} /* number_parsing:... */
-	break;
-	
-	default:
-	default_case:
-	{
-	  if (config->cpair_comment_single &&
-	      ch == config->cpair_comment_single[0])
-	    {
-	      token = G_TOKEN_COMMENT_SINGLE;
-	      in_comment_single = TRUE;
-	      gstring = g_string_new (NULL);
-	      ch = json_scanner_get_char (scanner, line_p, position_p);
-	      while (ch != 0)
-		{
-		  if (ch == config->cpair_comment_single[1])
-		    {
-		      in_comment_single = FALSE;
-		      ch = 0;
-		      break;
-		    }
-		  
-		  gstring = g_string_append_c (gstring, ch);
-		  ch = json_scanner_get_char (scanner, line_p, position_p);
-		}
-	      /* ignore a missing newline at EOF for single line comments */
-	      if (in_comment_single &&
-		  config->cpair_comment_single[1] == '\n')
-		in_comment_single = FALSE;
-	    }
-	  else if (config->scan_identifier && ch &&
-		   strchr (config->cset_identifier_first, ch))
-	    {
-	    identifier_precedence:
-	      
-	      if (config->cset_identifier_nth && ch &&
-		  strchr (config->cset_identifier_nth,
-			  json_scanner_peek_next_char (scanner)))
-		{
-		  token = G_TOKEN_IDENTIFIER;
-		  gstring = g_string_new (NULL);
-		  gstring = g_string_append_c (gstring, ch);
-		  do
-		    {
-		      ch = json_scanner_get_char (scanner, line_p, position_p);
-		      gstring = g_string_append_c (gstring, ch);
-		      ch = json_scanner_peek_next_char (scanner);
-		    }
-		  while (ch && strchr (config->cset_identifier_nth, ch));
-		  ch = 0;
-		}
-	      else if (config->scan_identifier_1char)
-		{
-		  token = G_TOKEN_IDENTIFIER;
-		  value.v_identifier = g_new0 (gchar, 2);
-		  value.v_identifier[0] = ch;
-		  ch = 0;
-		}
-	    }
-	  if (ch)
-	    {
-	      if (config->char_2_token)
-		token = ch;
-	      else
-		{
-		  token = G_TOKEN_CHAR;
-		  value.v_char = ch;
-		}
-	      ch = 0;
-	    }
-	} /* default_case:... */
-	break;
-	}
-      g_assert (ch == 0 && token != G_TOKEN_NONE); /* paranoid */
-    }
-  while (ch != 0);
-  
-  if (in_comment_multi || in_comment_single ||
-      in_string_sq || in_string_dq)
-    {
-      token = G_TOKEN_ERROR;
-      if (gstring)
-	{
-	  g_string_free (gstring, TRUE);
-	  gstring = NULL;
-	}
-      (*position_p)++;
-      if (in_comment_multi || in_comment_single)
-	value.v_error = G_ERR_UNEXP_EOF_IN_COMMENT;
-      else /* (in_string_sq || in_string_dq) */
-	value.v_error = G_ERR_UNEXP_EOF_IN_STRING;
-    }
-  
-  if (gstring)
-    {
-      value.v_string = g_string_free (gstring, FALSE);
-      gstring = NULL;
-    }
-  
-  if (token == G_TOKEN_IDENTIFIER)
-    {
-      if (config->scan_symbols)
-	{
-	  JsonScannerKey *key;
-	  guint scope_id;
-	  
-	  scope_id = scanner->scope_id;
-	  key = json_scanner_lookup_internal (scanner, scope_id, value.v_identifier);
-	  if (!key && scope_id && scanner->config->scope_0_fallback)
-	    key = json_scanner_lookup_internal (scanner, 0, value.v_identifier);
-	  
-	  if (key)
-	    {
-	      g_free (value.v_identifier);
-	      token = G_TOKEN_SYMBOL;
-	      value.v_symbol = key->value;
-	    }
-	}
-      
-      if (token == G_TOKEN_IDENTIFIER &&
-	  config->scan_identifier_NULL &&
-	  strlen (value.v_identifier) == 4)
-	{
-	  gchar *null_upper = "NULL";
-	  gchar *null_lower = "null";
-	  
-	  if (scanner->config->case_sensitive)
-	    {
-	      if (value.v_identifier[0] == null_upper[0] &&
-		  value.v_identifier[1] == null_upper[1] &&
-		  value.v_identifier[2] == null_upper[2] &&
-		  value.v_identifier[3] == null_upper[3])
-		token = G_TOKEN_IDENTIFIER_NULL;
-	    }
-	  else
-	    {
-	      if ((value.v_identifier[0] == null_upper[0] ||
-		   value.v_identifier[0] == null_lower[0]) &&
-		  (value.v_identifier[1] == null_upper[1] ||
-		   value.v_identifier[1] == null_lower[1]) &&
-		  (value.v_identifier[2] == null_upper[2] ||
-		   value.v_identifier[2] == null_lower[2]) &&
-		  (value.v_identifier[3] == null_upper[3] ||
-		   value.v_identifier[3] == null_lower[3]))
-		token = G_TOKEN_IDENTIFIER_NULL;
-	    }
-	}
-    }
-  
-  *token_p = token;
-  *value_p = value;
-}
@@ -18,15 +18,11 @@
  */
 
 /*
- * JsonScanner is a specialized tokenizer for JSON adapted from
- * the GScanner tokenizer in GLib; GScanner came with this notice:
- * 
- * Modified by the GLib Team and others 1997-2000.  See the AUTHORS
- * file for a list of people on the GLib Team.  See the ChangeLog
- * files for a list of changes.  These files are distributed with
- * GLib at ftp://ftp.gtk.org/pub/gtk/. 
- *
- * JsonScanner: modified by Emmanuele Bassi <ebassi@openedhand.com>
+ * JsonScanner is a specialized tokenizer for JSON. It started its life as
+ * a fork of the GScanner tokenizer in GLib, and it still exposes tokens as
+ * a #GTokenType and their values as a #GTokenValue; the tokenizer itself,
+ * though, only understands the JSON grammar and the "var name =" assignment
+ * extension supported by #JsonParser.
  */
 
 #ifndef __JSON_SCANNER_H__
@@ -37,7 +33,6 @@
 G_BEGIN_DECLS
 
 typedef struct _JsonScanner       JsonScanner;
-typedef struct _JsonScannerConfig JsonScannerConfig;
 
 typedef void (* JsonScannerMsgFunc) (JsonScanner *scanner,
                                      gchar       *message);
@@ -67,48 +62,58 @@ typedef enum {
 /**
  * JsonScanner:
  *
- * Tokenizer scanner for JSON. See #GScanner
+ * Tokenizer scanner for JSON.
  *
  * Since: 0.6
  */
 struct _JsonScanner
 {
   /*< private >*/
-  /* unused fields */
   gpointer user_data;
-  guint max_parse_errors;
-  
+
   /* json_scanner_error() increments this field */
   guint parse_errors;
-  
-  /* name of input stream, featured by the default message handler */
-  const gchar *input_name;
-  
-  /* quarked data */
-  GData *qdata;
-  
-  /* link into the scanner configuration */
-  JsonScannerConfig *config;
-  
+
   /* fields filled in after json_scanner_get_next_token() */
   GTokenType token;
   GTokenValue value;
   guint line;
   guint position;
-  
+
+  /* for %G_TOKEN_STRING tokens, the length of value.v_string; if the
+   * string did not contain escape sequences then value.v_string is a
+   * slice of the input text, and it is not nul-terminated
+   */
+  gsize string_len;
+  gboolean string_is_slice;
+
   /* fields filled in after json_scanner_peek_next_token() */
   GTokenType next_token;
   GTokenValue next_value;
   guint next_line;
   guint next_position;
-  
+  gsize next_string_len;
+  gboolean next_string_is_slice;
+
   /* to be considered private */
-  GHashTable *symbol_table;
   const gchar *text;
   const gchar *text_end;
-  gchar *buffer;
-  guint scope_id;
-  
+
+  /* the line of the text cursor, and where that line begins */
+  const gchar *line_start;
+  guint text_line;
+
+  /* the position of line_start on its line, if the text was given
+   * with json_scanner_input_partial_text()
+   */
+  guint line_start_position;
+
+  /* set if the input text is not valid UTF-8; the scanner validates the
+   * text while scanning it, and returns %G_TOKEN_ERROR when it finds an
+   * invalid sequence
+   */
+  gboolean invalid_data;
+
   /* handler function for _warn and _error */
   JsonScannerMsgFunc msg_handler;
 };
@@ -120,17 +125,21 @@ void         json_scanner_destroy              (JsonScanner *scanner);
 G_GNUC_INTERNAL
 void         json_scanner_input_text           (JsonScanner *scanner,
                                                 const gchar *text,
-                                                guint        text_len);
+                                                gsize        text_len);
+G_GNUC_INTERNAL
+void         json_scanner_input_partial_text   (JsonScanner *scanner,
+                                                const gchar *text,
+                                                gsize        text_len,
+                                                guint        line,
+                                                guint        position);
+G_GNUC_INTERNAL
+guint        json_scanner_get_position         (JsonScanner *scanner,
+                                                const gchar *p);
 G_GNUC_INTERNAL
 GTokenType   json_scanner_get_next_token       (JsonScanner *scanner);
 G_GNUC_INTERNAL
 GTokenType   json_scanner_peek_next_token      (JsonScanner *scanner);
 G_GNUC_INTERNAL
-void         json_scanner_scope_add_symbol     (JsonScanner *scanner,
-                                                guint        scope_id,
-                                                const gchar *symbol,
-                                                gpointer     value);
-G_GNUC_INTERNAL
 void         json_scanner_unexp_token          (JsonScanner *scanner,
                                                 GTokenType   expected_token,
                                                 const gchar *identifier_spec,
@@ -138,6 +147,8 @@ void         json_scanner_unexp_token          (JsonScanner *scanner,
                                                 const gchar *symbol_name,
                                                 const gchar *message);
 G_GNUC_INTERNAL
+const gchar *json_token_type_to_string         (guint        token);
+G_GNUC_INTERNAL
 void         json_scanner_error                (JsonScanner *scanner,
                                                 const gchar *format,
                                                 ...) G_GNUC_PRINTF (2,3);
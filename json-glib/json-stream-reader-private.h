@@ -0,0 +1,40 @@
+/* json-stream-reader-private.h - Pull parser for JSON streams, private API
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSON_STREAM_READER_PRIVATE_H__
+#define __JSON_STREAM_READER_PRIVATE_H__
+
+#include "json-stream-reader.h"
+
+G_BEGIN_DECLS
+
+G_GNUC_INTERNAL
+JsonStreamReader *      json_stream_reader_new_push     (void);
+G_GNUC_INTERNAL
+void                    json_stream_reader_push_data    (JsonStreamReader  *reader,
+                                                         const gchar       *data,
+                                                         gsize              len);
+G_GNUC_INTERNAL
+void                    json_stream_reader_push_eof     (JsonStreamReader  *reader);
+G_GNUC_INTERNAL
+JsonStreamEvent         json_stream_reader_next_pushed  (JsonStreamReader  *reader,
+                                                         GError           **error);
+
+G_END_DECLS
+
+#endif /* __JSON_STREAM_READER_PRIVATE_H__ */
@@ -0,0 +1,1291 @@
+/* json-stream-reader.c - Pull parser for JSON streams
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:json-stream-reader
+ * @Title: JsonStreamReader
+ * @short_description: A pull parser for JSON streams
+ *
+ * #JsonStreamReader reads a JSON document from a #GInputStream one chunk
+ * at a time, and returns its contents as a sequence of events, without
+ * building a tree of #JsonNode; the memory it uses depends on the size
+ * of the chunks it reads and on the size of the largest token in the
+ * stream, instead of the size of the whole document.
+ *
+ * Each call to json_stream_reader_next() returns the next event in the
+ * stream; the data associated to the event, like the name of an object
+ * member or the value of a scalar, can be retrieved using the accessor
+ * functions until the next call to json_stream_reader_next():
+ *
+ * |[<!-- language="C" -->
+ * JsonStreamReader *reader = json_stream_reader_new (stream);
+ * JsonStreamEvent event;
+ * GError *error = NULL;
+ *
+ * while ((event = json_stream_reader_next (reader, NULL, &error)) != JSON_STREAM_EVENT_END)
+ *   {
+ *     if (event == JSON_STREAM_EVENT_NONE)
+ *       {
+ *         g_printerr ("Unable to read the stream: %s\n", error->message);
+ *         g_error_free (error);
+ *         break;
+ *       }
+ *
+ *     if (event == JSON_STREAM_EVENT_MEMBER_NAME)
+ *       g_print ("member: %s\n", json_stream_reader_get_member_name (reader));
+ *   }
+ *
+ * g_object_unref (reader);
+ * ]|
+ *
+ * Errors in the JSON data are reported using the #JSON_PARSER_ERROR
+ * domain, and errors while reading the stream are reported using the
+ * #G_IO_ERROR domain; after an error, json_stream_reader_next() will
+ * keep returning the same error.
+ *
+ * #JsonStreamReader is available since JSON-GLib 1.4.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib/gi18n-lib.h>
+
+#include "json-stream-reader-private.h"
+#include "json-types-private.h"
+#include "json-debug.h"
+#include "json-parser.h"
+#include "json-scanner.h"
+
+#define DEFAULT_CHUNK_SIZE      4096
+
+typedef enum {
+  STATE_START,
+  STATE_ARRAY_START,
+  STATE_OBJECT_START,
+  STATE_MEMBER_VALUE,
+  STATE_NEXT,
+  STATE_END,
+  STATE_ERROR
+} JsonStreamReaderState;
+
+struct _JsonStreamReaderPrivate
+{
+  GInputStream *stream;
+  gsize chunk_size;
+
+  /* the unread part of the stream; the scanner sees all of it, except
+   * for a UTF-8 sequence truncated by the end of the last chunk
+   */
+  gchar *buffer;
+  gsize buffer_len;
+  gsize buffer_size;
+  gboolean eof;
+
+  JsonScanner *scanner;
+
+  /* where the current event starts, in case we need to read it again
+   * after more data has been pushed
+   */
+  const gchar *event_start;
+  guint event_line;
+  guint event_position;
+
+  JsonStreamReaderState state;
+
+  /* the open containers, as '{' or '[' */
+  GByteArray *stack;
+
+  /* the data of the current event */
+  guint token;
+  gboolean is_negative;
+  GString *string;
+
+  const gchar *source_name;
+  JsonParserError error_code;
+  GError *error;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_STREAM,
+  PROP_CHUNK_SIZE,
+
+  PROP_LAST
+};
+
+static GParamSpec *stream_reader_properties[PROP_LAST] = { NULL, };
+
+G_DEFINE_TYPE_WITH_PRIVATE (JsonStreamReader, json_stream_reader, G_TYPE_OBJECT)
+
+static void
+json_stream_reader_finalize (GObject *gobject)
+{
+  JsonStreamReaderPrivate *priv = JSON_STREAM_READER (gobject)->priv;
+
+  g_clear_object (&priv->stream);
+  g_clear_error (&priv->error);
+
+  json_scanner_destroy (priv->scanner);
+  g_free (priv->buffer);
+  g_byte_array_unref (priv->stack);
+  g_string_free (priv->string, TRUE);
+
+  G_OBJECT_CLASS (json_stream_reader_parent_class)->finalize (gobject);
+}
+
+static void
+json_stream_reader_set_property (GObject      *gobject,
+                                 guint         prop_id,
+                                 const GValue *value,
+                                 GParamSpec   *pspec)
+{
+  JsonStreamReaderPrivate *priv = JSON_STREAM_READER (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_STREAM:
+      priv->stream = g_value_dup_object (value);
+      break;
+
+    case PROP_CHUNK_SIZE:
+      priv->chunk_size = g_value_get_uint (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+json_stream_reader_get_property (GObject    *gobject,
+                                 guint       prop_id,
+                                 GValue     *value,
+                                 GParamSpec *pspec)
+{
+  JsonStreamReaderPrivate *priv = JSON_STREAM_READER (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_STREAM:
+      g_value_set_object (value, priv->stream);
+      break;
+
+    case PROP_CHUNK_SIZE:
+      g_value_set_uint (value, priv->chunk_size);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+json_stream_reader_class_init (JsonStreamReaderClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  /**
+   * JsonStreamReader:stream:
+   *
+   * The #GInputStream that the #JsonStreamReader reads.
+   *
+   * Since: 1.4
+   */
+  stream_reader_properties[PROP_STREAM] =
+    g_param_spec_object ("stream",
+                         "Stream",
+                         "The stream to read",
+                         G_TYPE_INPUT_STREAM,
+                         G_PARAM_READWRITE |
+                         G_PARAM_CONSTRUCT_ONLY |
+                         G_PARAM_STATIC_STRINGS);
+
+  /**
+   * JsonStreamReader:chunk-size:
+   *
+   * The number of bytes that the #JsonStreamReader reads from the
+   * stream at a time.
+   *
+   * Tokens that are longer than a chunk are read using multiple chunks.
+   *
+   * Since: 1.4
+   */
+  stream_reader_properties[PROP_CHUNK_SIZE] =
+    g_param_spec_uint ("chunk-size",
+                       "Chunk Size",
+                       "The number of bytes to read at a time",
+                       1, G_MAXUINT,
+                       DEFAULT_CHUNK_SIZE,
+                       G_PARAM_READWRITE |
+                       G_PARAM_CONSTRUCT_ONLY |
+                       G_PARAM_STATIC_STRINGS);
+
+  gobject_class->finalize = json_stream_reader_finalize;
+  gobject_class->set_property = json_stream_reader_set_property;
+  gobject_class->get_property = json_stream_reader_get_property;
+  g_object_class_install_properties (gobject_class, PROP_LAST, stream_reader_properties);
+}
+
+static void
+json_scanner_msg_handler (JsonScanner *scanner,
+                          gchar       *message)
+{
+  JsonStreamReaderPrivate *priv = scanner->user_data;
+
+  g_clear_error (&priv->error);
+  g_set_error (&priv->error, JSON_PARSER_ERROR,
+               priv->error_code,
+               /* translators: %s: is the file name, the first %d is the line
+                * number, the second %d is the position on the line, and %s is
+                * the error message
+                */
+               _("%s:%d:%d: Parse error: %s"),
+               priv->source_name,
+               scanner->line,
+               scanner->position,
+               message);
+}
+
+static void
+json_stream_reader_init (JsonStreamReader *self)
+{
+  JsonStreamReaderPrivate *priv;
+
+  self->priv = priv = json_stream_reader_get_instance_private (self);
+
+  priv->chunk_size = DEFAULT_CHUNK_SIZE;
+  priv->source_name = "<stream>";
+  priv->state = STATE_START;
+  priv->stack = g_byte_array_new ();
+  priv->string = g_string_new (NULL);
+
+  priv->scanner = json_scanner_new ();
+  priv->scanner->msg_handler = json_scanner_msg_handler;
+  priv->scanner->user_data = priv;
+}
+
+/**
+ * json_stream_reader_new:
+ * @stream: a #GInputStream
+ *
+ * Creates a new #JsonStreamReader, which reads the JSON document
+ * contained in @stream.
+ *
+ * Returns: (transfer full): the newly created #JsonStreamReader. Use
+ *   g_object_unref() to release the allocated resources when done
+ *
+ * Since: 1.4
+ */
+JsonStreamReader *
+json_stream_reader_new (GInputStream *stream)
+{
+  g_return_val_if_fail (G_IS_INPUT_STREAM (stream), NULL);
+
+  return g_object_new (JSON_TYPE_STREAM_READER, "stream", stream, NULL);
+}
+
+/*
+ * utf8_incomplete_tail:
+ * @data: a buffer
+ * @len: the length of @data
+ *
+ * Checks whether @data ends in the middle of a UTF-8 sequence.
+ *
+ * Returns: the number of bytes of the incomplete sequence, or 0
+ */
+static gsize
+utf8_incomplete_tail (const gchar *data,
+                      gsize        len)
+{
+  gsize i, n_bytes;
+  guchar ch;
+
+  /* look for the lead byte of the last sequence */
+  for (i = 1; i <= 3 && i <= len; i++)
+    {
+      ch = data[len - i];
+
+      if ((ch & 0xc0) != 0x80)
+        break;
+    }
+
+  if (i > 3 || i > len)
+    return 0;
+
+  if (ch >= 0xf0)
+    n_bytes = 4;
+  else if (ch >= 0xe0)
+    n_bytes = 3;
+  else if (ch >= 0xc0)
+    n_bytes = 2;
+  else
+    return 0;
+
+  /* invalid sequences are left for the scanner to find */
+  return n_bytes > i ? i : 0;
+}
+
+static void
+json_stream_reader_ensure_buffer (JsonStreamReader *reader)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+
+  if (priv->buffer != NULL)
+    return;
+
+  priv->buffer_size = priv->chunk_size;
+  priv->buffer = g_malloc (priv->buffer_size);
+  json_scanner_input_partial_text (priv->scanner, priv->buffer, 0, 1, 0);
+}
+
+/* points the scanner to the buffer, starting from @start */
+static void
+json_stream_reader_reset_scanner (JsonStreamReader *reader,
+                                  const gchar      *start,
+                                  guint             line,
+                                  guint             position)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  gsize scan_len;
+
+  scan_len = priv->buffer_len - (start - priv->buffer);
+  if (!priv->eof)
+    scan_len -= utf8_incomplete_tail (start, scan_len);
+
+  json_scanner_input_partial_text (priv->scanner, start, scan_len,
+                                   line,
+                                   position);
+}
+
+/*
+ * json_stream_reader_compact:
+ * @reader: a #JsonStreamReader
+ * @start: the position in the buffer where the scanner needs to restart
+ * @size: the number of bytes that need to be available after the data
+ *
+ * Discards the contents of the buffer before @start, and makes room for
+ * @size more bytes.
+ */
+static void
+json_stream_reader_compact (JsonStreamReader *reader,
+                            const gchar      *start,
+                            gsize             size)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  gsize keep;
+
+  keep = priv->buffer_len - (start - priv->buffer);
+  if (keep > 0 && start != priv->buffer)
+    memmove (priv->buffer, start, keep);
+
+  priv->buffer_len = keep;
+
+  if (keep + size > priv->buffer_size)
+    {
+      priv->buffer_size = MAX (keep + size, priv->buffer_size * 2);
+      priv->buffer = g_realloc (priv->buffer, priv->buffer_size);
+    }
+}
+
+/*
+ * json_stream_reader_fill:
+ * @reader: a #JsonStreamReader
+ * @start: the position in the buffer where the scanner needs to restart
+ * @line: the line of @start
+ * @position: the position of @start on its line
+ *
+ * Discards the contents of the buffer before @start, and appends a new
+ * chunk read from the stream; the scanner is reset to @start.
+ *
+ * Returns: %TRUE on success, and %FALSE if reading the stream failed
+ */
+static gboolean
+json_stream_reader_fill (JsonStreamReader  *reader,
+                         const gchar       *start,
+                         guint              line,
+                         guint              position,
+                         GCancellable      *cancellable,
+                         GError           **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  gsize read_size;
+  gboolean retval = TRUE;
+  gssize res;
+
+  /* tokens longer than a chunk are scanned again after every read, so
+   * we read at least as much as we kept, to avoid a quadratic cost
+   */
+  read_size = MAX (priv->chunk_size, priv->buffer_len - (start - priv->buffer));
+
+  json_stream_reader_compact (reader, start, read_size);
+
+  res = g_input_stream_read (priv->stream,
+                             priv->buffer + priv->buffer_len, read_size,
+                             cancellable,
+                             error);
+
+  /* the scanner is reset even on failure, as it must not point to
+   * the data that was moved
+   */
+  if (res < 0)
+    retval = FALSE;
+
+  if (res <= 0)
+    {
+      res = 0;
+      priv->eof = TRUE;
+    }
+
+  priv->buffer_len += res;
+
+  json_stream_reader_reset_scanner (reader, priv->buffer, line, position);
+
+  return retval;
+}
+
+/*
+ * json_stream_reader_get_token:
+ * @reader: a #JsonStreamReader
+ *
+ * Reads the next token, refilling the buffer if the token reaches the
+ * end of the data read so far, as it may continue in the next chunk.
+ *
+ * A minus sign and the number that follows it are read as a single
+ * token, with the is_negative field set.
+ *
+ * Returns: the token, or %G_TOKEN_NONE if reading the stream failed, or
+ *   if the reader has no stream and it needs more data to be pushed
+ */
+static GTokenType
+json_stream_reader_get_token (JsonStreamReader  *reader,
+                              GCancellable      *cancellable,
+                              GError           **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+
+  while (TRUE)
+    {
+      const gchar *start = scanner->text;
+      guint line = scanner->text_line;
+      guint position = json_scanner_get_position (scanner, start);
+      GTokenType token;
+
+      priv->is_negative = FALSE;
+
+      token = json_scanner_get_next_token (scanner);
+      if (token == '-')
+        {
+          token = json_scanner_get_next_token (scanner);
+          if (token == G_TOKEN_INT || token == G_TOKEN_FLOAT)
+            priv->is_negative = TRUE;
+          else
+            token = '-';
+        }
+
+      if (scanner->text < scanner->text_end || priv->eof)
+        return token;
+
+      /* only numbers and barewords can continue after the end of the
+       * data; strings are complete once we find the closing quote
+       */
+      switch ((guint) token)
+        {
+        case G_TOKEN_LEFT_CURLY:
+        case G_TOKEN_RIGHT_CURLY:
+        case G_TOKEN_LEFT_BRACE:
+        case G_TOKEN_RIGHT_BRACE:
+        case G_TOKEN_COMMA:
+        case ':':
+        case G_TOKEN_STRING:
+          return token;
+
+        default:
+          break;
+        }
+
+      if (priv->stream == NULL)
+        return G_TOKEN_NONE;
+
+      if (!json_stream_reader_fill (reader, start, line, position,
+                                    cancellable,
+                                    error))
+        return G_TOKEN_NONE;
+    }
+}
+
+static JsonStreamEvent
+json_stream_reader_token_failed (JsonStreamReader *reader,
+                                 GError           *internal_error,
+                                 GError          **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+
+  /* without an error, we need more data to be pushed; the event is
+   * going to be read again from its beginning
+   */
+  if (internal_error == NULL)
+    {
+      json_stream_reader_reset_scanner (reader,
+                                        priv->event_start,
+                                        priv->event_line,
+                                        priv->event_position);
+      return JSON_STREAM_EVENT_NONE;
+    }
+
+  priv->state = STATE_ERROR;
+  priv->error = g_error_copy (internal_error);
+  g_propagate_error (error, internal_error);
+
+  return JSON_STREAM_EVENT_NONE;
+}
+
+static JsonStreamEvent
+json_stream_reader_set_error (JsonStreamReader *reader,
+                              JsonParserError   error_code,
+                              guint             expected_token,
+                              GError          **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+
+  if (scanner->invalid_data)
+    {
+      g_clear_error (&priv->error);
+      priv->error = g_error_new_literal (JSON_PARSER_ERROR,
+                                         JSON_PARSER_ERROR_INVALID_DATA,
+                                         _("JSON data must be UTF-8 encoded"));
+    }
+  else
+    {
+      const gchar *symbol_name = NULL;
+      gchar *msg = NULL;
+
+      if (expected_token > JSON_TOKEN_INVALID &&
+          expected_token < JSON_TOKEN_LAST)
+        {
+          symbol_name = json_token_type_to_string (expected_token);
+          msg = g_strconcat ("e.g. '", symbol_name, "'", NULL);
+        }
+
+      if ((guint) scanner->token > JSON_TOKEN_INVALID &&
+          (guint) scanner->token < JSON_TOKEN_LAST)
+        {
+          symbol_name = json_token_type_to_string (scanner->token);
+          if (symbol_name == NULL)
+            symbol_name = "???";
+        }
+
+      /* the message handler stores the error */
+      priv->error_code = error_code;
+      json_scanner_unexp_token (scanner, expected_token,
+                                NULL, "value",
+                                symbol_name, msg);
+
+      g_free (msg);
+    }
+
+  priv->state = STATE_ERROR;
+
+  g_propagate_error (error, g_error_copy (priv->error));
+
+  return JSON_STREAM_EVENT_NONE;
+}
+
+/* reads a value, after its first token */
+static JsonStreamEvent
+json_stream_reader_read_value (JsonStreamReader  *reader,
+                               GTokenType         token,
+                               GError           **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+
+  switch ((guint) token)
+    {
+    case G_TOKEN_LEFT_CURLY:
+      g_byte_array_append (priv->stack, (const guint8 *) "{", 1);
+      priv->token = G_TOKEN_NONE;
+      priv->state = STATE_OBJECT_START;
+      return JSON_STREAM_EVENT_START_OBJECT;
+
+    case G_TOKEN_LEFT_BRACE:
+      g_byte_array_append (priv->stack, (const guint8 *) "[", 1);
+      priv->token = G_TOKEN_NONE;
+      priv->state = STATE_ARRAY_START;
+      return JSON_STREAM_EVENT_START_ARRAY;
+
+    case G_TOKEN_STRING:
+      g_string_truncate (priv->string, 0);
+      g_string_append_len (priv->string,
+                           scanner->value.v_string,
+                           scanner->string_len);
+      /* fall through */
+    case G_TOKEN_INT:
+    case G_TOKEN_FLOAT:
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+    case JSON_TOKEN_NULL:
+      priv->token = token;
+      priv->state = STATE_NEXT;
+      return JSON_STREAM_EVENT_VALUE;
+
+    case '-':
+      return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_PARSE,
+                                           G_TOKEN_INT,
+                                           error);
+
+    case G_TOKEN_IDENTIFIER:
+      return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_INVALID_BAREWORD,
+                                           G_TOKEN_SYMBOL,
+                                           error);
+
+    default:
+      if (priv->stack->len == 0)
+        return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_INVALID_BAREWORD,
+                                             G_TOKEN_SYMBOL,
+                                             error);
+
+      return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_PARSE,
+                                           priv->stack->data[priv->stack->len - 1] == '{'
+                                             ? G_TOKEN_RIGHT_CURLY
+                                             : G_TOKEN_RIGHT_BRACE,
+                                           error);
+    }
+}
+
+/* reads a member name, after its first token */
+static JsonStreamEvent
+json_stream_reader_read_member_name (JsonStreamReader  *reader,
+                                     GTokenType         token,
+                                     GError           **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+
+  if (token != G_TOKEN_STRING)
+    return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_INVALID_BAREWORD,
+                                         G_TOKEN_STRING,
+                                         error);
+
+  g_string_truncate (priv->string, 0);
+  g_string_append_len (priv->string,
+                       scanner->value.v_string,
+                       scanner->string_len);
+
+  priv->token = G_TOKEN_NONE;
+  priv->state = STATE_MEMBER_VALUE;
+
+  return JSON_STREAM_EVENT_MEMBER_NAME;
+}
+
+static JsonStreamEvent
+json_stream_reader_read_event (JsonStreamReader  *reader,
+                               GCancellable      *cancellable,
+                               GError           **error)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+  GTokenType token;
+  GError *internal_error = NULL;
+
+  if (priv->state == STATE_ERROR)
+    {
+      g_propagate_error (error, g_error_copy (priv->error));
+      return JSON_STREAM_EVENT_NONE;
+    }
+
+  if (priv->state == STATE_END)
+    return JSON_STREAM_EVENT_END;
+
+  json_stream_reader_ensure_buffer (reader);
+
+  priv->event_start = scanner->text;
+  priv->event_line = scanner->text_line;
+  priv->event_position = json_scanner_get_position (scanner, scanner->text);
+
+  token = json_stream_reader_get_token (reader, cancellable, &internal_error);
+  if (token == G_TOKEN_NONE)
+    return json_stream_reader_token_failed (reader, internal_error, error);
+
+  if (token == G_TOKEN_ERROR)
+    return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_PARSE,
+                                         G_TOKEN_NONE,
+                                         error);
+
+  switch (priv->state)
+    {
+    case STATE_START:
+      /* like JsonParser, we accept empty documents */
+      if (token == G_TOKEN_EOF)
+        {
+          priv->state = STATE_END;
+          return JSON_STREAM_EVENT_END;
+        }
+
+      return json_stream_reader_read_value (reader, token, error);
+
+    case STATE_ARRAY_START:
+      if (token == G_TOKEN_RIGHT_BRACE)
+        break;
+
+      return json_stream_reader_read_value (reader, token, error);
+
+    case STATE_OBJECT_START:
+      if (token == G_TOKEN_RIGHT_CURLY)
+        break;
+
+      return json_stream_reader_read_member_name (reader, token, error);
+
+    case STATE_MEMBER_VALUE:
+      if (token != ':')
+        return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_MISSING_COLON,
+                                             ':',
+                                             error);
+
+      token = json_stream_reader_get_token (reader, cancellable, &internal_error);
+      if (token == G_TOKEN_NONE)
+        return json_stream_reader_token_failed (reader, internal_error, error);
+
+      return json_stream_reader_read_value (reader, token, error);
+
+    case STATE_NEXT:
+      if (priv->stack->len == 0)
+        {
+          if (token != G_TOKEN_EOF)
+            return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_PARSE,
+                                                 G_TOKEN_EOF,
+                                                 error);
+
+          priv->state = STATE_END;
+          return JSON_STREAM_EVENT_END;
+        }
+
+      if (priv->stack->data[priv->stack->len - 1] == '[')
+        {
+          if (token == G_TOKEN_RIGHT_BRACE)
+            break;
+
+          if (token != G_TOKEN_COMMA)
+            return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_MISSING_COMMA,
+                                                 G_TOKEN_COMMA,
+                                                 error);
+
+          token = json_stream_reader_get_token (reader, cancellable, &internal_error);
+          if (token == G_TOKEN_NONE)
+            return json_stream_reader_token_failed (reader, internal_error, error);
+
+          if (token == G_TOKEN_RIGHT_BRACE)
+            return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_TRAILING_COMMA,
+                                                 G_TOKEN_RIGHT_BRACE,
+                                                 error);
+
+          return json_stream_reader_read_value (reader, token, error);
+        }
+      else
+        {
+          if (token == G_TOKEN_RIGHT_CURLY)
+            break;
+
+          if (token != G_TOKEN_COMMA)
+            return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_MISSING_COMMA,
+                                                 G_TOKEN_COMMA,
+                                                 error);
+
+          token = json_stream_reader_get_token (reader, cancellable, &internal_error);
+          if (token == G_TOKEN_NONE)
+            return json_stream_reader_token_failed (reader, internal_error, error);
+
+          if (token == G_TOKEN_RIGHT_CURLY)
+            return json_stream_reader_set_error (reader, JSON_PARSER_ERROR_TRAILING_COMMA,
+                                                 G_TOKEN_STRING,
+                                                 error);
+
+          return json_stream_reader_read_member_name (reader, token, error);
+        }
+
+    case STATE_END:
+    case STATE_ERROR:
+    default:
+      g_assert_not_reached ();
+    }
+
+  /* the end of the current container */
+  g_byte_array_set_size (priv->stack, priv->stack->len - 1);
+  priv->token = G_TOKEN_NONE;
+  priv->state = STATE_NEXT;
+
+  return token == G_TOKEN_RIGHT_CURLY ? JSON_STREAM_EVENT_END_OBJECT
+                                      : JSON_STREAM_EVENT_END_ARRAY;
+}
+
+/**
+ * json_stream_reader_next:
+ * @reader: a #JsonStreamReader
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Reads the next event from the stream, reading more data from the
+ * stream if needed.
+ *
+ * Once the whole JSON document has been read, this function returns
+ * %JSON_STREAM_EVENT_END; any data following the document, except for
+ * whitespace, is an error.
+ *
+ * Returns: the next event, or %JSON_STREAM_EVENT_NONE in case of error
+ *
+ * Since: 1.4
+ */
+JsonStreamEvent
+json_stream_reader_next (JsonStreamReader  *reader,
+                         GCancellable      *cancellable,
+                         GError           **error)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), JSON_STREAM_EVENT_NONE);
+  g_return_val_if_fail (reader->priv->stream != NULL, JSON_STREAM_EVENT_NONE);
+
+  return json_stream_reader_read_event (reader, cancellable, error);
+}
+
+/*< private >
+ * json_stream_reader_new_push:
+ *
+ * Creates a #JsonStreamReader without a stream; the data is given
+ * to the reader using json_stream_reader_push_data(), and the events
+ * are read using json_stream_reader_next_pushed().
+ *
+ * Returns: (transfer full): the newly created #JsonStreamReader
+ */
+JsonStreamReader *
+json_stream_reader_new_push (void)
+{
+  JsonStreamReader *reader;
+
+  reader = g_object_new (JSON_TYPE_STREAM_READER, NULL);
+  reader->priv->source_name = "<data>";
+
+  return reader;
+}
+
+/*< private >
+ * json_stream_reader_push_data:
+ * @reader: a #JsonStreamReader created with json_stream_reader_new_push()
+ * @data: the data to append
+ * @len: the length of @data
+ *
+ * Appends @data to the data to be read. The reader keeps a copy of the
+ * data that it has not turned into events yet, so @data can be released
+ * after this function returns.
+ */
+void
+json_stream_reader_push_data (JsonStreamReader *reader,
+                              const gchar      *data,
+                              gsize             len)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+  const gchar *start;
+  guint line, position;
+
+  g_return_if_fail (priv->stream == NULL);
+  g_return_if_fail (!priv->eof);
+
+  json_stream_reader_ensure_buffer (reader);
+
+  start = scanner->text;
+  line = scanner->text_line;
+  position = json_scanner_get_position (scanner, start);
+
+  json_stream_reader_compact (reader, start, len);
+
+  memcpy (priv->buffer + priv->buffer_len, data, len);
+  priv->buffer_len += len;
+
+  json_stream_reader_reset_scanner (reader, priv->buffer, line, position);
+}
+
+/*< private >
+ * json_stream_reader_push_eof:
+ * @reader: a #JsonStreamReader created with json_stream_reader_new_push()
+ *
+ * Marks the end of the data; the events that were waiting for more
+ * data are completed, or turned into errors.
+ */
+void
+json_stream_reader_push_eof (JsonStreamReader *reader)
+{
+  JsonStreamReaderPrivate *priv = reader->priv;
+  JsonScanner *scanner = priv->scanner;
+
+  g_return_if_fail (priv->stream == NULL);
+
+  json_stream_reader_ensure_buffer (reader);
+
+  priv->eof = TRUE;
+
+  json_stream_reader_reset_scanner (reader,
+                                    scanner->text,
+                                    scanner->text_line,
+                                    json_scanner_get_position (scanner, scanner->text));
+}
+
+/*< private >
+ * json_stream_reader_next_pushed:
+ * @reader: a #JsonStreamReader created with json_stream_reader_new_push()
+ * @error: return location for a #GError, or %NULL
+ *
+ * Reads the next event from the data pushed so far.
+ *
+ * Returns: the next event; %JSON_STREAM_EVENT_NONE with @error set in
+ *   case of error, or %JSON_STREAM_EVENT_NONE without an error if the
+ *   reader needs more data
+ */
+JsonStreamEvent
+json_stream_reader_next_pushed (JsonStreamReader  *reader,
+                                GError           **error)
+{
+  g_return_val_if_fail (reader->priv->stream == NULL, JSON_STREAM_EVENT_NONE);
+
+  return json_stream_reader_read_event (reader, NULL, error);
+}
+
+/**
+ * json_stream_reader_get_depth:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the number of arrays and objects that contain the current
+ * position of the reader.
+ *
+ * After a %JSON_STREAM_EVENT_START_OBJECT or %JSON_STREAM_EVENT_START_ARRAY
+ * event the depth includes the container that was just opened, and after
+ * a %JSON_STREAM_EVENT_END_OBJECT or %JSON_STREAM_EVENT_END_ARRAY event it
+ * does not include the container that was just closed.
+ *
+ * Returns: the current depth
+ *
+ * Since: 1.4
+ */
+guint
+json_stream_reader_get_depth (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), 0);
+
+  return reader->priv->stack->len;
+}
+
+/**
+ * json_stream_reader_get_member_name:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the name of the object member read by the last call to
+ * json_stream_reader_next().
+ *
+ * Returns: (nullable) (transfer none): the name of the member, or %NULL
+ *   if the last event was not %JSON_STREAM_EVENT_MEMBER_NAME. The string
+ *   is owned by the #JsonStreamReader and it is only valid until the next
+ *   call to json_stream_reader_next()
+ *
+ * Since: 1.4
+ */
+const gchar *
+json_stream_reader_get_member_name (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), NULL);
+
+  if (reader->priv->state != STATE_MEMBER_VALUE)
+    return NULL;
+
+  return reader->priv->string->str;
+}
+
+static inline gboolean
+json_stream_reader_has_value (JsonStreamReader *reader)
+{
+  return reader->priv->state == STATE_NEXT &&
+         reader->priv->token != G_TOKEN_NONE;
+}
+
+/**
+ * json_stream_reader_get_value_type:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the #GType of the value read by the last call to
+ * json_stream_reader_next(), using the same types as
+ * json_node_get_value_type().
+ *
+ * Returns: the type of the value; %G_TYPE_INVALID if the value is
+ *   null, or if the last event was not %JSON_STREAM_EVENT_VALUE
+ *
+ * Since: 1.4
+ */
+GType
+json_stream_reader_get_value_type (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), G_TYPE_INVALID);
+
+  if (!json_stream_reader_has_value (reader))
+    return G_TYPE_INVALID;
+
+  switch ((guint) reader->priv->token)
+    {
+    case G_TOKEN_INT:
+      return G_TYPE_INT64;
+
+    case G_TOKEN_FLOAT:
+      return G_TYPE_DOUBLE;
+
+    case G_TOKEN_STRING:
+      return G_TYPE_STRING;
+
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+      return G_TYPE_BOOLEAN;
+
+    default:
+      return G_TYPE_INVALID;
+    }
+}
+
+/**
+ * json_stream_reader_get_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Creates a #JsonNode holding the value read by the last call to
+ * json_stream_reader_next().
+ *
+ * Returns: (nullable) (transfer full): a new #JsonNode, or %NULL if the
+ *   last event was not %JSON_STREAM_EVENT_VALUE. Use json_node_unref()
+ *   to free the returned node
+ *
+ * Since: 1.4
+ */
+JsonNode *
+json_stream_reader_get_value (JsonStreamReader *reader)
+{
+  JsonNode *node;
+
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), NULL);
+
+  if (!json_stream_reader_has_value (reader))
+    return NULL;
+
+  switch ((guint) reader->priv->token)
+    {
+    case G_TOKEN_INT:
+      node = json_node_init_int (json_node_alloc (),
+                                 json_stream_reader_get_int_value (reader));
+      break;
+
+    case G_TOKEN_FLOAT:
+      node = json_node_init_double (json_node_alloc (),
+                                    json_stream_reader_get_double_value (reader));
+      break;
+
+    case G_TOKEN_STRING:
+      node = json_node_init_string (json_node_alloc (),
+                                    reader->priv->string->str);
+      break;
+
+    case JSON_TOKEN_TRUE:
+    case JSON_TOKEN_FALSE:
+      node = json_node_init_boolean (json_node_alloc (),
+                                     reader->priv->token == JSON_TOKEN_TRUE);
+      break;
+
+    default:
+      node = json_node_init_null (json_node_alloc ());
+      break;
+    }
+
+  return node;
+}
+
+/**
+ * json_stream_reader_get_int_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the integer value read by the last call to
+ * json_stream_reader_next().
+ *
+ * Returns: the integer value, or 0 if the value is not an integer
+ *
+ * Since: 1.4
+ */
+gint64
+json_stream_reader_get_int_value (JsonStreamReader *reader)
+{
+  JsonScanner *scanner;
+
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), 0);
+
+  if (!json_stream_reader_has_value (reader) ||
+      reader->priv->token != G_TOKEN_INT)
+    return 0;
+
+  scanner = reader->priv->scanner;
+
+  return reader->priv->is_negative ? scanner->value.v_int64 * -1
+                                   : scanner->value.v_int64;
+}
+
+/**
+ * json_stream_reader_get_double_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the floating point value read by the last call to
+ * json_stream_reader_next(); integer values are converted.
+ *
+ * Returns: the floating point value, or 0.0 if the value is not a number
+ *
+ * Since: 1.4
+ */
+gdouble
+json_stream_reader_get_double_value (JsonStreamReader *reader)
+{
+  JsonScanner *scanner;
+
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), 0.0);
+
+  if (!json_stream_reader_has_value (reader))
+    return 0.0;
+
+  scanner = reader->priv->scanner;
+
+  if (reader->priv->token == G_TOKEN_INT)
+    return json_stream_reader_get_int_value (reader);
+
+  if (reader->priv->token != G_TOKEN_FLOAT)
+    return 0.0;
+
+  return reader->priv->is_negative ? scanner->value.v_float * -1.0
+                                   : scanner->value.v_float;
+}
+
+/**
+ * json_stream_reader_get_string_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the string value read by the last call to
+ * json_stream_reader_next().
+ *
+ * Returns: (nullable) (transfer none): the string value, or %NULL if
+ *   the value is not a string. The string is owned by the
+ *   #JsonStreamReader and it is only valid until the next call to
+ *   json_stream_reader_next()
+ *
+ * Since: 1.4
+ */
+const gchar *
+json_stream_reader_get_string_value (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), NULL);
+
+  if (!json_stream_reader_has_value (reader) ||
+      reader->priv->token != G_TOKEN_STRING)
+    return NULL;
+
+  return reader->priv->string->str;
+}
+
+/**
+ * json_stream_reader_get_boolean_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the boolean value read by the last call to
+ * json_stream_reader_next().
+ *
+ * Returns: the boolean value, or %FALSE if the value is not a boolean
+ *
+ * Since: 1.4
+ */
+gboolean
+json_stream_reader_get_boolean_value (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), FALSE);
+
+  if (!json_stream_reader_has_value (reader))
+    return FALSE;
+
+  return reader->priv->token == JSON_TOKEN_TRUE;
+}
+
+/**
+ * json_stream_reader_get_null_value:
+ * @reader: a #JsonStreamReader
+ *
+ * Checks whether the value read by the last call to
+ * json_stream_reader_next() is null.
+ *
+ * Returns: %TRUE if the value is null
+ *
+ * Since: 1.4
+ */
+gboolean
+json_stream_reader_get_null_value (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), FALSE);
+
+  if (!json_stream_reader_has_value (reader))
+    return FALSE;
+
+  return reader->priv->token == JSON_TOKEN_NULL;
+}
+
+/**
+ * json_stream_reader_get_current_line:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the line of the last token read by @reader, starting
+ * from 1.
+ *
+ * Returns: the current line
+ *
+ * Since: 1.4
+ */
+guint
+json_stream_reader_get_current_line (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), 0);
+
+  return reader->priv->scanner->line;
+}
+
+/**
+ * json_stream_reader_get_current_pos:
+ * @reader: a #JsonStreamReader
+ *
+ * Retrieves the position, on the current line, of the end of the last
+ * token read by @reader.
+ *
+ * Returns: the current position on the line
+ *
+ * Since: 1.4
+ */
+guint
+json_stream_reader_get_current_pos (JsonStreamReader *reader)
+{
+  g_return_val_if_fail (JSON_IS_STREAM_READER (reader), 0);
+
+  return reader->priv->scanner->position;
+}
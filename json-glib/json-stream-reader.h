@@ -0,0 +1,145 @@
+/* json-stream-reader.h - Pull parser for JSON streams
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSON_STREAM_READER_H__
+#define __JSON_STREAM_READER_H__
+
+#if !defined(__JSON_GLIB_INSIDE__) && !defined(JSON_COMPILATION)
+#error "Only <json-glib/json-glib.h> can be included directly."
+#endif
+
+#include <json-glib/json-types.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define JSON_TYPE_STREAM_READER                 (json_stream_reader_get_type ())
+#define JSON_STREAM_READER(obj)                 (G_TYPE_CHECK_INSTANCE_CAST ((obj), JSON_TYPE_STREAM_READER, JsonStreamReader))
+#define JSON_IS_STREAM_READER(obj)              (G_TYPE_CHECK_INSTANCE_TYPE ((obj), JSON_TYPE_STREAM_READER))
+#define JSON_STREAM_READER_CLASS(klass)         (G_TYPE_CHECK_CLASS_CAST ((klass), JSON_TYPE_STREAM_READER, JsonStreamReaderClass))
+#define JSON_IS_STREAM_READER_CLASS(klass)      (G_TYPE_CHECK_CLASS_TYPE ((klass), JSON_TYPE_STREAM_READER))
+#define JSON_STREAM_READER_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), JSON_TYPE_STREAM_READER, JsonStreamReaderClass))
+
+typedef struct _JsonStreamReader                JsonStreamReader;
+typedef struct _JsonStreamReaderPrivate         JsonStreamReaderPrivate;
+typedef struct _JsonStreamReaderClass           JsonStreamReaderClass;
+
+/**
+ * JsonStreamEvent:
+ * @JSON_STREAM_EVENT_NONE: no event; returned in case of error
+ * @JSON_STREAM_EVENT_START_OBJECT: the start of an object
+ * @JSON_STREAM_EVENT_END_OBJECT: the end of an object
+ * @JSON_STREAM_EVENT_MEMBER_NAME: the name of an object member; the
+ *   event for the value of the member follows
+ * @JSON_STREAM_EVENT_START_ARRAY: the start of an array
+ * @JSON_STREAM_EVENT_END_ARRAY: the end of an array
+ * @JSON_STREAM_EVENT_VALUE: a scalar value, or null
+ * @JSON_STREAM_EVENT_END: the end of the stream
+ *
+ * The events returned by json_stream_reader_next().
+ *
+ * Since: 1.4
+ */
+typedef enum {
+  JSON_STREAM_EVENT_NONE,
+  JSON_STREAM_EVENT_START_OBJECT,
+  JSON_STREAM_EVENT_END_OBJECT,
+  JSON_STREAM_EVENT_MEMBER_NAME,
+  JSON_STREAM_EVENT_START_ARRAY,
+  JSON_STREAM_EVENT_END_ARRAY,
+  JSON_STREAM_EVENT_VALUE,
+  JSON_STREAM_EVENT_END
+} JsonStreamEvent;
+
+/**
+ * JsonStreamReader:
+ *
+ * The `JsonStreamReader` structure contains only private data and should
+ * be accessed using the provided API
+ *
+ * Since: 1.4
+ */
+struct _JsonStreamReader
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  JsonStreamReaderPrivate *priv;
+};
+
+/**
+ * JsonStreamReaderClass:
+ *
+ * The `JsonStreamReaderClass` structure contains only private data
+ *
+ * Since: 1.4
+ */
+struct _JsonStreamReaderClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  void (*_json_padding0) (void);
+  void (*_json_padding1) (void);
+  void (*_json_padding2) (void);
+  void (*_json_padding3) (void);
+};
+
+JSON_AVAILABLE_IN_1_4
+GType json_stream_reader_get_type (void) G_GNUC_CONST;
+
+JSON_AVAILABLE_IN_1_4
+JsonStreamReader *     json_stream_reader_new                (GInputStream      *stream);
+
+JSON_AVAILABLE_IN_1_4
+JsonStreamEvent        json_stream_reader_next               (JsonStreamReader  *reader,
+                                                              GCancellable      *cancellable,
+                                                              GError           **error);
+JSON_AVAILABLE_IN_1_4
+guint                  json_stream_reader_get_depth          (JsonStreamReader  *reader);
+
+JSON_AVAILABLE_IN_1_4
+const gchar *          json_stream_reader_get_member_name    (JsonStreamReader  *reader);
+
+JSON_AVAILABLE_IN_1_4
+GType                  json_stream_reader_get_value_type     (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+JsonNode *             json_stream_reader_get_value          (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+gint64                 json_stream_reader_get_int_value      (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+gdouble                json_stream_reader_get_double_value   (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+const gchar *          json_stream_reader_get_string_value   (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+gboolean               json_stream_reader_get_boolean_value  (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+gboolean               json_stream_reader_get_null_value     (JsonStreamReader  *reader);
+
+JSON_AVAILABLE_IN_1_4
+guint                  json_stream_reader_get_current_line   (JsonStreamReader  *reader);
+JSON_AVAILABLE_IN_1_4
+guint                  json_stream_reader_get_current_pos    (JsonStreamReader  *reader);
+
+#ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonStreamReader, g_object_unref)
+#endif
+
+G_END_DECLS
+
+#endif /* __JSON_STREAM_READER_H__ */
@@ -34,7 +34,25 @@ G_BEGIN_DECLS
    (n)->type <= JSON_NODE_NULL && \
    (n)->ref_count >= 1)
 
-typedef struct _JsonValue JsonValue;
+/* the tags of the threads using thread-local documents */
+#define JSON_THREAD_TAG_MASK    0xffff
+
+/* asserts that the thread-local data at @ptr is used from the thread
+ * with tag @owner; this is only checked in debug builds, as it would
+ * cost more than the atomic operations that thread-local data avoids
+ */
+#ifdef JSON_ENABLE_DEBUG
+#define JSON_CHECK_THREAD(owner,ptr)    G_STMT_START {                  \
+        if (G_UNLIKELY ((owner) != json_thread_get_tag ()))             \
+          g_error ("%s: thread-local data %p used from another thread", \
+                   G_STRLOC, (gconstpointer) (ptr));                    \
+                                        } G_STMT_END
+#else
+#define JSON_CHECK_THREAD(owner,ptr)    G_STMT_START { } G_STMT_END
+#endif
+
+typedef struct _JsonArena JsonArena;
+typedef struct _JsonKeyTable JsonKeyTable;
 
 typedef enum {
   JSON_VALUE_INVALID = 0,
@@ -45,76 +63,150 @@ typedef enum {
   JSON_VALUE_NULL
 } JsonValueType;
 
+/* strings up to this size, including the terminating nul, are stored
+ * inside the node
+ */
+#define JSON_NODE_INLINE_STRING_SIZE    16
+
 struct _JsonNode
 {
   /*< private >*/
-  JsonNodeType type;
-
   volatile gint ref_count;
-  gboolean immutable : 1;
-  gboolean allocated : 1;
 
+  guint type : 3;               /* JsonNodeType */
+  guint value_type : 3;         /* JsonValueType, for JSON_NODE_VALUE */
+  guint immutable : 1;
+  guint allocated : 1;
+  guint in_arena : 1;
+  guint string_inline : 1;
+  guint cow : 1;                /* the container may be shared */
+  guint thread_local : 1;       /* the reference count is not atomic */
+  guint owner : 16;             /* the tag of the thread using the node */
+
+  /* scalar values are stored inside the node; strings that do not fit
+   * in v_inline are allocated separately, from the arena of the node if
+   * it has one
+   */
   union {
     JsonObject *object;
     JsonArray *array;
-    JsonValue *value;
+    gint64 v_int;
+    gdouble v_double;
+    gboolean v_bool;
+    gchar *v_str;
+    gchar v_inline[JSON_NODE_INLINE_STRING_SIZE];
   } data;
 
   JsonNode *parent;
 };
 
-#define JSON_VALUE_INIT                 { JSON_VALUE_INVALID, 1, FALSE, { 0 }, NULL }
-#define JSON_VALUE_INIT_TYPE(t)         { (t), 1, FALSE, { 0 }, NULL }
-#define JSON_VALUE_IS_VALID(v)          ((v) != NULL && (v)->type != JSON_VALUE_INVALID)
-#define JSON_VALUE_HOLDS(v,t)           ((v) != NULL && (v)->type == (t))
-#define JSON_VALUE_HOLDS_INT(v)         (JSON_VALUE_HOLDS((v), JSON_VALUE_INT))
-#define JSON_VALUE_HOLDS_DOUBLE(v)      (JSON_VALUE_HOLDS((v), JSON_VALUE_DOUBLE))
-#define JSON_VALUE_HOLDS_BOOLEAN(v)     (JSON_VALUE_HOLDS((v), JSON_VALUE_BOOLEAN))
-#define JSON_VALUE_HOLDS_STRING(v)      (JSON_VALUE_HOLDS((v), JSON_VALUE_STRING))
-#define JSON_VALUE_HOLDS_NULL(v)        (JSON_VALUE_HOLDS((v), JSON_VALUE_NULL))
-#define JSON_VALUE_TYPE(v)              (json_value_type((v)))
-
-struct _JsonValue
-{
-  JsonValueType type;
+#define JSON_NODE_HOLDS_VALUE_TYPE(n,t) \
+  ((n)->type == JSON_NODE_VALUE && (n)->value_type == (t))
 
-  volatile gint ref_count;
-  gboolean immutable : 1;
+#define JSON_NODE_PEEK_STRING(n) \
+  ((n)->string_inline ? (const gchar *) (n)->data.v_inline : (const gchar *) (n)->data.v_str)
 
-  union {
-    gint64 v_int;
-    gdouble v_double;
-    gboolean v_bool;
-    gchar *v_str;
-  } data;
-};
+typedef enum {
+  JSON_ARRAY_STORAGE_NODES = 0,
+  JSON_ARRAY_STORAGE_INT,
+  JSON_ARRAY_STORAGE_DOUBLE
+} JsonArrayStorage;
+
+/* the size of a container once generated, cached on immutable containers
+ * by json_generator_get_size_hint(); pretty printing adds @lines bytes of
+ * newlines and separators, plus the indentation of @weight lines, whose
+ * depths relative to the container add up to @depth
+ */
+typedef struct
+{
+  gsize size;
+  gsize lines;
+  gsize weight;
+  gsize depth;
+} JsonSizeHint;
 
 struct _JsonArray
 {
+  /* the elements of the array, unless they are packed */
   GPtrArray *elements;
 
+  /* arrays holding only integers, or only doubles, keep their values in
+   * a contiguous buffer; the nodes of the elements are created when they
+   * are requested, and cached in @nodes
+   */
+  union {
+    gpointer data;
+    gint64 *v_int;
+    gdouble *v_double;
+  } packed;
+  guint packed_len;
+  guint packed_size;
+  JsonNode **nodes;
+
+  /* the parent of the nodes created on demand */
+  JsonNode *parent;
+
   guint immutable_hash;  /* valid iff immutable */
+  JsonSizeHint size_hint;  /* valid iff size_hint_valid */
+  volatile gint size_hint_valid;
   volatile gint ref_count;
+  guint storage : 2;     /* JsonArrayStorage */
   gboolean immutable : 1;
+  gboolean in_arena : 1;
+
+  /* the flag and tag of the nodes created on demand, copied from
+   * @parent, which the array may outlive
+   */
+  guint thread_local : 1;
+  guint owner : 16;
+};
+
+struct _JsonKey
+{
+  volatile gint ref_count;  /* 0 for keys inside an arena */
+  guint hash;
+  gsize len;
+  gchar name[1];
 };
 
+typedef struct
+{
+  JsonKey *key;
+  JsonNode *value;
+} JsonObjectMember;
+
 struct _JsonObject
 {
-  GHashTable *members;
+  /* the members of the object, in insertion order; removed members
+   * leave a hole with a %NULL key, until the array is compacted
+   */
+  JsonObjectMember *members;
+  guint members_len;
+  guint members_size;
+  guint n_members;
 
-  /* the members of the object, ordered in reverse */
-  GList *members_ordered;
+  /* a hash table of the positions of the members, using the hashes
+   * of their keys, once the object grows too large to be searched
+   * linearly
+   */
+  guint *index;
+  guint index_size;
 
   guint immutable_hash;  /* valid iff immutable */
+  JsonSizeHint size_hint;  /* valid iff size_hint_valid */
+  volatile gint size_hint_valid;
   volatile gint ref_count;
   gboolean immutable : 1;
+  gboolean in_arena : 1;
 };
 
 typedef struct
 {
   JsonObject *object;  /* unowned */
-  GHashTableIter members_iter;  /* iterator over @members */
-  gpointer padding[2];  /* for future expansion */
+  gpointer padding_pointer[5];  /* for future expansion */
+  gint position;  /* the position of the next member */
+  gint padding_int;
+  gboolean padding_boolean;
 } JsonObjectIterReal;
 
 G_STATIC_ASSERT (sizeof (JsonObjectIterReal) == sizeof (JsonObjectIter));
@@ -125,47 +217,108 @@ G_GNUC_INTERNAL
 const gchar *   json_value_type_get_name        (JsonValueType    value_type);
 
 G_GNUC_INTERNAL
-GType           json_value_type                 (const JsonValue *value);
+GType           json_value_type                 (JsonValueType    value_type);
 
 G_GNUC_INTERNAL
-JsonValue *     json_value_alloc                (void);
+guint           json_thread_get_tag             (void);
+
+G_GNUC_INTERNAL
+JsonArena *     json_arena_new                  (void);
 G_GNUC_INTERNAL
-JsonValue *     json_value_init                 (JsonValue       *value,
-                                                 JsonValueType    value_type);
+JsonArena *     json_arena_ref                  (JsonArena       *arena);
 G_GNUC_INTERNAL
-JsonValue *     json_value_ref                  (JsonValue       *value);
+void            json_arena_unref                (JsonArena       *arena);
 G_GNUC_INTERNAL
-void            json_value_unref                (JsonValue       *value);
+gpointer        json_arena_alloc                (JsonArena       *arena,
+                                                 gsize            size);
 G_GNUC_INTERNAL
-void            json_value_unset                (JsonValue       *value);
+gchar *         json_arena_strndup              (JsonArena       *arena,
+                                                 const gchar     *str,
+                                                 gsize            len);
 G_GNUC_INTERNAL
-void            json_value_free                 (JsonValue       *value);
+void            json_arena_add_cleanup          (JsonArena       *arena,
+                                                 GDestroyNotify   func,
+                                                 gpointer         data);
 G_GNUC_INTERNAL
-void            json_value_set_int              (JsonValue       *value,
-                                                 gint64           v_int);
+JsonArena *     json_arena_from_pointer         (gconstpointer    data);
+G_GNUC_INTERNAL
+void            json_arena_set_thread_local     (JsonArena       *arena,
+                                                 guint            owner);
+
 G_GNUC_INTERNAL
-gint64          json_value_get_int              (const JsonValue *value);
+JsonKey *       json_key_new_len                (const gchar     *name,
+                                                 gssize           len);
 G_GNUC_INTERNAL
-void            json_value_set_double           (JsonValue       *value,
-                                                 gdouble          v_double);
+JsonKey *       json_key_new_in_arena           (JsonArena       *arena,
+                                                 const gchar     *name,
+                                                 gsize            len);
 G_GNUC_INTERNAL
-gdouble         json_value_get_double           (const JsonValue *value);
+guint           json_key_hash                   (const gchar     *name,
+                                                 gsize           *len);
 G_GNUC_INTERNAL
-void            json_value_set_boolean          (JsonValue       *value,
-                                                 gboolean         v_bool);
+JsonKeyTable *  json_key_table_new              (JsonArena       *arena);
+G_GNUC_INTERNAL
+void            json_key_table_free             (JsonKeyTable    *table);
+G_GNUC_INTERNAL
+JsonKey *       json_key_table_lookup           (JsonKeyTable    *table,
+                                                 const gchar     *name,
+                                                 gsize            len);
+
 G_GNUC_INTERNAL
-gboolean        json_value_get_boolean          (const JsonValue *value);
+JsonNode *      json_node_alloc_in_arena        (JsonArena       *arena);
 G_GNUC_INTERNAL
-void            json_value_set_string           (JsonValue       *value,
-                                                 const gchar     *v_str);
+JsonObject *    json_object_new_in_arena        (JsonArena       *arena);
 G_GNUC_INTERNAL
-const gchar *   json_value_get_string           (const JsonValue *value);
+JsonArray *     json_array_new_in_arena         (JsonArena       *arena);
 
 G_GNUC_INTERNAL
-void            json_value_seal                 (JsonValue       *value);
+void            json_node_set_string_len        (JsonNode        *node,
+                                                 const gchar     *value,
+                                                 gsize            len);
 
 G_GNUC_INTERNAL
-guint           json_value_hash                 (gconstpointer    key);
+gboolean        json_array_add_packed_int       (JsonArray       *array,
+                                                 gint64           value);
+G_GNUC_INTERNAL
+gboolean        json_array_add_packed_double    (JsonArray       *array,
+                                                 gdouble          value);
+G_GNUC_INTERNAL
+JsonNode *      json_array_peek_element         (JsonArray       *array,
+                                                 guint            index_,
+                                                 JsonNode        *scratch);
+G_GNUC_INTERNAL
+void            json_array_set_element_parent   (JsonArray       *array,
+                                                 JsonNode        *parent);
+
+G_GNUC_INTERNAL
+const gchar *   json_object_take_member         (JsonObject      *object,
+                                                 JsonKey         *key,
+                                                 JsonNode        *node);
+G_GNUC_INTERNAL
+void            json_object_reserve             (JsonObject      *object,
+                                                 guint            n_members);
+G_GNUC_INTERNAL
+JsonNode *      json_node_share                 (JsonNode        *node,
+                                                 JsonNode        *parent);
+G_GNUC_INTERNAL
+void            json_node_set_thread_local      (JsonNode        *node,
+                                                 guint            owner);
+G_GNUC_INTERNAL
+JsonObject *    json_object_copy_shared         (JsonObject      *object,
+                                                 JsonNode        *parent);
+G_GNUC_INTERNAL
+JsonArray *     json_array_copy_shared          (JsonArray       *array,
+                                                 JsonNode        *parent);
+
+G_GNUC_INTERNAL
+void            json_strescape                  (GString         *output,
+                                                 const gchar     *str);
+G_GNUC_INTERNAL
+void            json_append_int                 (GString         *output,
+                                                 gint64           value);
+G_GNUC_INTERNAL
+void            json_append_double              (GString         *output,
+                                                 gdouble          value);
 
 G_END_DECLS
 
@@ -95,6 +95,7 @@ G_BEGIN_DECLS
 #define JSON_TYPE_NODE          (json_node_get_type ())
 #define JSON_TYPE_OBJECT        (json_object_get_type ())
 #define JSON_TYPE_ARRAY         (json_array_get_type ())
+#define JSON_TYPE_KEY           (json_key_get_type ())
 
 /**
  * JsonNode:
@@ -121,6 +122,17 @@ typedef struct _JsonObject      JsonObject;
  */
 typedef struct _JsonArray       JsonArray;
 
+/**
+ * JsonKey:
+ *
+ * The name of a #JsonObject member, with its hash precomputed. The
+ * contents of the #JsonKey structure are private and should only be
+ * accessed by the provided API
+ *
+ * Since: 1.4
+ */
+typedef struct _JsonKey         JsonKey;
+
 /**
  * JsonNodeType:
  * @JSON_NODE_OBJECT: The node contains a #JsonObject
@@ -210,6 +222,11 @@ JsonNode *            json_node_init_null       (JsonNode     *node);
 
 JSON_AVAILABLE_IN_1_0
 JsonNode *            json_node_copy            (JsonNode     *node);
+JSON_AVAILABLE_IN_1_4
+JsonNode *            json_node_copy_on_write   (JsonNode     *node);
+JSON_AVAILABLE_IN_1_4
+JsonNode *            json_node_deep_copy       (JsonNode     *node,
+                                                 gboolean      use_arena);
 JSON_AVAILABLE_IN_1_0
 void                  json_node_free            (JsonNode     *node);
 
@@ -285,6 +302,8 @@ JSON_AVAILABLE_IN_1_2
 void                  json_node_seal            (JsonNode     *node);
 JSON_AVAILABLE_IN_1_2
 gboolean              json_node_is_immutable    (JsonNode     *node);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_node_is_thread_local (JsonNode     *node);
 
 JSON_AVAILABLE_IN_1_2
 guint                 json_string_hash            (gconstpointer  key);
@@ -301,6 +320,20 @@ JSON_AVAILABLE_IN_1_2
 gboolean              json_node_equal             (gconstpointer  a,
                                                    gconstpointer  b);
 
+/*
+ * JsonKey
+ */
+JSON_AVAILABLE_IN_1_4
+GType                 json_key_get_type              (void) G_GNUC_CONST;
+JSON_AVAILABLE_IN_1_4
+JsonKey *             json_key_new                   (const gchar   *name);
+JSON_AVAILABLE_IN_1_4
+JsonKey *             json_key_ref                   (JsonKey       *key);
+JSON_AVAILABLE_IN_1_4
+void                  json_key_unref                 (JsonKey       *key);
+JSON_AVAILABLE_IN_1_4
+const gchar *         json_key_get_name              (const JsonKey *key);
+
 /*
  * JsonObject
  */
@@ -432,6 +465,38 @@ gboolean              json_object_iter_next          (JsonObjectIter  *iter,
                                                       const gchar    **member_name,
                                                       JsonNode       **member_node);
 
+JSON_AVAILABLE_IN_1_4
+void                  json_object_set_member_by_key         (JsonObject    *object,
+                                                             JsonKey       *key,
+                                                             JsonNode      *node);
+JSON_AVAILABLE_IN_1_4
+JsonNode *            json_object_get_member_by_key         (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+gint64                json_object_get_int_member_by_key     (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+gdouble               json_object_get_double_member_by_key  (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_object_get_boolean_member_by_key (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_object_get_null_member_by_key    (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+const gchar *         json_object_get_string_member_by_key  (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+JsonArray *           json_object_get_array_member_by_key   (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+JsonObject *          json_object_get_object_member_by_key  (JsonObject    *object,
+                                                             const JsonKey *key);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_object_has_member_by_key         (JsonObject    *object,
+                                                             const JsonKey *key);
+
 JSON_AVAILABLE_IN_1_0
 GType                 json_array_get_type            (void) G_GNUC_CONST;
 JSON_AVAILABLE_IN_1_0
@@ -503,6 +568,36 @@ JSON_AVAILABLE_IN_1_0
 void                  json_array_foreach_element     (JsonArray   *array,
                                                       JsonArrayForeach func,
                                                       gpointer     data);
+JSON_AVAILABLE_IN_1_4
+void                  json_array_add_int_elements    (JsonArray     *array,
+                                                      const gint64  *values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+void                  json_array_add_double_elements (JsonArray     *array,
+                                                      const gdouble *values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+void                  json_array_add_string_elements (JsonArray     *array,
+                                                      const gchar * const *values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_array_get_int_elements    (JsonArray     *array,
+                                                      gint64        *values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_array_get_double_elements (JsonArray     *array,
+                                                      gdouble       *values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+gboolean              json_array_get_string_elements (JsonArray     *array,
+                                                      const gchar  **values,
+                                                      guint          n_values);
+JSON_AVAILABLE_IN_1_4
+const gint64 *        json_array_peek_int_elements   (JsonArray   *array,
+                                                      guint       *n_elements);
+JSON_AVAILABLE_IN_1_4
+const gdouble *       json_array_peek_double_elements (JsonArray  *array,
+                                                      guint       *n_elements);
 JSON_AVAILABLE_IN_1_2
 void                  json_array_seal                (JsonArray   *array);
 JSON_AVAILABLE_IN_1_2
@@ -518,6 +613,7 @@ gboolean              json_array_equal               (gconstpointer a,
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonArray, json_array_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonObject, json_object_unref)
 G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonNode, json_node_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonKey, json_key_unref)
 #endif
 
 G_END_DECLS
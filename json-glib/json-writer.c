@@ -0,0 +1,945 @@
+/* json-writer.c - Streaming writer for JSON data
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:json-writer
+ * @Title: JsonWriter
+ * @short_description: A streaming writer for JSON data
+ *
+ * #JsonWriter formats a JSON document as it is described by a sequence
+ * of calls, like the ones used with #JsonBuilder, without building a
+ * tree of #JsonNode first. The data is either kept in memory, or written
+ * to a #GOutputStream whenever the buffer of the writer fills up:
+ *
+ * |[<!-- language="C" -->
+ * JsonWriter *writer = json_writer_new (NULL);
+ * GError *error = NULL;
+ * gchar *data;
+ *
+ * json_writer_begin_object (writer);
+ * json_writer_set_member_name (writer, "url");
+ * json_writer_add_string_value (writer, "http://www.gnome.org/img/flash/two-thirty.png");
+ * json_writer_set_member_name (writer, "size");
+ * json_writer_begin_array (writer);
+ * json_writer_add_int_value (writer, 652);
+ * json_writer_add_int_value (writer, 242);
+ * json_writer_end_array (writer);
+ * json_writer_end_object (writer);
+ *
+ * if (json_writer_finish (writer, NULL, &error))
+ *   data = json_writer_steal_data (writer, NULL);
+ *
+ * g_object_unref (writer);
+ * ]|
+ *
+ * The writer keeps track of the open objects and arrays, and calls that
+ * would produce an invalid document, like adding a value to an object
+ * without setting the name of the member first, are ignored with a
+ * warning, like the ones of #JsonBuilder.
+ *
+ * Strings and numbers are formatted in the same way as #JsonGenerator
+ * does, and so is the output of the #JsonWriter:pretty property.
+ *
+ * #JsonWriter is available since JSON-GLib 1.4.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "json-types-private.h"
+
+#include "json-writer.h"
+
+/* the size of the buffer, when writing to a stream */
+#define WRITE_BUFFER_SIZE       (64 * 1024)
+
+typedef struct
+{
+  guint is_object : 1;
+  guint has_items : 1;
+
+  /* whether a member name is waiting for its value */
+  guint has_member_name : 1;
+} JsonWriterFrame;
+
+struct _JsonWriterPrivate
+{
+  GString *buffer;
+
+  GOutputStream *stream;
+
+  /* the error of the last write to @stream, reported by
+   * json_writer_finish()
+   */
+  GError *error;
+
+  /* the open objects and arrays */
+  GArray *frames;
+
+  guint indent;
+
+  guint pretty   : 1;
+  guint has_root : 1;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_STREAM,
+  PROP_PRETTY,
+  PROP_INDENT,
+
+  PROP_LAST
+};
+
+static GParamSpec *writer_props[PROP_LAST] = { NULL, };
+
+G_DEFINE_TYPE_WITH_PRIVATE (JsonWriter, json_writer, G_TYPE_OBJECT)
+
+static void
+json_writer_finalize (GObject *gobject)
+{
+  JsonWriterPrivate *priv = JSON_WRITER (gobject)->priv;
+
+  g_clear_object (&priv->stream);
+  g_clear_error (&priv->error);
+  g_array_unref (priv->frames);
+  g_string_free (priv->buffer, TRUE);
+
+  G_OBJECT_CLASS (json_writer_parent_class)->finalize (gobject);
+}
+
+static void
+json_writer_set_property (GObject      *gobject,
+                          guint         prop_id,
+                          const GValue *value,
+                          GParamSpec   *pspec)
+{
+  JsonWriterPrivate *priv = JSON_WRITER (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_STREAM:
+      /* Construct-only. */
+      priv->stream = g_value_dup_object (value);
+      break;
+    case PROP_PRETTY:
+      /* Construct-only. */
+      priv->pretty = g_value_get_boolean (value);
+      break;
+    case PROP_INDENT:
+      /* Construct-only. */
+      priv->indent = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+json_writer_get_property (GObject    *gobject,
+                          guint       prop_id,
+                          GValue     *value,
+                          GParamSpec *pspec)
+{
+  JsonWriterPrivate *priv = JSON_WRITER (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_STREAM:
+      g_value_set_object (value, priv->stream);
+      break;
+    case PROP_PRETTY:
+      g_value_set_boolean (value, priv->pretty);
+      break;
+    case PROP_INDENT:
+      g_value_set_uint (value, priv->indent);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+json_writer_class_init (JsonWriterClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = json_writer_set_property;
+  gobject_class->get_property = json_writer_get_property;
+  gobject_class->finalize = json_writer_finalize;
+
+  /**
+   * JsonWriter:stream:
+   *
+   * The #GOutputStream the data is written to, or %NULL if the data
+   * is kept in memory.
+   *
+   * Since: 1.4
+   */
+  writer_props[PROP_STREAM] =
+    g_param_spec_object ("stream",
+                         "Stream",
+                         "The stream the data is written to",
+                         G_TYPE_OUTPUT_STREAM,
+                         G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * JsonWriter:pretty:
+   *
+   * Whether the output should be "pretty-printed", with indentation and
+   * newlines, like the output of #JsonGenerator:pretty.
+   *
+   * Since: 1.4
+   */
+  writer_props[PROP_PRETTY] =
+    g_param_spec_boolean ("pretty",
+                          "Pretty",
+                          "Pretty-print the output",
+                          FALSE,
+                          G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  /**
+   * JsonWriter:indent:
+   *
+   * The number of spaces used to indent each level of the output,
+   * if #JsonWriter:pretty is set.
+   *
+   * Since: 1.4
+   */
+  writer_props[PROP_INDENT] =
+    g_param_spec_uint ("indent",
+                       "Indent",
+                       "Number of indentation spaces",
+                       0, G_MAXUINT,
+                       2,
+                       G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, PROP_LAST, writer_props);
+}
+
+static void
+json_writer_init (JsonWriter *writer)
+{
+  JsonWriterPrivate *priv = json_writer_get_instance_private (writer);
+
+  writer->priv = priv;
+
+  priv->buffer = g_string_sized_new (256);
+  priv->frames = g_array_new (FALSE, FALSE, sizeof (JsonWriterFrame));
+  priv->indent = 2;
+}
+
+/**
+ * json_writer_new:
+ * @stream: (allow-none): the #GOutputStream to write to, or %NULL
+ *
+ * Creates a new #JsonWriter. If @stream is %NULL, the data is kept in
+ * memory, and it can be retrieved with json_writer_steal_data() once
+ * the document is complete.
+ *
+ * Returns: (transfer full): the newly created #JsonWriter. Use
+ *   g_object_unref() when done.
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_new (GOutputStream *stream)
+{
+  g_return_val_if_fail (stream == NULL || G_IS_OUTPUT_STREAM (stream), NULL);
+
+  return g_object_new (JSON_TYPE_WRITER, "stream", stream, NULL);
+}
+
+static inline JsonWriterFrame *
+json_writer_current_frame (JsonWriter *writer)
+{
+  GArray *frames = writer->priv->frames;
+
+  if (frames->len == 0)
+    return NULL;
+
+  return &g_array_index (frames, JsonWriterFrame, frames->len - 1);
+}
+
+static inline void
+json_writer_indent (JsonWriter *writer,
+                    guint       level)
+{
+  JsonWriterPrivate *priv = writer->priv;
+  guint i;
+
+  for (i = 0; i < level * priv->indent; i++)
+    g_string_append_c (priv->buffer, ' ');
+}
+
+/* writes the separator from the previous member or element of the
+ * innermost container, if any
+ */
+static void
+json_writer_begin_item (JsonWriter      *writer,
+                        JsonWriterFrame *frame)
+{
+  JsonWriterPrivate *priv = writer->priv;
+
+  if (frame->has_items)
+    {
+      g_string_append_c (priv->buffer, ',');
+
+      if (priv->pretty)
+        g_string_append_c (priv->buffer, '\n');
+    }
+
+  frame->has_items = TRUE;
+
+  if (priv->pretty)
+    json_writer_indent (writer, priv->frames->len);
+}
+
+static inline gboolean
+json_writer_is_valid_add_mode (JsonWriter *writer)
+{
+  JsonWriterFrame *frame = json_writer_current_frame (writer);
+
+  if (frame == NULL)
+    return !writer->priv->has_root;
+
+  return !frame->is_object || frame->has_member_name;
+}
+
+static void
+json_writer_begin_value (JsonWriter *writer)
+{
+  JsonWriterFrame *frame = json_writer_current_frame (writer);
+
+  if (frame == NULL)
+    writer->priv->has_root = TRUE;
+  else if (frame->is_object)
+    frame->has_member_name = FALSE;
+  else
+    json_writer_begin_item (writer, frame);
+}
+
+/* writes out the buffer, if it is full */
+static void
+json_writer_end_value (JsonWriter *writer)
+{
+  JsonWriterPrivate *priv = writer->priv;
+
+  if (priv->stream == NULL || priv->buffer->len < WRITE_BUFFER_SIZE)
+    return;
+
+  /* the data is dropped after an error, which will be reported by
+   * json_writer_finish()
+   */
+  if (priv->error == NULL)
+    g_output_stream_write_all (priv->stream,
+                               priv->buffer->str, priv->buffer->len,
+                               NULL,
+                               NULL,
+                               &priv->error);
+
+  g_string_truncate (priv->buffer, 0);
+}
+
+static void
+json_writer_begin_container (JsonWriter *writer,
+                             gboolean    is_object)
+{
+  JsonWriterPrivate *priv = writer->priv;
+  JsonWriterFrame frame = { 0, };
+
+  json_writer_begin_value (writer);
+
+  g_string_append_c (priv->buffer, is_object ? '{' : '[');
+
+  if (priv->pretty)
+    g_string_append_c (priv->buffer, '\n');
+
+  frame.is_object = is_object;
+  g_array_append_val (priv->frames, frame);
+}
+
+static void
+json_writer_end_container (JsonWriter *writer,
+                           gboolean    is_object)
+{
+  JsonWriterPrivate *priv = writer->priv;
+  JsonWriterFrame *frame = json_writer_current_frame (writer);
+
+  if (priv->pretty)
+    {
+      if (frame->has_items)
+        g_string_append_c (priv->buffer, '\n');
+
+      json_writer_indent (writer, priv->frames->len - 1);
+    }
+
+  g_string_append_c (priv->buffer, is_object ? '}' : ']');
+
+  g_array_set_size (priv->frames, priv->frames->len - 1);
+
+  json_writer_end_value (writer);
+}
+
+/**
+ * json_writer_begin_object:
+ * @writer: a #JsonWriter
+ *
+ * Opens an object. The members of the object are added by calling
+ * json_writer_set_member_name() before each of their values; when done
+ * adding members, json_writer_end_object() must be called.
+ *
+ * Can be called for the top level value, or after setting the name of
+ * an object member, or for an array element.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_begin_object (JsonWriter *writer)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_container (writer, TRUE);
+
+  return writer;
+}
+
+/**
+ * json_writer_end_object:
+ * @writer: a #JsonWriter
+ *
+ * Closes the object opened by the most recent call to
+ * json_writer_begin_object().
+ *
+ * Cannot be called after json_writer_set_member_name().
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_end_object (JsonWriter *writer)
+{
+  JsonWriterFrame *frame;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+
+  frame = json_writer_current_frame (writer);
+  g_return_val_if_fail (frame != NULL && frame->is_object, NULL);
+  g_return_val_if_fail (!frame->has_member_name, NULL);
+
+  json_writer_end_container (writer, TRUE);
+
+  return writer;
+}
+
+/**
+ * json_writer_set_member_name:
+ * @writer: a #JsonWriter
+ * @member_name: the name of the member
+ *
+ * Writes the name of the next member of the current object. The next
+ * call must add a value, or open an object or an array.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_set_member_name (JsonWriter  *writer,
+                             const gchar *member_name)
+{
+  JsonWriterPrivate *priv;
+  JsonWriterFrame *frame;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (member_name != NULL, NULL);
+
+  frame = json_writer_current_frame (writer);
+  g_return_val_if_fail (frame != NULL && frame->is_object, NULL);
+  g_return_val_if_fail (!frame->has_member_name, NULL);
+
+  priv = writer->priv;
+
+  json_writer_begin_item (writer, frame);
+  frame->has_member_name = TRUE;
+
+  g_string_append_c (priv->buffer, '"');
+  json_strescape (priv->buffer, member_name);
+  g_string_append_c (priv->buffer, '"');
+
+  if (priv->pretty)
+    g_string_append (priv->buffer, " : ");
+  else
+    g_string_append_c (priv->buffer, ':');
+
+  return writer;
+}
+
+/**
+ * json_writer_begin_array:
+ * @writer: a #JsonWriter
+ *
+ * Opens an array. When done adding elements, json_writer_end_array()
+ * must be called.
+ *
+ * Can be called for the top level value, or after setting the name of
+ * an object member, or for an array element.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_begin_array (JsonWriter *writer)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_container (writer, FALSE);
+
+  return writer;
+}
+
+/**
+ * json_writer_end_array:
+ * @writer: a #JsonWriter
+ *
+ * Closes the array opened by the most recent call to
+ * json_writer_begin_array().
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_end_array (JsonWriter *writer)
+{
+  JsonWriterFrame *frame;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+
+  frame = json_writer_current_frame (writer);
+  g_return_val_if_fail (frame != NULL && !frame->is_object, NULL);
+
+  json_writer_end_container (writer, FALSE);
+
+  return writer;
+}
+
+static void
+json_writer_write_node (JsonWriter *writer,
+                        JsonNode   *node)
+{
+  JsonWriterPrivate *priv = writer->priv;
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_OBJECT:
+      {
+        JsonObjectIter iter;
+        const gchar *member_name;
+        JsonNode *member;
+
+        json_writer_begin_container (writer, TRUE);
+
+        json_object_iter_init (&iter, node->data.object);
+        while (json_object_iter_next (&iter, &member_name, &member))
+          {
+            json_writer_set_member_name (writer, member_name);
+            json_writer_write_node (writer, member);
+          }
+
+        json_writer_end_container (writer, TRUE);
+      }
+      return;
+
+    case JSON_NODE_ARRAY:
+      {
+        JsonArray *array = node->data.array;
+        guint i, len = json_array_get_length (array);
+
+        json_writer_begin_container (writer, FALSE);
+
+        for (i = 0; i < len; i++)
+          {
+            JsonNode scratch;
+
+            json_writer_write_node (writer, json_array_peek_element (array, i, &scratch));
+          }
+
+        json_writer_end_container (writer, FALSE);
+      }
+      return;
+
+    case JSON_NODE_NULL:
+      json_writer_begin_value (writer);
+      g_string_append (priv->buffer, "null");
+      break;
+
+    case JSON_NODE_VALUE:
+      json_writer_begin_value (writer);
+
+      switch (node->value_type)
+        {
+        case JSON_VALUE_INT:
+          json_append_int (priv->buffer, node->data.v_int);
+          break;
+
+        case JSON_VALUE_DOUBLE:
+          json_append_double (priv->buffer, node->data.v_double);
+          break;
+
+        case JSON_VALUE_BOOLEAN:
+          g_string_append (priv->buffer, node->data.v_bool ? "true" : "false");
+          break;
+
+        case JSON_VALUE_STRING:
+          g_string_append_c (priv->buffer, '"');
+          json_strescape (priv->buffer, JSON_NODE_PEEK_STRING (node));
+          g_string_append_c (priv->buffer, '"');
+          break;
+
+        default:
+          g_string_append (priv->buffer, "null");
+          break;
+        }
+      break;
+    }
+
+  json_writer_end_value (writer);
+}
+
+/**
+ * json_writer_add_value:
+ * @writer: a #JsonWriter
+ * @node: a #JsonNode
+ *
+ * Writes @node, and the whole tree below it, as the next value. This
+ * can be used to mix data written directly with data that is already
+ * stored in a tree.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_value (JsonWriter *writer,
+                       JsonNode   *node)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (node != NULL, NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_write_node (writer, node);
+
+  return writer;
+}
+
+/**
+ * json_writer_add_int_value:
+ * @writer: a #JsonWriter
+ * @value: the value of the member or element
+ *
+ * Writes @value as the next value.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_int_value (JsonWriter *writer,
+                           gint64      value)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_value (writer);
+  json_append_int (writer->priv->buffer, value);
+  json_writer_end_value (writer);
+
+  return writer;
+}
+
+/**
+ * json_writer_add_double_value:
+ * @writer: a #JsonWriter
+ * @value: the value of the member or element
+ *
+ * Writes @value as the next value.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_double_value (JsonWriter *writer,
+                              gdouble     value)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_value (writer);
+  json_append_double (writer->priv->buffer, value);
+  json_writer_end_value (writer);
+
+  return writer;
+}
+
+/**
+ * json_writer_add_boolean_value:
+ * @writer: a #JsonWriter
+ * @value: the value of the member or element
+ *
+ * Writes @value as the next value.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_boolean_value (JsonWriter *writer,
+                               gboolean    value)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_value (writer);
+  g_string_append (writer->priv->buffer, value ? "true" : "false");
+  json_writer_end_value (writer);
+
+  return writer;
+}
+
+/**
+ * json_writer_add_string_value:
+ * @writer: a #JsonWriter
+ * @value: (allow-none): the value of the member or element
+ *
+ * Writes @value as the next value. If @value is %NULL, a null value
+ * is written instead.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_string_value (JsonWriter  *writer,
+                              const gchar *value)
+{
+  JsonWriterPrivate *priv;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  priv = writer->priv;
+
+  json_writer_begin_value (writer);
+
+  if (value != NULL)
+    {
+      g_string_append_c (priv->buffer, '"');
+      json_strescape (priv->buffer, value);
+      g_string_append_c (priv->buffer, '"');
+    }
+  else
+    g_string_append (priv->buffer, "null");
+
+  json_writer_end_value (writer);
+
+  return writer;
+}
+
+/**
+ * json_writer_add_null_value:
+ * @writer: a #JsonWriter
+ *
+ * Writes a null value as the next value.
+ *
+ * Returns: (nullable) (transfer none): the #JsonWriter, or %NULL if the
+ *   call was inconsistent
+ *
+ * Since: 1.4
+ */
+JsonWriter *
+json_writer_add_null_value (JsonWriter *writer)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+  g_return_val_if_fail (json_writer_is_valid_add_mode (writer), NULL);
+
+  json_writer_begin_value (writer);
+  g_string_append (writer->priv->buffer, "null");
+  json_writer_end_value (writer);
+
+  return writer;
+}
+
+/**
+ * json_writer_get_depth:
+ * @writer: a #JsonWriter
+ *
+ * Retrieves the number of objects and arrays that are currently open.
+ *
+ * Returns: the depth of the current value
+ *
+ * Since: 1.4
+ */
+guint
+json_writer_get_depth (JsonWriter *writer)
+{
+  g_return_val_if_fail (JSON_IS_WRITER (writer), 0);
+
+  return writer->priv->frames->len;
+}
+
+/**
+ * json_writer_finish:
+ * @writer: a #JsonWriter
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @error: return location for a #GError, or %NULL
+ *
+ * Completes the document. All the objects and arrays must be closed.
+ *
+ * If @writer writes to a stream, the data that is still buffered is
+ * written to it; the stream is not closed. The errors that happened
+ * while writing out the buffer as it filled up are reported here.
+ *
+ * Returns: %TRUE if the document was written successfully
+ *
+ * Since: 1.4
+ */
+gboolean
+json_writer_finish (JsonWriter    *writer,
+                    GCancellable  *cancellable,
+                    GError       **error)
+{
+  JsonWriterPrivate *priv;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), FALSE);
+  g_return_val_if_fail (writer->priv->frames->len == 0, FALSE);
+
+  priv = writer->priv;
+
+  if (priv->error != NULL)
+    {
+      g_propagate_error (error, priv->error);
+      priv->error = NULL;
+      return FALSE;
+    }
+
+  if (priv->stream == NULL || priv->buffer->len == 0)
+    return TRUE;
+
+  if (!g_output_stream_write_all (priv->stream,
+                                  priv->buffer->str, priv->buffer->len,
+                                  NULL,
+                                  cancellable,
+                                  error))
+    return FALSE;
+
+  g_string_truncate (priv->buffer, 0);
+
+  return TRUE;
+}
+
+/**
+ * json_writer_steal_data:
+ * @writer: a #JsonWriter
+ * @length: (out) (optional): return location for the length of the
+ *   returned data, or %NULL
+ *
+ * Retrieves the data written by @writer, if it does not write to a
+ * stream, and resets @writer, so that it can be used to write another
+ * document.
+ *
+ * Returns: (transfer full) (nullable): the written data, or %NULL if
+ *   @writer writes to a stream. Use g_free() when done
+ *
+ * Since: 1.4
+ */
+gchar *
+json_writer_steal_data (JsonWriter *writer,
+                        gsize      *length)
+{
+  JsonWriterPrivate *priv;
+  gchar *res;
+
+  g_return_val_if_fail (JSON_IS_WRITER (writer), NULL);
+
+  priv = writer->priv;
+
+  if (priv->stream != NULL)
+    {
+      if (length)
+        *length = 0;
+
+      return NULL;
+    }
+
+  if (length)
+    *length = priv->buffer->len;
+
+  res = g_string_free (priv->buffer, FALSE);
+  priv->buffer = g_string_sized_new (256);
+
+  json_writer_reset (writer);
+
+  return res;
+}
+
+/**
+ * json_writer_reset:
+ * @writer: a #JsonWriter
+ *
+ * Resets @writer to its initial state, dropping the data that was not
+ * written out yet, so that it can be used to write another document.
+ *
+ * Since: 1.4
+ */
+void
+json_writer_reset (JsonWriter *writer)
+{
+  JsonWriterPrivate *priv;
+
+  g_return_if_fail (JSON_IS_WRITER (writer));
+
+  priv = writer->priv;
+
+  g_string_truncate (priv->buffer, 0);
+  g_array_set_size (priv->frames, 0);
+  g_clear_error (&priv->error);
+  priv->has_root = FALSE;
+}
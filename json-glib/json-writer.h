@@ -0,0 +1,131 @@
+/* json-writer.h - Streaming writer for JSON data
+ *
+ * This file is part of JSON-GLib
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __JSON_WRITER_H__
+#define __JSON_WRITER_H__
+
+#if !defined(__JSON_GLIB_INSIDE__) && !defined(JSON_COMPILATION)
+#error "Only <json-glib/json-glib.h> can be included directly."
+#endif
+
+#include <json-glib/json-types.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define JSON_TYPE_WRITER                (json_writer_get_type ())
+#define JSON_WRITER(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), JSON_TYPE_WRITER, JsonWriter))
+#define JSON_IS_WRITER(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), JSON_TYPE_WRITER))
+#define JSON_WRITER_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), JSON_TYPE_WRITER, JsonWriterClass))
+#define JSON_IS_WRITER_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), JSON_TYPE_WRITER))
+#define JSON_WRITER_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), JSON_TYPE_WRITER, JsonWriterClass))
+
+typedef struct _JsonWriter              JsonWriter;
+typedef struct _JsonWriterPrivate       JsonWriterPrivate;
+typedef struct _JsonWriterClass         JsonWriterClass;
+
+/**
+ * JsonWriter:
+ *
+ * The `JsonWriter` structure contains only private data and should
+ * be accessed using the provided API
+ *
+ * Since: 1.4
+ */
+struct _JsonWriter
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  JsonWriterPrivate *priv;
+};
+
+/**
+ * JsonWriterClass:
+ *
+ * The `JsonWriterClass` structure contains only private data
+ *
+ * Since: 1.4
+ */
+struct _JsonWriterClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  void (*_json_padding0) (void);
+  void (*_json_padding1) (void);
+  void (*_json_padding2) (void);
+  void (*_json_padding3) (void);
+};
+
+JSON_AVAILABLE_IN_1_4
+GType json_writer_get_type (void) G_GNUC_CONST;
+
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_new                 (GOutputStream  *stream);
+
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_begin_object        (JsonWriter     *writer);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_end_object          (JsonWriter     *writer);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_set_member_name     (JsonWriter     *writer,
+                                                 const gchar    *member_name);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_begin_array         (JsonWriter     *writer);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_end_array           (JsonWriter     *writer);
+
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_value           (JsonWriter     *writer,
+                                                 JsonNode       *node);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_int_value       (JsonWriter     *writer,
+                                                 gint64          value);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_double_value    (JsonWriter     *writer,
+                                                 gdouble         value);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_boolean_value   (JsonWriter     *writer,
+                                                 gboolean        value);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_string_value    (JsonWriter     *writer,
+                                                 const gchar    *value);
+JSON_AVAILABLE_IN_1_4
+JsonWriter *    json_writer_add_null_value      (JsonWriter     *writer);
+
+JSON_AVAILABLE_IN_1_4
+guint           json_writer_get_depth           (JsonWriter     *writer);
+
+JSON_AVAILABLE_IN_1_4
+gboolean        json_writer_finish              (JsonWriter     *writer,
+                                                 GCancellable   *cancellable,
+                                                 GError        **error);
+JSON_AVAILABLE_IN_1_4
+gchar *         json_writer_steal_data          (JsonWriter     *writer,
+                                                 gsize          *length);
+JSON_AVAILABLE_IN_1_4
+void            json_writer_reset               (JsonWriter     *writer);
+
+#ifdef G_DEFINE_AUTOPTR_CLEANUP_FUNC
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (JsonWriter, g_object_unref)
+#endif
+
+G_END_DECLS
+
+#endif /* __JSON_WRITER_H__ */
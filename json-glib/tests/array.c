@@ -140,6 +140,185 @@ test_foreach_element (void)
   json_array_unref (array);
 }
 
+static void
+test_packed_elements (void)
+{
+  JsonArray *array = json_array_new ();
+  JsonArray *nodes = json_array_new ();
+  const gint64 *ints;
+  JsonNode *node;
+  guint i, len;
+
+  for (i = 0; i < 100; i++)
+    {
+      json_array_add_int_element (array, i * 3);
+      json_array_add_element (nodes, json_node_init_int (json_node_alloc (), i * 3));
+    }
+
+  /* arrays of integers are packed, unless they are built from nodes */
+  ints = json_array_peek_int_elements (array, &len);
+  g_assert_nonnull (ints);
+  g_assert_cmpint (len, ==, 100);
+  g_assert_cmpint (ints[99], ==, 297);
+  g_assert_null (json_array_peek_double_elements (array, NULL));
+  g_assert_null (json_array_peek_int_elements (nodes, NULL));
+
+  g_assert_cmpint (json_array_get_length (array), ==, 100);
+  g_assert_cmpint (json_array_get_int_element (array, 10), ==, 30);
+  g_assert_cmpfloat (json_array_get_double_element (array, 10), ==, 30.0);
+  g_assert_true (json_array_equal (array, nodes));
+  g_assert_cmpuint (json_array_hash (array), ==, json_array_hash (nodes));
+
+  /* nodes are created on demand, and only once */
+  node = json_array_get_element (array, 10);
+  g_assert_true (json_array_get_element (array, 10) == node);
+  g_assert_cmpint (json_node_get_int (node), ==, 30);
+
+  /* changing the value of a node changes the array */
+  json_node_set_int (node, -1);
+  g_assert_cmpint (json_array_get_int_element (array, 10), ==, -1);
+  ints = json_array_peek_int_elements (array, &len);
+  g_assert_cmpint (ints[10], ==, -1);
+  g_assert_false (json_array_equal (array, nodes));
+
+  /* unless it does not hold an integer anymore */
+  json_node_set_string (node, "thirty");
+  g_assert_cmpstr (json_array_get_string_element (array, 10), ==, "thirty");
+  g_assert_null (json_array_peek_int_elements (array, &len));
+  g_assert_cmpint (len, ==, 0);
+  g_assert_true (json_array_get_element (array, 10) == node);
+  g_assert_cmpint (json_array_get_int_element (array, 99), ==, 297);
+
+  json_array_unref (array);
+  json_array_unref (nodes);
+
+  /* adding anything but a double unpacks an array of doubles */
+  array = json_array_new ();
+  json_array_add_double_element (array, 0.5);
+  json_array_add_double_element (array, 1.5);
+  g_assert_nonnull (json_array_peek_double_elements (array, &len));
+  g_assert_cmpint (len, ==, 2);
+
+  node = json_array_get_element (array, 1);
+  json_node_ref (node);
+
+  json_array_add_int_element (array, 2);
+  g_assert_null (json_array_peek_double_elements (array, NULL));
+  g_assert_null (json_array_peek_int_elements (array, NULL));
+  g_assert_cmpint (json_array_get_length (array), ==, 3);
+  g_assert_true (json_array_get_element (array, 1) == node);
+  g_assert_cmpfloat (json_array_get_double_element (array, 0), ==, 0.5);
+  g_assert_cmpint (json_array_get_int_element (array, 2), ==, 2);
+
+  json_array_remove_element (array, 0);
+  g_assert_true (json_array_get_element (array, 0) == node);
+
+  json_array_unref (array);
+  g_assert_cmpfloat (json_node_get_double (node), ==, 1.5);
+  json_node_unref (node);
+
+  /* removing an element keeps the other ones */
+  array = json_array_new ();
+  for (i = 0; i < 10; i++)
+    json_array_add_double_element (array, i / 2.0);
+
+  json_array_remove_element (array, 5);
+  g_assert_cmpint (json_array_get_length (array), ==, 9);
+  g_assert_cmpfloat (json_array_get_double_element (array, 5), ==, 3.0);
+
+  json_array_unref (array);
+}
+
+static void
+test_packed_outlive_parent (void)
+{
+  gboolean thread_local;
+
+  for (thread_local = FALSE; thread_local <= TRUE; thread_local++)
+    {
+      JsonParser *parser = g_object_new (JSON_TYPE_PARSER, "thread-local", thread_local, NULL);
+      GError *error = NULL;
+      JsonNode *copy, *element;
+
+      json_parser_load_from_data (parser, "[1,2,3]", -1, &error);
+      g_assert_no_error (error);
+
+      /* the copy shares the packed array, which outlives the node that
+       * held it in the parser
+       */
+      copy = json_node_copy (json_parser_get_root (parser));
+      g_object_unref (parser);
+
+      element = json_array_get_element (json_node_get_array (copy), 0);
+      g_assert_cmpint (json_node_get_int (element), ==, 1);
+      g_assert_cmpint (json_array_get_int_element (json_node_get_array (copy), 2), ==, 3);
+      g_assert_true (json_node_is_thread_local (element) == thread_local);
+
+      json_node_unref (copy);
+    }
+}
+
+static void
+test_bulk_elements (void)
+{
+  static const gint64 ints[] = { 1, -2, 3 };
+  static const gdouble doubles[] = { 0.5, -1.5, 2.75, 4.0 };
+  static const gchar * const strings[] = { "one", NULL, "a string longer than a node" };
+  JsonArray *array = json_array_new ();
+  gint64 int_values[16];
+  gdouble double_values[16];
+  const gchar *string_values[16];
+  guint len;
+
+  /* values added at once to an empty array are packed */
+  json_array_add_double_elements (array, doubles, G_N_ELEMENTS (doubles));
+  json_array_add_double_elements (array, doubles, 2);
+  g_assert_nonnull (json_array_peek_double_elements (array, &len));
+  g_assert_cmpint (len, ==, 6);
+  g_assert_cmpfloat (json_array_get_double_element (array, 5), ==, -1.5);
+
+  g_assert_true (json_array_get_double_elements (array, double_values, 6));
+  g_assert_cmpfloat (double_values[2], ==, 2.75);
+  g_assert_cmpfloat (double_values[4], ==, 0.5);
+  g_assert_true (json_array_get_int_elements (array, int_values, 3));
+  g_assert_cmpint (int_values[2], ==, 2);
+  g_assert_true (json_array_get_string_elements (array, string_values, 1));
+  g_assert_null (string_values[0]);
+
+  /* the values of the nodes created on demand are used */
+  json_node_set_double (json_array_get_element (array, 0), 8.0);
+  g_assert_true (json_array_get_double_elements (array, double_values, 1));
+  g_assert_cmpfloat (double_values[0], ==, 8.0);
+
+  /* other values unpack the array */
+  json_array_add_int_elements (array, ints, G_N_ELEMENTS (ints));
+  json_array_add_string_elements (array, strings, G_N_ELEMENTS (strings));
+  json_array_add_array_element (array, json_array_new ());
+  g_assert_null (json_array_peek_double_elements (array, NULL));
+  g_assert_cmpint (json_array_get_length (array), ==, 13);
+  g_assert_cmpint (json_array_get_int_element (array, 7), ==, -2);
+  g_assert_null (json_array_get_string_element (array, 10));
+
+  g_assert_true (json_array_get_int_elements (array, int_values, 9));
+  g_assert_cmpint (int_values[0], ==, 8);
+  g_assert_cmpint (int_values[8], ==, 3);
+  g_assert_true (json_array_get_double_elements (array, double_values, 8));
+  g_assert_cmpfloat (double_values[7], ==, -2.0);
+  g_assert_true (json_array_get_string_elements (array, string_values, 12));
+  g_assert_null (string_values[0]);
+  g_assert_cmpstr (string_values[9], ==, "one");
+  g_assert_null (string_values[10]);
+  g_assert_cmpstr (string_values[11], ==, strings[2]);
+
+  /* containers have no value */
+  g_assert_false (json_array_get_int_elements (array, int_values, 13));
+  g_assert_cmpint (int_values[12], ==, 0);
+  g_assert_false (json_array_get_string_elements (array, string_values, 13));
+  g_assert_null (string_values[12]);
+
+  json_array_unref (array);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -150,6 +329,9 @@ main (int   argc,
   g_test_add_func ("/array/add-element", test_add_element);
   g_test_add_func ("/array/remove-element", test_remove_element);
   g_test_add_func ("/array/foreach-element", test_foreach_element);
+  g_test_add_func ("/array/packed-elements", test_packed_elements);
+  g_test_add_func ("/array/packed-outlive-parent", test_packed_outlive_parent);
+  g_test_add_func ("/array/bulk-elements", test_bulk_elements);
 
   return g_test_run ();
 }
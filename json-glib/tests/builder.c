@@ -13,6 +13,8 @@ static const gchar *empty_object = "{\"a\":{}}";
 static const gchar *reset_object = "{\"test\":\"reset\"}";
 static const gchar *reset_array = "[\"reset\"]";
 
+static const gchar *values_object = "{\"ints\":[1,2,3],\"doubles\":[0.5,-2.0],\"strings\":[\"a\",null,\"b\"]}";
+
 static void
 test_builder_complex (void)
 {
@@ -156,6 +158,78 @@ test_builder_reset (void)
   g_object_unref (generator);
 }
 
+static void
+test_builder_values (void)
+{
+  static const gint64 ints[] = { 1, 2, 3 };
+  static const gdouble doubles[] = { 0.5, -2.0 };
+  static const gchar * const strings[] = { "a", NULL, "b" };
+  JsonBuilder *builder = json_builder_new ();
+  JsonNode *node;
+  gchar *data;
+
+  json_builder_begin_object (builder);
+
+  json_builder_set_member_name (builder, "ints");
+  json_builder_begin_array (builder);
+  json_builder_add_int_values (builder, ints, 2);
+  json_builder_add_int_values (builder, ints + 2, 1);
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "doubles");
+  json_builder_begin_array (builder);
+  json_builder_add_double_values (builder, doubles, G_N_ELEMENTS (doubles));
+  json_builder_end_array (builder);
+
+  json_builder_set_member_name (builder, "strings");
+  json_builder_begin_array (builder);
+  json_builder_add_string_values (builder, strings, G_N_ELEMENTS (strings));
+  json_builder_end_array (builder);
+
+  json_builder_end_object (builder);
+
+  node = json_builder_get_root (builder);
+  data = json_to_string (node, FALSE);
+  g_assert_cmpstr (data, ==, values_object);
+
+  g_free (data);
+  json_node_unref (node);
+  g_object_unref (builder);
+}
+
+static void
+test_builder_thread_local (void)
+{
+  JsonBuilder *builder = g_object_new (JSON_TYPE_BUILDER, "thread-local", TRUE, NULL);
+  JsonNode *shared = json_node_init_string (json_node_alloc (), "shared");
+  JsonNode *node;
+  JsonObject *object;
+
+  json_builder_begin_object (builder);
+  json_builder_set_member_name (builder, "array");
+  json_builder_begin_array (builder);
+  json_builder_add_int_value (builder, 42);
+  json_builder_add_string_value (builder, "hello");
+  json_builder_end_array (builder);
+  json_builder_set_member_name (builder, "shared");
+  json_builder_add_value (builder, json_node_ref (shared));
+  json_builder_end_object (builder);
+
+  node = json_builder_get_root (builder);
+  g_assert_true (json_node_is_thread_local (node));
+
+  object = json_node_get_object (node);
+  g_assert_true (json_node_is_thread_local (json_object_get_member (object, "array")));
+  g_assert_true (json_node_is_thread_local (json_array_get_element (json_object_get_array_member (object, "array"), 1)));
+
+  /* nodes referenced from outside of the tree are left alone */
+  g_assert_false (json_node_is_thread_local (json_object_get_member (object, "shared")));
+
+  json_node_unref (node);
+  g_object_unref (builder);
+  json_node_unref (shared);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -165,6 +239,8 @@ main (int   argc,
   g_test_add_func ("/builder/complex", test_builder_complex);
   g_test_add_func ("/builder/empty", test_builder_empty);
   g_test_add_func ("/builder/reset", test_builder_reset);
+  g_test_add_func ("/builder/values", test_builder_values);
+  g_test_add_func ("/builder/thread-local", test_builder_thread_local);
 
   return g_test_run ();
 }
@@ -5,6 +5,7 @@
 #include <string.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <json-glib/json-glib.h>
 
@@ -356,6 +357,123 @@ test_double_stays_double (void)
 }
 
 
+static const struct {
+  gdouble value;
+  const gchar *expect;
+} double_fixtures[] = {
+  { 0.1, "0.1" },
+  { -2.5, "-2.5" },
+  { 100.0, "100.0" },
+  { 0.001, "0.001" },
+  { 1e-5, "1e-05" },
+  { 1e16, "10000000000000000.0" },
+  { 1e20, "1e+20" },
+  { 4.35, "4.35" },
+  { 5e-324, "5e-324" },
+  { 1.7976931348623157e308, "1.7976931348623157e+308" },
+  { -0.0, "-0.0" },
+};
+
+static void
+test_double_shortest (void)
+{
+  JsonParser *parser = json_parser_new ();
+  JsonGenerator *generator = json_generator_new ();
+  JsonNode *node = json_node_new (JSON_NODE_VALUE);
+  gint i;
+
+  for (i = 0; i < G_N_ELEMENTS (double_fixtures); i++)
+    {
+      GError *error = NULL;
+      gchar *str;
+
+      json_node_set_double (node, double_fixtures[i].value);
+      json_generator_set_root (generator, node);
+
+      str = json_generator_to_data (generator, NULL);
+      g_assert_cmpstr (str, ==, double_fixtures[i].expect);
+
+      /* the shortest representation is read back as the same double */
+      json_parser_load_from_data (parser, str, -1, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (json_node_get_value_type (json_parser_get_root (parser)), ==, G_TYPE_DOUBLE);
+      g_assert_cmpfloat (json_node_get_double (json_parser_get_root (parser)), ==, double_fixtures[i].value);
+
+      g_free (str);
+    }
+
+  json_node_free (node);
+  g_object_unref (generator);
+  g_object_unref (parser);
+}
+
+
+
+static const gchar *size_hint_examples[] = {
+  "[]",
+  "\"a\\u0001\\\"b\\n\"",
+  "-1234567890123",
+  "{ \"empty\" : {}, \"list\" : [], \"esc\\\"aped\" : [ 0.1, -2.5e-30, 1e20 ] }",
+  "[ 1, [ 2, [ 3, { \"four\" : [ 4, 4.5, \"caf\xc3\xa9\" ] } ] ], true, false, null ]",
+  "{ \"a\" : { \"b\" : { \"c\" : [ [], {}, [ { \"d\" : null } ] ] } }, \"e\" : -0.0 }",
+};
+
+static void
+test_size_hint (void)
+{
+  JsonParser *parser = json_parser_new ();
+  JsonGenerator *generator = json_generator_new ();
+  GError *error = NULL;
+  gint i;
+
+  g_assert_cmpuint (json_generator_get_size_hint (generator), ==, 0);
+
+  for (i = 0; i < G_N_ELEMENTS (size_hint_examples); i++)
+    {
+      JsonNode *root;
+      gint sealed;
+
+      json_parser_load_from_data (parser, size_hint_examples[i], -1, &error);
+      g_assert_no_error (error);
+
+      root = json_parser_get_root (parser);
+
+      /* the size of sealed containers is cached after the first use */
+      for (sealed = 0; sealed < 3; sealed++)
+        {
+          guint indent;
+
+          if (sealed == 1)
+            json_node_seal (root);
+
+          json_generator_set_root (generator, root);
+
+          for (indent = 0; indent < 6; indent += 3)
+            {
+              gboolean pretty;
+
+              json_generator_set_indent (generator, indent);
+
+              for (pretty = FALSE; pretty <= TRUE; pretty++)
+                {
+                  gchar *data;
+                  gsize length;
+
+                  json_generator_set_pretty (generator, pretty);
+
+                  data = json_generator_to_data (generator, &length);
+                  g_assert_cmpuint (json_generator_get_size_hint (generator), ==, length);
+
+                  g_free (data);
+                }
+            }
+        }
+    }
+
+  g_object_unref (generator);
+  g_object_unref (parser);
+}
+
 static void
 test_pretty (void)
 {
@@ -409,6 +527,10 @@ static const FixtureString string_fixtures[] = {
   { "a\nxc", "\"a\\nxc\"" },
   { "a\\xc", "\"a\\\\xc\"" },
   { "Barney B\303\244r", "\"Barney B\303\244r\"" },
+  { "a\037\"xc", "\"a\\u001f\\\"xc\"" },
+  { "a long string that needs no escaping at all", "\"a long string that needs no escaping at all\"" },
+  { "escapes after a long run of text:\t\"\001", "\"escapes after a long run of text:\\t\\\"\\u0001\"" },
+  { "caf\303\251 caf\303\251 caf\303\251 caf\303\251\r\b\f\x7f", "\"caf\303\251 caf\303\251 caf\303\251 caf\303\251\\r\\b\\f\\u007f\"" },
 };
 
 static void
@@ -431,6 +553,141 @@ test_string_encode (gconstpointer data)
 
   g_object_unref (generator);
 }
+/* a document larger than the buffer used to write to streams */
+static JsonNode *
+create_large_tree (gboolean thread_local)
+{
+  JsonBuilder *builder = g_object_new (JSON_TYPE_BUILDER, "thread-local", thread_local, NULL);
+  JsonNode *root;
+  guint i;
+
+  json_builder_begin_array (builder);
+
+  for (i = 0; i < 20000; i++)
+    {
+      json_builder_begin_object (builder);
+      json_builder_set_member_name (builder, "id");
+      json_builder_add_int_value (builder, i);
+      json_builder_set_member_name (builder, "name");
+      json_builder_add_string_value (builder, "a \"quoted\" name");
+      json_builder_end_object (builder);
+    }
+
+  json_builder_end_array (builder);
+
+  root = json_builder_get_root (builder);
+  g_object_unref (builder);
+
+  return root;
+}
+
+static void
+test_stream (void)
+{
+  JsonGenerator *generator = json_generator_new ();
+  GOutputStream *stream;
+  GCancellable *cancellable;
+  GError *error = NULL;
+  JsonNode *root;
+  gchar *data, *contents;
+  gchar *filename;
+  gsize length, contents_length;
+
+  root = create_large_tree (FALSE);
+  json_generator_set_root (generator, root);
+  json_generator_set_pretty (generator, TRUE);
+
+  data = json_generator_to_data (generator, &length);
+  g_assert_cmpuint (length, >, 64 * 1024);
+
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert_true (json_generator_to_stream (generator, stream, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, length);
+  g_assert_true (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (stream)), data, length) == 0);
+  g_object_unref (stream);
+
+  /* nothing is written once the operation is cancelled */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+  stream = g_memory_output_stream_new_resizable ();
+  g_assert_false (json_generator_to_stream (generator, stream, cancellable, &error));
+  g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, 0);
+  g_clear_error (&error);
+  g_object_unref (stream);
+  g_object_unref (cancellable);
+
+  filename = g_build_filename (g_get_tmp_dir (), "json-glib-generator-stream.json", NULL);
+  g_assert_true (json_generator_to_file (generator, filename, &error));
+  g_assert_no_error (error);
+  g_assert_true (g_file_get_contents (filename, &contents, &contents_length, &error));
+  g_assert_no_error (error);
+  g_assert_cmpuint (contents_length, ==, length);
+  g_assert_cmpstr (contents, ==, data);
+  g_unlink (filename);
+
+  g_free (contents);
+  g_free (filename);
+  g_free (data);
+  json_node_unref (root);
+  g_object_unref (generator);
+}
+
+static void
+on_write_complete (GObject      *gobject,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+  GMainLoop *main_loop = user_data;
+  GError *error = NULL;
+
+  g_assert_true (json_generator_to_stream_finish (JSON_GENERATOR (gobject), result, &error));
+  g_assert_no_error (error);
+
+  g_main_loop_quit (main_loop);
+}
+
+static void
+test_stream_async (gconstpointer data_)
+{
+  gboolean thread_local = GPOINTER_TO_INT (data_);
+  JsonGenerator *generator = json_generator_new ();
+  GOutputStream *stream;
+  GMainLoop *main_loop;
+  JsonNode *root;
+  gchar *data;
+  gsize length;
+
+  /* the tree is released by this thread while the operation is running,
+   * which must be safe even if the tree is thread-local
+   */
+  root = create_large_tree (thread_local);
+  g_assert_true (json_node_is_thread_local (root) == thread_local);
+  json_generator_set_root (generator, root);
+  json_node_unref (root);
+
+  data = json_generator_to_data (generator, &length);
+
+  stream = g_memory_output_stream_new_resizable ();
+  main_loop = g_main_loop_new (NULL, FALSE);
+
+  json_generator_to_stream_async (generator, stream, NULL, on_write_complete, main_loop);
+
+  /* the data to write is taken when the operation starts */
+  json_generator_set_root (generator, NULL);
+
+  g_main_loop_run (main_loop);
+
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, length);
+  g_assert_true (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (stream)), data, length) == 0);
+
+  g_main_loop_unref (main_loop);
+  g_object_unref (stream);
+  g_object_unref (generator);
+  g_free (data);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -449,7 +706,12 @@ main (int   argc,
   g_test_add_func ("/generator/nested-object", test_nested_object);
   g_test_add_func ("/generator/decimal-separator", test_decimal_separator);
   g_test_add_func ("/generator/double-stays-double", test_double_stays_double);
+  g_test_add_func ("/generator/double-shortest", test_double_shortest);
   g_test_add_func ("/generator/pretty", test_pretty);
+  g_test_add_func ("/generator/size-hint", test_size_hint);
+  g_test_add_func ("/generator/stream", test_stream);
+  g_test_add_data_func ("/generator/stream-async", GINT_TO_POINTER (FALSE), test_stream_async);
+  g_test_add_data_func ("/generator/stream-async-thread-local", GINT_TO_POINTER (TRUE), test_stream_async);
 
   for (i = 0; i < G_N_ELEMENTS (string_fixtures); i++)
     {
@@ -196,6 +196,33 @@ test_trailing_comma (gconstpointer user_data)
   g_object_unref (parser);
 }
 
+static void
+test_invalid_utf8 (gconstpointer user_data)
+{
+  const char *json = user_data;
+  GError *error = NULL;
+  JsonParser *parser;
+  gboolean res;
+
+  parser = json_parser_new ();
+  g_assert (JSON_IS_PARSER (parser));
+
+  if (g_test_verbose ())
+    g_print ("invalid data: '%s'...", json);
+
+  res = json_parser_load_from_data (parser, json, -1, &error);
+
+  g_assert (!res);
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_INVALID_DATA);
+
+  if (g_test_verbose ())
+    g_print ("expected error: %s\n", error->message);
+
+  g_clear_error (&error);
+
+  g_object_unref (parser);
+}
+
 static const struct
 {
   const char *path;
@@ -240,6 +267,13 @@ static const struct
   /* trailing commas */
   { "trailing-comma-1", "[ true, ]", test_trailing_comma },
   { "trailing-comma-2", "{ \"foo\" : 42, }", test_trailing_comma },
+
+  /* invalid UTF-8 */
+  { "utf8-1", "[ \"\xc3\x28\" ]", test_invalid_utf8 },
+  { "utf8-2", "{ \"key\" : \"long ASCII prefix before \xff\" }", test_invalid_utf8 },
+  { "utf8-3", "[ \"\xed\xa0\x80\" ]", test_invalid_utf8 },
+  { "utf8-4", "[ \"escaped\\n then truncated \xe2\x82\" ]", test_invalid_utf8 },
+  { "utf8-5", "[ 1, \xc0\xaf ]", test_invalid_utf8 },
 };
 
 static guint n_test_invalid = G_N_ELEMENTS (test_invalid);
@@ -2,6 +2,10 @@
 #include <json-glib/json-glib.h>
 #include <string.h>
 
+#ifdef G_OS_UNIX
+#include <unistd.h>
+#endif
+
 static void
 test_init_int (void)
 {
@@ -99,6 +103,188 @@ test_copy_object (void)
   json_node_free (node);
 }
 
+static void
+test_copy_immutable (void)
+{
+  JsonNode *node = json_from_string ("{ \"answer\" : [ 42 ] }", NULL);
+  JsonNode *member, *parent;
+  JsonNode *copy;
+
+  /* copies of immutable nodes are still new nodes, which can be given
+   * a parent of their own
+   */
+  json_node_seal (node);
+  member = json_object_get_member (json_node_get_object (node), "answer");
+  parent = json_node_new (JSON_NODE_NULL);
+  copy = json_node_copy (member);
+  g_assert_true (copy != member);
+  g_assert_true (json_node_is_immutable (copy));
+  g_assert_true (json_node_get_array (copy) == json_node_get_array (member));
+  json_node_set_parent (copy, parent);
+  g_assert_true (json_node_get_parent (member) == node);
+  json_node_unref (parent);
+  json_node_unref (copy);
+
+  /* a mutable copy of an immutable tree can be changed */
+  copy = json_node_copy_on_write (node);
+  g_assert_true (copy != node);
+  g_assert_false (json_node_is_immutable (copy));
+  g_assert_true (json_node_equal (node, copy));
+
+  json_array_add_int_element (json_object_get_array_member (json_node_get_object (copy), "answer"), 43);
+  g_assert_false (json_object_is_immutable (json_node_get_object (copy)));
+  g_assert_cmpint (json_array_get_length (json_object_get_array_member (json_node_get_object (node), "answer")), ==, 1);
+  g_assert_cmpint (json_array_get_length (json_object_get_array_member (json_node_get_object (copy), "answer")), ==, 2);
+
+  json_node_unref (copy);
+  json_node_unref (node);
+}
+
+static const gchar *cow_data =
+  "{ \"a\" : { \"b\" : [ 1, \"two\", { \"c\" : \"x\" } ], \"d\" : true }, "
+  "\"e\" : [ 1.5, 2.5 ], \"f\" : { } }";
+
+static void
+test_copy_on_write (gconstpointer data_)
+{
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  JsonParser *parser;
+  JsonNode *root, *copy, *element;
+  JsonObject *object;
+  JsonArray *array;
+  gchar *str;
+
+  parser = g_object_new (JSON_TYPE_PARSER, "use-arena", use_arena, NULL);
+  json_parser_load_from_data (parser, cow_data, -1, NULL);
+  root = json_parser_steal_root (parser);
+  g_object_unref (parser);
+
+  object = json_node_get_object (root);
+  copy = json_node_copy_on_write (root);
+  g_assert_true (json_node_equal (root, copy));
+
+  /* reading the original tree does not change it */
+  g_assert_true (json_node_get_object (root) == object);
+  g_assert_true (json_node_get_object (copy) != object);
+
+  /* changes to the copy are not visible in the original tree */
+  object = json_object_get_object_member (json_node_get_object (copy), "a");
+  array = json_object_get_array_member (object, "b");
+  element = json_array_get_element (array, 2);
+  json_object_set_string_member (json_node_get_object (element), "c", "y");
+  json_object_set_int_member (json_node_get_object (copy), "g", 7);
+  json_array_add_double_element (json_object_get_array_member (json_node_get_object (copy), "e"), 3.5);
+  g_assert_true (json_node_get_parent (element) == json_object_get_member (object, "b"));
+
+  str = json_to_string (root, FALSE);
+  g_assert_cmpstr (str, ==, "{\"a\":{\"b\":[1,\"two\",{\"c\":\"x\"}],\"d\":true},\"e\":[1.5,2.5],\"f\":{}}");
+  g_free (str);
+
+  /* and the other way around */
+  object = json_object_get_object_member (json_node_get_object (root), "a");
+  json_object_set_boolean_member (object, "d", FALSE);
+  json_array_remove_element (json_object_get_array_member (object, "b"), 0);
+
+  str = json_to_string (copy, FALSE);
+  g_assert_cmpstr (str, ==, "{\"a\":{\"b\":[1,\"two\",{\"c\":\"y\"}],\"d\":true},\"e\":[1.5,2.5,3.5],\"f\":{},\"g\":7}");
+  g_free (str);
+
+  /* the copy does not depend on the original tree */
+  json_node_unref (root);
+
+  str = json_to_string (copy, FALSE);
+  g_assert_cmpstr (str, ==, "{\"a\":{\"b\":[1,\"two\",{\"c\":\"y\"}],\"d\":true},\"e\":[1.5,2.5,3.5],\"f\":{},\"g\":7}");
+  g_free (str);
+
+  /* copies of copies work the same way */
+  root = json_node_copy_on_write (copy);
+  json_node_seal (copy);
+  json_object_remove_member (json_node_get_object (root), "a");
+  g_assert_true (json_object_has_member (json_node_get_object (copy), "a"));
+  g_assert_false (json_object_has_member (json_node_get_object (root), "a"));
+
+  json_node_unref (copy);
+  json_node_unref (root);
+}
+
+static void
+test_deep_copy (gconstpointer data_)
+{
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  JsonNode *root, *copy, *node;
+  JsonObject *object;
+  JsonArray *array;
+  gchar *str, *copy_str;
+  guint i;
+
+  root = json_from_string ("{ \"a\" : { \"b\" : [ 1, \"two\", { \"c\" : \"a string that is too long to be inlined\" } ] }, "
+                           "\"e\" : [ 1.5, 2.5 ], \"f\" : [ 1, 2 ], \"g\" : { }, \"h\" : [ ], \"removed\" : null, "
+                           "\"i\" : [ { \"k\" : 1 }, { \"k\" : 2 } ], \"j\" : null }",
+                           NULL);
+  json_object_remove_member (json_node_get_object (root), "removed");
+  json_node_set_int (json_array_get_element (json_object_get_array_member (json_node_get_object (root), "f"), 0), 3);
+  json_node_seal (root);
+
+  copy = json_node_deep_copy (root, use_arena);
+  g_assert_false (json_node_is_immutable (copy));
+  g_assert_true (json_node_equal (root, copy));
+
+  str = json_to_string (root, FALSE);
+  copy_str = json_to_string (copy, FALSE);
+  g_assert_cmpstr (str, ==, copy_str);
+  g_free (copy_str);
+
+  /* nothing is shared with the original tree */
+  object = json_object_get_object_member (json_node_get_object (copy), "a");
+  g_assert_true (object != json_object_get_object_member (json_node_get_object (root), "a"));
+  array = json_object_get_array_member (object, "b");
+  node = json_array_get_element (array, 2);
+  g_assert_true (json_node_get_parent (node) == json_object_get_member (object, "b"));
+  json_object_set_string_member (json_node_get_object (node), "c", "changed");
+  json_array_add_int_element (json_object_get_array_member (json_node_get_object (copy), "f"), 4);
+  g_assert_cmpint (json_array_get_int_element (json_object_get_array_member (json_node_get_object (copy), "f"), 0), ==, 3);
+
+  json_node_unref (root);
+
+  root = json_from_string (str, NULL);
+  g_free (str);
+
+  str = json_to_string (copy, FALSE);
+  g_assert_cmpstr (str, ==, "{\"a\":{\"b\":[1,\"two\",{\"c\":\"changed\"}]},\"e\":[1.5,2.5],\"f\":[3,2,4],"
+                            "\"g\":{},\"h\":[],\"i\":[{\"k\":1},{\"k\":2}],\"j\":null}");
+  g_free (str);
+
+  json_node_unref (copy);
+  json_node_unref (root);
+
+  /* scalars */
+  root = json_node_init_string (json_node_alloc (), "a string that is too long to be inlined");
+  copy = json_node_deep_copy (root, use_arena);
+  g_assert_cmpstr (json_node_get_string (copy), ==, json_node_get_string (root));
+  g_assert_true (json_node_get_string (copy) != json_node_get_string (root));
+  json_node_unref (root);
+  json_node_unref (copy);
+
+  /* the depth of the tree is not limited by the stack */
+  root = json_node_new (JSON_NODE_ARRAY);
+  json_node_take_array (root, json_array_new ());
+  node = root;
+  for (i = 0; i < 10000; i++)
+    {
+      JsonNode *child = json_node_new (JSON_NODE_ARRAY);
+
+      json_node_take_array (child, json_array_new ());
+      json_array_add_element (json_node_get_array (node), child);
+      node = child;
+    }
+
+  copy = json_node_deep_copy (root, use_arena);
+  g_assert_true (json_node_equal (root, copy));
+
+  json_node_unref (copy);
+  json_node_unref (root);
+}
+
 static void
 test_null (void)
 {
@@ -547,6 +733,142 @@ test_immutable_parent (void)
   g_test_trap_assert_stderr ("*Json-CRITICAL **: json_node_set_parent: *");
 }
 
+static void
+test_string_storage (void)
+{
+  /* strings on both sides of the size that fits inside the node */
+  static const gchar *strings[] = {
+    "",
+    "fifteen bytes!!",
+    "sixteen bytes!!!",
+    "a string that is stored outside of the node",
+  };
+  guint i, j;
+
+  for (i = 0; i < G_N_ELEMENTS (strings); i++)
+    {
+      JsonNode *node = json_node_init_string (json_node_alloc (), strings[i]);
+      JsonNode *copy = json_node_copy (node);
+
+      g_assert_cmpstr (json_node_get_string (node), ==, strings[i]);
+      g_assert_cmpstr (json_node_get_string (copy), ==, strings[i]);
+      g_assert_true (json_node_get_string (copy) != json_node_get_string (node));
+      g_assert_true (json_node_equal (node, copy));
+      g_assert_cmpuint (json_node_hash (node), ==, json_node_hash (copy));
+
+      /* replacing the string with a copy of itself, or with any other
+       * string, does not affect the copy
+       */
+      json_node_set_string (node, json_node_get_string (node));
+      g_assert_cmpstr (json_node_get_string (node), ==, strings[i]);
+
+      for (j = 0; j < G_N_ELEMENTS (strings); j++)
+        {
+          json_node_set_string (node, strings[j]);
+          g_assert_cmpstr (json_node_get_string (node), ==, strings[j]);
+          g_assert_cmpstr (json_node_get_string (copy), ==, strings[i]);
+        }
+
+      /* and neither does replacing it with a scalar */
+      json_node_set_int (node, 42);
+      g_assert_null (json_node_get_string (node));
+      g_assert_cmpint (json_node_get_int (node), ==, 42);
+      g_assert_cmpint (json_node_get_int (copy), ==, 0);
+
+      json_node_set_string (copy, NULL);
+      g_assert_null (json_node_get_string (copy));
+      g_assert_cmpint (json_node_get_value_type (copy), ==, G_TYPE_STRING);
+
+      json_node_unref (copy);
+      json_node_unref (node);
+    }
+}
+
+static gsize
+get_resident_size (void)
+{
+#ifdef G_OS_UNIX
+  gchar *contents = NULL;
+  gsize res = 0;
+
+  if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+    {
+      gchar **fields = g_strsplit (contents, " ", 3);
+
+      if (fields[0] != NULL && fields[1] != NULL)
+        res = g_ascii_strtoull (fields[1], NULL, 10) * sysconf (_SC_PAGESIZE);
+
+      g_strfreev (fields);
+      g_free (contents);
+    }
+
+  return res;
+#else
+  return 0;
+#endif
+}
+
+static void
+test_leaf_memory (void)
+{
+  const guint n_nodes = 1000000;
+  JsonNode **nodes;
+  gsize before, after;
+  GTimer *timer;
+  guint i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests are disabled; use -m perf");
+      return;
+    }
+
+  if (get_resident_size () == 0)
+    {
+      g_test_skip ("Measuring the memory usage is not supported");
+      return;
+    }
+
+  nodes = g_new (JsonNode *, n_nodes);
+
+  before = get_resident_size ();
+  timer = g_timer_new ();
+
+  /* a mix of the leaves found in a typical document */
+  for (i = 0; i < n_nodes; i++)
+    {
+      switch (i % 4)
+        {
+        case 0:
+          nodes[i] = json_node_init_int (json_node_alloc (), i);
+          break;
+        case 1:
+          nodes[i] = json_node_init_double (json_node_alloc (), i / 3.0);
+          break;
+        case 2:
+          nodes[i] = json_node_init_boolean (json_node_alloc (), i % 3 == 0);
+          break;
+        case 3:
+          nodes[i] = json_node_init_string (json_node_alloc (), "short string");
+          break;
+        }
+    }
+
+  after = get_resident_size ();
+
+  g_test_message ("Allocated %u leaves in %.3f seconds",
+                  n_nodes, g_timer_elapsed (timer, NULL));
+  g_test_minimized_result ((gdouble) (after - before) / n_nodes,
+                           "%.1f bytes per leaf",
+                           (gdouble) (after - before) / n_nodes);
+
+  for (i = 0; i < n_nodes; i++)
+    json_node_unref (nodes[i]);
+
+  g_timer_destroy (timer);
+  g_free (nodes);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -561,6 +883,12 @@ main (int   argc,
   g_test_add_func ("/nodes/copy/null", test_copy_null);
   g_test_add_func ("/nodes/copy/value", test_copy_value);
   g_test_add_func ("/nodes/copy/object", test_copy_object);
+  g_test_add_func ("/nodes/copy/immutable", test_copy_immutable);
+  g_test_add_data_func ("/nodes/copy/on-write", GINT_TO_POINTER (FALSE), test_copy_on_write);
+  g_test_add_data_func ("/nodes/copy/on-write-arena", GINT_TO_POINTER (TRUE), test_copy_on_write);
+  g_test_add_data_func ("/nodes/copy/deep", GINT_TO_POINTER (FALSE), test_deep_copy);
+  g_test_add_data_func ("/nodes/copy/deep-arena", GINT_TO_POINTER (TRUE), test_deep_copy);
+  g_test_add_func ("/nodes/string/storage", test_string_storage);
   g_test_add_func ("/nodes/get/int", test_get_int);
   g_test_add_func ("/nodes/get/double", test_get_double);
   g_test_add_func ("/nodes/gvalue", test_gvalue);
@@ -580,6 +908,7 @@ main (int   argc,
   g_test_add_func ("/nodes/immutable/array", test_immutable_array);
   g_test_add_func ("/nodes/immutable/value", test_immutable_value);
   g_test_add_func ("/nodes/immutable/parent", test_immutable_parent);
+  g_test_add_func ("/nodes/leaf-memory", test_leaf_memory);
 
   return g_test_run ();
 }
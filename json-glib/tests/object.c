@@ -195,6 +195,199 @@ test_empty_member (void)
   json_object_unref (object);
 }
 
+static gchar *
+get_member_names (JsonObject *object)
+{
+  GString *res = g_string_new (NULL);
+  GList *members, *l;
+
+  members = json_object_get_members (object);
+  for (l = members; l != NULL; l = l->next)
+    {
+      const gchar *name = l->data;
+
+      g_assert_cmpint (json_object_get_int_member (object, name), ==, atoi (name + 1));
+      g_string_append (res, name);
+    }
+
+  g_list_free (members);
+
+  return g_string_free (res, FALSE);
+}
+
+static void
+test_member_order (void)
+{
+  JsonObject *object = json_object_new ();
+  gchar *names;
+  guint i;
+
+  /* large enough to need an index on the member names */
+  for (i = 0; i < 12; i++)
+    {
+      gchar *name = g_strdup_printf ("m%u", i);
+
+      json_object_set_int_member (object, name, i);
+      g_free (name);
+    }
+
+  g_assert_cmpint (json_object_get_size (object), ==, 12);
+
+  /* replacing a member keeps its position */
+  json_object_set_int_member (object, "m3", 3);
+  json_object_remove_member (object, "m0");
+  json_object_remove_member (object, "m7");
+  json_object_remove_member (object, "m42");
+  json_object_set_int_member (object, "m0", 0);
+
+  g_assert_cmpint (json_object_get_size (object), ==, 11);
+  g_assert_false (json_object_has_member (object, "m7"));
+  g_assert_true (json_object_has_member (object, "m11"));
+
+  names = get_member_names (object);
+  g_assert_cmpstr (names, ==, "m1m2m3m4m5m6m8m9m10m11m0");
+  g_free (names);
+
+  /* removing members back below the threshold */
+  for (i = 1; i < 10; i++)
+    {
+      gchar *name = g_strdup_printf ("m%u", i);
+
+      json_object_remove_member (object, name);
+      g_free (name);
+    }
+
+  json_object_set_int_member (object, "m5", 5);
+
+  names = get_member_names (object);
+  g_assert_cmpstr (names, ==, "m10m11m0m5");
+  g_free (names);
+
+  json_object_unref (object);
+}
+
+static void
+test_remove_many (void)
+{
+  JsonObject *object = json_object_new ();
+  JsonObjectIter iter;
+  const gchar *member_name;
+  JsonNode *member_node;
+  gint last = -1;
+  guint i;
+
+  for (i = 0; i < 1000; i++)
+    {
+      gchar *name = g_strdup_printf ("m%u", i);
+
+      json_object_set_int_member (object, name, i);
+      g_free (name);
+    }
+
+  /* remove and replace members in an order that leaves holes
+   * behind, and compacts them away
+   */
+  for (i = 0; i < 1000; i++)
+    {
+      gchar *name = g_strdup_printf ("m%u", i);
+
+      if (i % 3 != 0)
+        json_object_remove_member (object, name);
+      else
+        json_object_set_int_member (object, name, i);
+
+      g_free (name);
+    }
+
+  g_assert_cmpint (json_object_get_size (object), ==, 334);
+  g_assert_false (json_object_has_member (object, "m998"));
+  g_assert_cmpint (json_object_get_int_member (object, "m999"), ==, 999);
+
+  json_object_iter_init (&iter, object);
+  while (json_object_iter_next (&iter, &member_name, &member_node))
+    {
+      gint value = json_node_get_int (member_node);
+
+      g_assert_cmpint (value % 3, ==, 0);
+      g_assert_cmpint (value, >, last);
+      last = value;
+    }
+
+  g_assert_cmpint (last, ==, 999);
+
+  json_object_unref (object);
+}
+
+static void
+test_member_by_key (void)
+{
+  JsonObject *object = json_object_new ();
+  JsonObject *other = json_object_new ();
+  JsonKey *keys[12];
+  JsonKey *missing = json_key_new ("missing");
+  guint n, i;
+
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    {
+      gchar *name = g_strdup_printf ("m%u", i);
+
+      keys[i] = json_key_new (name);
+      g_assert_cmpstr (json_key_get_name (keys[i]), ==, name);
+      g_free (name);
+    }
+
+  /* objects small enough to be searched linearly, and large enough to
+   * be indexed, with keys shared between them or copied from names
+   */
+  for (n = 1; n <= G_N_ELEMENTS (keys); n++)
+    {
+      json_object_set_member_by_key (object, keys[n - 1], json_node_init_int (json_node_alloc (), n - 1));
+      json_object_set_int_member (other, json_key_get_name (keys[n - 1]), n - 1);
+
+      for (i = 0; i < G_N_ELEMENTS (keys); i++)
+        {
+          g_assert_cmpint (json_object_has_member_by_key (object, keys[i]), ==, i < n);
+          g_assert_cmpint (json_object_has_member_by_key (other, keys[i]), ==, i < n);
+          g_assert_cmpint (json_object_has_member (object, json_key_get_name (keys[i])), ==, i < n);
+
+          if (i < n)
+            {
+              g_assert_cmpint (json_object_get_int_member_by_key (object, keys[i]), ==, i);
+              g_assert_cmpint (json_object_get_int_member_by_key (other, keys[i]), ==, i);
+            }
+          else
+            g_assert_null (json_object_get_member_by_key (object, keys[i]));
+        }
+
+      g_assert_false (json_object_has_member_by_key (object, missing));
+    }
+
+  /* objects hold a reference on their keys */
+  for (i = 0; i < G_N_ELEMENTS (keys); i++)
+    json_key_unref (keys[i]);
+
+  json_object_remove_member (object, "m3");
+  g_assert_cmpint (json_object_get_size (object), ==, 11);
+  g_assert_false (json_object_has_member (object, "m3"));
+  g_assert_cmpint (json_object_get_int_member (object, "m11"), ==, 11);
+
+  json_object_set_string_member (object, "missing", "here");
+  g_assert_cmpstr (json_object_get_string_member_by_key (object, missing), ==, "here");
+  json_object_set_null_member (object, "missing");
+  g_assert_true (json_object_get_null_member_by_key (object, missing));
+  g_assert_null (json_object_get_object_member_by_key (object, missing));
+  json_object_set_boolean_member (object, "missing", TRUE);
+  g_assert_true (json_object_get_boolean_member_by_key (object, missing));
+  json_object_set_double_member (object, "missing", 0.5);
+  g_assert_cmpfloat (json_object_get_double_member_by_key (object, missing), ==, 0.5);
+  json_object_set_array_member (object, "missing", json_array_new ());
+  g_assert_nonnull (json_object_get_array_member_by_key (object, missing));
+
+  json_key_unref (missing);
+  json_object_unref (other);
+  json_object_unref (object);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -208,6 +401,9 @@ main (int   argc,
   g_test_add_func ("/object/foreach-member", test_foreach_member);
   g_test_add_func ("/object/iter", test_iter);
   g_test_add_func ("/object/empty-member", test_empty_member);
+  g_test_add_func ("/object/member-order", test_member_order);
+  g_test_add_func ("/object/remove-many", test_remove_many);
+  g_test_add_func ("/object/member-by-key", test_member_by_key);
 
   return g_test_run ();
 }
@@ -2,8 +2,14 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <sys/stat.h>
+#endif
 
 #include <json-glib/json-glib.h>
 
@@ -646,6 +652,57 @@ test_unicode_escape (void)
   g_object_unref (parser);
 }
 
+static const struct {
+  const gchar *str;
+  GType gtype;
+  gint64 v_int;
+  gdouble v_double;
+} test_numbers[] = {
+  { "0",                        G_TYPE_INT64,  0, 0.0 },
+  { "9007199254740993",         G_TYPE_INT64,  G_GINT64_CONSTANT (9007199254740993), 0.0 },
+  { "9223372036854775807",      G_TYPE_INT64,  G_MAXINT64, 0.0 },
+  { "-9223372036854775808",     G_TYPE_INT64,  G_MININT64, 0.0 },
+  { "18446744073709551616",     G_TYPE_DOUBLE, 0, 18446744073709551616.0 },
+  { "0.1",                      G_TYPE_DOUBLE, 0, 0.1 },
+  { "-0.5e-3",                  G_TYPE_DOUBLE, 0, -0.0005 },
+  { "123456789e30",             G_TYPE_DOUBLE, 0, 123456789e30 },
+  { "2.2250738585072014E-308",  G_TYPE_DOUBLE, 0, 2.2250738585072014e-308 },
+  { "1.7976931348623157e308",   G_TYPE_DOUBLE, 0, 1.7976931348623157e308 },
+  { "0.30000000000000004",      G_TYPE_DOUBLE, 0, 0.30000000000000004 },
+  { "3.141592653589793238462643383279", G_TYPE_DOUBLE, 0, 3.141592653589793 },
+};
+
+static void
+test_numbers_value (void)
+{
+  JsonParser *parser;
+  gint i;
+
+  parser = json_parser_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (test_numbers); i++)
+    {
+      GError *error = NULL;
+      JsonNode *root;
+
+      if (g_test_verbose ())
+        g_print ("checking number '%s'...\n", test_numbers[i].str);
+
+      json_parser_load_from_data (parser, test_numbers[i].str, -1, &error);
+      g_assert_no_error (error);
+
+      root = json_parser_get_root (parser);
+      g_assert_cmpint (json_node_get_value_type (root), ==, test_numbers[i].gtype);
+
+      if (test_numbers[i].gtype == G_TYPE_INT64)
+        g_assert_cmpint (json_node_get_int (root), ==, test_numbers[i].v_int);
+      else
+        g_assert_cmpfloat (json_node_get_double (root), ==, test_numbers[i].v_double);
+    }
+
+  g_object_unref (parser);
+}
+
 static void
 test_stream_sync (void)
 {
@@ -740,6 +797,882 @@ test_stream_async (void)
   g_free (path);
 }
 
+static void
+test_arena (void)
+{
+  const gchar *json =
+    "{ \"name\" : \"arena\", \"escaped\" : \"a\\tb\", "
+    "\"values\" : [ 1, -2.5, true, null, { \"nested\" : [ ] } ] }";
+  GError *error = NULL;
+  JsonParser *parser;
+  JsonNode *root, *values;
+  JsonObject *object;
+  JsonArray *array;
+  gboolean use_arena;
+
+  parser = g_object_new (JSON_TYPE_PARSER, "use-arena", TRUE, NULL);
+
+  g_object_get (parser, "use-arena", &use_arena, NULL);
+  g_assert_true (use_arena);
+
+  /* failing to parse should not leak the partial document */
+  g_assert_false (json_parser_load_from_data (parser, "[ 1, 2, { \"a\" : }", -1, &error));
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE);
+  g_clear_error (&error);
+
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+
+  root = json_parser_get_root (parser);
+  g_assert_true (json_node_is_immutable (root));
+
+  object = json_node_get_object (root);
+  g_assert_cmpstr (json_object_get_string_member (object, "name"), ==, "arena");
+  g_assert_cmpstr (json_object_get_string_member (object, "escaped"), ==, "a\tb");
+
+  /* a reference on any part of the tree keeps the whole tree alive */
+  values = json_node_ref (json_object_get_member (object, "values"));
+  g_object_unref (parser);
+
+  array = json_node_get_array (values);
+  g_assert_cmpint (json_array_get_length (array), ==, 5);
+  g_assert_cmpint (json_array_get_int_element (array, 0), ==, 1);
+  g_assert_cmpfloat (json_array_get_double_element (array, 1), ==, -2.5);
+  g_assert_true (json_array_get_boolean_element (array, 2));
+  g_assert_true (json_array_get_null_element (array, 3));
+  g_assert_nonnull (json_object_get_array_member (json_array_get_object_element (array, 4), "nested"));
+
+  json_node_unref (values);
+}
+
+static void
+check_packed_arrays (JsonNode *root)
+{
+  JsonObject *object = json_node_get_object (root);
+  JsonNode *ints = json_object_get_member (object, "ints");
+  JsonArray *array;
+  const gint64 *int_values;
+  const gdouble *double_values;
+  JsonNode *element;
+  gchar *str;
+  guint len;
+
+  array = json_node_get_array (ints);
+  int_values = json_array_peek_int_elements (array, &len);
+  g_assert_nonnull (int_values);
+  g_assert_cmpint (len, ==, 3);
+  g_assert_cmpint (int_values[0], ==, 1);
+  g_assert_cmpint (int_values[1], ==, -2);
+  g_assert_cmpint (int_values[2], ==, 3);
+
+  /* the nodes created on demand are part of the tree */
+  element = json_array_get_element (array, 1);
+  g_assert_true (json_node_get_parent (element) == ints);
+  g_assert_cmpint (json_node_get_int (element), ==, -2);
+  g_assert_true (json_node_is_immutable (element) == json_node_is_immutable (root));
+
+  array = json_object_get_array_member (object, "doubles");
+  double_values = json_array_peek_double_elements (array, &len);
+  g_assert_nonnull (double_values);
+  g_assert_cmpint (len, ==, 2);
+  g_assert_cmpfloat (double_values[0], ==, 0.5);
+  g_assert_cmpfloat (double_values[1], ==, -1500.0);
+
+  /* only homogeneous arrays are packed */
+  array = json_object_get_array_member (object, "mixed");
+  g_assert_null (json_array_peek_int_elements (array, NULL));
+  g_assert_null (json_array_peek_double_elements (array, NULL));
+  g_assert_cmpint (json_array_get_int_element (array, 0), ==, 1);
+  g_assert_true (json_node_get_parent (json_array_get_element (array, 0)) ==
+                 json_object_get_member (object, "mixed"));
+  g_assert_cmpfloat (json_array_get_double_element (array, 1), ==, 2.5);
+
+  str = json_to_string (root, FALSE);
+  g_assert_cmpstr (str, ==, "{\"ints\":[1,-2,3],\"doubles\":[0.5,-1500.0],"
+                            "\"mixed\":[1,2.5],\"empty\":[]}");
+  g_free (str);
+}
+
+static void
+test_packed_arrays (gconstpointer data_)
+{
+  const gchar *json =
+    "{ \"ints\" : [ 1, -2, 3 ], \"doubles\" : [ 0.5, -1.5e3 ], "
+    "\"mixed\" : [ 1, 2.5 ], \"empty\" : [ ] }";
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  GError *error = NULL;
+  JsonParser *parser;
+  gsize i;
+
+  parser = g_object_new (JSON_TYPE_PARSER, "use-arena", use_arena, NULL);
+
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+  check_packed_arrays (json_parser_get_root (parser));
+
+  for (i = 0; json[i] != '\0'; i++)
+    {
+      json_parser_feed (parser, json + i, 1, &error);
+      g_assert_no_error (error);
+    }
+
+  json_parser_finish (parser, &error);
+  g_assert_no_error (error);
+  check_packed_arrays (json_parser_get_root (parser));
+
+  g_object_unref (parser);
+}
+
+static void
+test_thread_local (gconstpointer data_)
+{
+  const gchar *json =
+    "{ \"name\" : \"a string longer than a node\", \"ints\" : [ 1, 2, 3 ], "
+    "\"nested\" : [ { \"value\" : null } ] }";
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  GError *error = NULL;
+  JsonParser *parser;
+  JsonObject *object;
+  JsonNode *root, *node, *copy;
+  guint i;
+
+  parser = g_object_new (JSON_TYPE_PARSER,
+                         "use-arena", use_arena,
+                         "immutable", TRUE,
+                         "thread-local", TRUE,
+                         NULL);
+
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+
+  root = json_parser_steal_root (parser);
+  g_object_unref (parser);
+
+  g_assert_true (json_node_is_thread_local (root));
+
+  object = json_node_get_object (root);
+  node = json_object_get_member (object, "name");
+  g_assert_true (json_node_is_thread_local (node));
+
+  /* the nodes of packed elements belong to the document as well */
+  node = json_array_get_element (json_object_get_array_member (object, "ints"), 1);
+  g_assert_true (json_node_is_thread_local (node));
+  g_assert_cmpint (json_node_get_int (node), ==, 2);
+
+  node = json_array_get_element (json_object_get_array_member (object, "nested"), 0);
+  g_assert_true (json_node_is_thread_local (node));
+
+  /* references keep the tree alive without atomic operations */
+  for (i = 0; i < 16; i++)
+    json_node_ref (node);
+  json_node_unref (root);
+  g_assert_true (json_node_get_parent (node) != NULL);
+  g_assert_true (JSON_NODE_HOLDS_NULL (json_object_get_member (json_node_get_object (node), "value")));
+
+  /* copies of immutable thread-local nodes are not shared */
+  copy = json_node_copy (node);
+  g_assert_true (copy != node);
+  g_assert_false (json_node_is_thread_local (copy));
+  g_assert_true (json_node_equal (copy, node));
+  json_node_unref (copy);
+
+  copy = json_node_deep_copy (node, use_arena);
+  g_assert_false (json_node_is_thread_local (copy));
+  json_node_unref (copy);
+
+  for (i = 0; i < 16; i++)
+    json_node_unref (node);
+
+  /* the default is to build trees that can be shared */
+  parser = json_parser_new ();
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+  g_assert_false (json_node_is_thread_local (json_parser_get_root (parser)));
+  g_object_unref (parser);
+}
+
+static const gchar *
+get_first_member (JsonArray *array,
+                  guint      index_)
+{
+  JsonObject *object = json_array_get_object_element (array, index_);
+  JsonObjectIter iter;
+  const gchar *member_name = NULL;
+
+  json_object_iter_init (&iter, object);
+  g_assert_true (json_object_iter_next (&iter, &member_name, NULL));
+
+  return member_name;
+}
+
+static void
+test_intern_member_names (gconstpointer data_)
+{
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  const gchar *json =
+    "[ { \"id\" : 1, \"na\\u006de\" : \"a\" }, { \"id\" : 2, \"name\" : \"b\", \"id\" : 3 }, "
+    "{ \"name\" : \"c\" }, { \"nam\" : \"d\" } ]";
+  GError *error = NULL;
+  JsonParser *parser;
+  JsonNode *root;
+  JsonArray *array;
+  gboolean intern_member_names;
+
+  parser = g_object_new (JSON_TYPE_PARSER,
+                         "use-arena", use_arena,
+                         "intern-member-names", TRUE,
+                         NULL);
+
+  g_object_get (parser, "intern-member-names", &intern_member_names, NULL);
+  g_assert_true (intern_member_names);
+
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+
+  /* the document outlives the parser, and the names it interned */
+  root = json_node_ref (json_parser_get_root (parser));
+  g_object_unref (parser);
+
+  array = json_node_get_array (root);
+  g_assert_cmpint (json_array_get_length (array), ==, 4);
+
+  /* objects share the names of their members */
+  g_assert_true (get_first_member (array, 0) == get_first_member (array, 1));
+  g_assert_false (get_first_member (array, 0) == get_first_member (array, 2));
+  g_assert_cmpstr (get_first_member (array, 3), ==, "nam");
+
+  g_assert_cmpint (json_object_get_int_member (json_array_get_object_element (array, 0), "id"), ==, 1);
+  g_assert_cmpstr (json_object_get_string_member (json_array_get_object_element (array, 0), "name"), ==, "a");
+  g_assert_cmpint (json_object_get_size (json_array_get_object_element (array, 1)), ==, 2);
+  g_assert_cmpint (json_object_get_int_member (json_array_get_object_element (array, 1), "id"), ==, 3);
+  g_assert_cmpstr (json_object_get_string_member (json_array_get_object_element (array, 2), "name"), ==, "c");
+
+  json_node_unref (root);
+
+  /* the same names are shared by the documents built incrementally */
+  parser = g_object_new (JSON_TYPE_PARSER,
+                         "use-arena", use_arena,
+                         "intern-member-names", TRUE,
+                         NULL);
+
+  g_assert_true (json_parser_feed (parser, json, 40, &error));
+  g_assert_true (json_parser_feed (parser, json + 40, -1, &error));
+  g_assert_true (json_parser_finish (parser, &error));
+  g_assert_no_error (error);
+
+  array = json_node_get_array (json_parser_get_root (parser));
+  g_assert_true (get_first_member (array, 0) == get_first_member (array, 1));
+  g_assert_cmpint (json_object_get_int_member (json_array_get_object_element (array, 1), "id"), ==, 3);
+
+  g_object_unref (parser);
+}
+
+static void
+count_member (JsonParser  *parser,
+               JsonObject  *object,
+               const gchar *member_name,
+               gpointer     user_data)
+{
+  guint *n_members = user_data;
+
+  *n_members += 1;
+}
+
+static void
+test_feed (gconstpointer data_)
+{
+  const gchar *json =
+    "{ \"name\" : \"caf\xc3\xa9\", \"escaped\" : \"a\\tb\\u00e9\", "
+    "\"values\" : [ 1, -2.5e3, true, null, { \"nested\" : [ ] }, 12345678901 ] }";
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  GError *error = NULL;
+  JsonParser *parser;
+  gchar *expected;
+  gsize len = strlen (json);
+  gsize chunk_size;
+  guint n_members = 0;
+
+  parser = g_object_new (JSON_TYPE_PARSER, "use-arena", use_arena, NULL);
+
+  json_parser_load_from_data (parser, json, -1, &error);
+  g_assert_no_error (error);
+  expected = json_to_string (json_parser_get_root (parser), FALSE);
+
+  /* split the document at every position */
+  for (chunk_size = 1; chunk_size <= len; chunk_size++)
+    {
+      gsize offset;
+      gchar *res;
+
+      for (offset = 0; offset < len; offset += chunk_size)
+        {
+          json_parser_feed (parser, json + offset, MIN (chunk_size, len - offset), &error);
+          g_assert_no_error (error);
+        }
+
+      json_parser_finish (parser, &error);
+      g_assert_no_error (error);
+
+      res = json_to_string (json_parser_get_root (parser), FALSE);
+      g_assert_cmpstr (res, ==, expected);
+      g_free (res);
+    }
+
+  /* members are reported as soon as they are complete */
+  g_signal_connect (parser, "object-member", G_CALLBACK (count_member), &n_members);
+
+  json_parser_feed (parser, "{ \"a\" : 1, \"b\" : [ 2, ", -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n_members, ==, 1);
+
+  json_parser_feed (parser, "3 ], \"c\" : \"x", -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n_members, ==, 2);
+
+  json_parser_feed (parser, "yz\" }", -1, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (n_members, ==, 3);
+
+  json_parser_finish (parser, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (json_object_get_string_member (json_node_get_object (json_parser_get_root (parser)), "c"), ==, "xyz");
+
+  /* errors are reported as soon as they are found */
+  g_assert_false (json_parser_feed (parser, "[ 1, 2, ]", -1, &error));
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_TRAILING_COMMA);
+  g_assert_null (json_parser_get_root (parser));
+  g_clear_error (&error);
+
+  /* incomplete documents are an error */
+  g_assert_true (json_parser_feed (parser, "[ 1, 2", -1, &error));
+  g_assert_false (json_parser_finish (parser, &error));
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_MISSING_COMMA);
+  g_assert_null (json_parser_get_root (parser));
+  g_clear_error (&error);
+
+  /* and so is anything after the end of the document */
+  g_assert_true (json_parser_feed (parser, "42 ", -1, &error));
+  g_assert_false (json_parser_feed (parser, "43 ", -1, &error));
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE);
+  g_clear_error (&error);
+
+  /* finishing without data is an empty document */
+  g_assert_true (json_parser_finish (parser, &error));
+  g_assert_no_error (error);
+  g_assert_null (json_parser_get_root (parser));
+
+  g_free (expected);
+  g_object_unref (parser);
+}
+
+static const gchar *test_lines_data =
+  "{ \"id\" : 1, \"tags\" : [ \"a\", \"b\" ] }\n"
+  "\n"
+  "{ \"id\" : 2, }\r\n"
+  "  [ 3 ]  \n"
+  "4 5\n"
+  "\"six\"";
+
+typedef struct {
+  GString *records;
+  guint n_errors;
+  guint stop_after;
+  gboolean with_messages;
+} LinesResult;
+
+static gboolean
+collect_line (JsonParser   *parser,
+              guint         line,
+              JsonNode     *node,
+              const GError *error,
+              gpointer      user_data)
+{
+  LinesResult *res = user_data;
+
+  if (node != NULL)
+    {
+      gchar *str = json_to_string (node, FALSE);
+
+      g_assert_no_error (error);
+      g_string_append_printf (res->records, "%u:%s;", line, str);
+      g_free (str);
+    }
+  else
+    {
+      g_assert_nonnull (error);
+      g_string_append_printf (res->records, "%u:error;", line);
+      if (res->with_messages)
+        g_string_append_printf (res->records, "%s;", error->message);
+      res->n_errors += 1;
+    }
+
+  if (res->stop_after > 0 && --res->stop_after == 0)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+test_feed_single_value (void)
+{
+  static const gchar *documents[] = { "\"b\"\"\"", "1 2", "[ 1 ] [ 2 ]", "{ } 3" };
+  JsonParser *parser = json_parser_new ();
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (documents); i++)
+    {
+      GError *error = NULL;
+
+      /* loading the whole document accepts more than one value... */
+      json_parser_load_from_data (parser, documents[i], -1, &error);
+      g_assert_no_error (error);
+
+      /* ...but the chunked parser only takes one */
+      if (json_parser_feed (parser, documents[i], -1, &error))
+        g_assert_false (json_parser_finish (parser, &error));
+
+      g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_PARSE);
+      g_assert_null (json_parser_get_root (parser));
+      g_clear_error (&error);
+    }
+
+  g_object_unref (parser);
+}
+
+static void
+test_lines (void)
+{
+  const gchar *expected =
+    "1:{\"id\":1,\"tags\":[\"a\",\"b\"]};3:error;4:[3];5:error;6:\"six\";";
+  LinesResult res = { NULL, 0, 0, FALSE };
+  GInputStream *stream;
+  GError *error = NULL;
+  JsonParser *parser;
+  GString *data;
+  guint i;
+
+  parser = json_parser_new ();
+
+  /* errors are reported for each line, and parsing continues */
+  res.records = g_string_new (NULL);
+  json_parser_load_lines_from_data (parser, test_lines_data, -1, collect_line, &res);
+  g_assert_cmpstr (res.records->str, ==, expected);
+  g_assert_cmpint (res.n_errors, ==, 2);
+  g_assert_null (json_parser_get_root (parser));
+
+  /* the function can stop the parser */
+  g_string_truncate (res.records, 0);
+  res.stop_after = 2;
+  json_parser_load_lines_from_data (parser, test_lines_data, -1, collect_line, &res);
+  g_assert_cmpstr (res.records->str, ==, "1:{\"id\":1,\"tags\":[\"a\",\"b\"]};3:error;");
+
+  /* lines from a stream can cross the boundaries of the reads */
+  data = g_string_new (NULL);
+  for (i = 0; i < 2000; i++)
+    g_string_append_printf (data, "{ \"id\" : %u, \"name\" : \"record %u\" }\n", i, i);
+
+  g_string_append (data, "[ \"");
+  for (i = 0; i < 20000; i++)
+    g_string_append_c (data, 'x');
+  g_string_append (data, "\" ]");
+
+  stream = g_memory_input_stream_new_from_data (data->str, data->len, NULL);
+
+  g_string_truncate (res.records, 0);
+  res.n_errors = 0;
+  g_assert_true (json_parser_load_lines_from_stream (parser, stream, NULL, collect_line, &res, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (res.n_errors, ==, 0);
+  g_assert_true (g_str_has_prefix (res.records->str, "1:{\"id\":0,\"name\":\"record 0\"};"));
+  g_assert_nonnull (strstr (res.records->str, ";2000:{\"id\":1999,\"name\":\"record 1999\"};2001:[\"xxx"));
+  g_assert_true (g_str_has_suffix (res.records->str, "xxx\"];"));
+
+  g_object_unref (stream);
+  g_string_free (data, TRUE);
+  g_string_free (res.records, TRUE);
+  g_object_unref (parser);
+}
+
+static void
+check_nul_member_name (JsonParser *parser)
+{
+  JsonGenerator *generator = json_generator_new ();
+  JsonObject *object;
+  gchar *data;
+  gsize length;
+
+  /* the name ends at the escaped NUL, so the second member replaces
+   * the first one
+   */
+  object = json_node_get_object (json_parser_get_root (parser));
+  g_assert_cmpint (json_object_get_size (object), ==, 1);
+  g_assert_cmpint (json_object_get_int_member (object, "a"), ==, 2);
+
+  json_generator_set_root (generator, json_parser_get_root (parser));
+  data = json_generator_to_data (generator, &length);
+  g_assert_cmpstr (data, ==, "{\"a\":2}");
+  g_assert_cmpuint (json_generator_get_size_hint (generator), ==, length);
+
+  g_free (data);
+  g_object_unref (generator);
+}
+
+static void
+test_nul_member_name (void)
+{
+  const gchar *json = "{\"a\":1,\"a\\u0000\":2}";
+  gchar *filename = g_build_filename (g_get_tmp_dir (), "json-glib-nul-member-name.json", NULL);
+  GError *error = NULL;
+  guint flags;
+
+  g_file_set_contents (filename, json, -1, &error);
+  g_assert_no_error (error);
+
+  for (flags = 0; flags < 4; flags++)
+    {
+      JsonParser *parser = g_object_new (JSON_TYPE_PARSER,
+                                         "use-arena", (flags & 1) != 0,
+                                         "intern-member-names", (flags & 2) != 0,
+                                         NULL);
+      GInputStream *stream;
+      gsize i;
+
+      json_parser_load_from_data (parser, json, -1, &error);
+      g_assert_no_error (error);
+      check_nul_member_name (parser);
+
+      json_parser_load_from_file (parser, filename, &error);
+      g_assert_no_error (error);
+      check_nul_member_name (parser);
+
+      stream = g_memory_input_stream_new_from_data (json, -1, NULL);
+      json_parser_load_from_stream (parser, stream, NULL, &error);
+      g_assert_no_error (error);
+      check_nul_member_name (parser);
+      g_object_unref (stream);
+
+      for (i = 0; json[i] != '\0'; i++)
+        {
+          json_parser_feed (parser, json + i, 1, &error);
+          g_assert_no_error (error);
+        }
+
+      json_parser_finish (parser, &error);
+      g_assert_no_error (error);
+      check_nul_member_name (parser);
+
+      g_object_unref (parser);
+    }
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+static void
+test_load_file (void)
+{
+  JsonParser *parser;
+  GError *error = NULL;
+  gchar *filename;
+
+  filename = g_build_filename (g_get_tmp_dir (), "json-glib-load-file.json", NULL);
+  parser = json_parser_new ();
+
+  g_file_set_contents (filename, "{ \"test\" : [ 1, \"two\" ] }", -1, &error);
+  g_assert_no_error (error);
+  g_assert_true (json_parser_load_from_file (parser, filename, &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (json_array_get_string_element (json_object_get_array_member (json_node_get_object (json_parser_get_root (parser)), "test"), 1), ==, "two");
+
+  /* errors are reported with the name of the file */
+  g_file_set_contents (filename, "[ 1,\n  2, ]", -1, &error);
+  g_assert_no_error (error);
+  g_assert_false (json_parser_load_from_file (parser, filename, &error));
+  g_assert_error (error, JSON_PARSER_ERROR, JSON_PARSER_ERROR_TRAILING_COMMA);
+  g_assert_true (g_str_has_prefix (error->message, filename));
+  g_clear_error (&error);
+
+  /* an empty file is an empty document */
+  g_file_set_contents (filename, "", 0, &error);
+  g_assert_no_error (error);
+  g_assert_true (json_parser_load_from_file (parser, filename, &error));
+  g_assert_no_error (error);
+  g_assert_null (json_parser_get_root (parser));
+
+  g_unlink (filename);
+
+  g_assert_false (json_parser_load_from_file (parser, filename, &error));
+  g_assert_error (error, G_FILE_ERROR, G_FILE_ERROR_NOENT);
+  g_clear_error (&error);
+
+  g_object_unref (parser);
+  g_free (filename);
+}
+
+#ifdef G_OS_UNIX
+static gpointer
+write_fifo (gpointer data)
+{
+  FILE *fifo = fopen (data, "w");
+
+  g_assert_nonnull (fifo);
+  fputs ("{ \"test\" : [ 1, \"two\" ] }", fifo);
+  fclose (fifo);
+
+  return NULL;
+}
+
+static void
+test_load_fifo (void)
+{
+  JsonParser *parser;
+  GError *error = NULL;
+  gchar *filename;
+  GThread *writer;
+
+  filename = g_build_filename (g_get_tmp_dir (), "json-glib-load-fifo.json", NULL);
+  g_unlink (filename);
+  g_assert_cmpint (mkfifo (filename, 0600), ==, 0);
+
+  /* pipes cannot be mapped in memory, so they are read until EOF */
+  parser = json_parser_new ();
+  writer = g_thread_new ("fifo-writer", write_fifo, filename);
+  g_assert_true (json_parser_load_from_file (parser, filename, &error));
+  g_assert_no_error (error);
+  g_thread_join (writer);
+
+  g_assert_cmpstr (json_array_get_string_element (json_object_get_array_member (json_node_get_object (json_parser_get_root (parser)), "test"), 1), ==, "two");
+
+  g_object_unref (parser);
+  g_unlink (filename);
+  g_free (filename);
+}
+#endif
+
+static void
+test_lines_parallel (void)
+{
+  LinesResult res = { NULL, 0, 0, TRUE };
+  LinesResult expected = { NULL, 0, 0, TRUE };
+  GError *error = NULL;
+  JsonParser *parser;
+  GString *data;
+  gchar *filename;
+  guint i;
+
+  data = g_string_new (NULL);
+  for (i = 0; i < 50000; i++)
+    {
+      if (i % 1000 == 999)
+        g_string_append (data, "{ \"id\" : ]\n");
+      else if (i % 100 == 0)
+        g_string_append (data, "\n");
+      else
+        g_string_append_printf (data, "{ \"id\" : %u, \"values\" : [ %u.5, \"%u\" ] }\n", i, i, i);
+    }
+
+  filename = g_build_filename (g_get_tmp_dir (), "json-glib-lines-parallel.json", NULL);
+  g_file_set_contents (filename, data->str, data->len, &error);
+  g_assert_no_error (error);
+
+  parser = json_parser_new ();
+
+  expected.records = g_string_new (NULL);
+  g_assert_true (json_parser_load_lines_from_file (parser, filename, collect_line, &expected, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (expected.n_errors, ==, 50);
+
+  /* the records are reported in order, with their lines in the file */
+  res.records = g_string_new (NULL);
+  g_assert_true (json_parser_load_lines_from_file_parallel (parser, filename, 4, collect_line, &res, &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (res.records->str, ==, expected.records->str);
+
+  /* a single worker only parses a couple of chunks ahead of the function */
+  g_string_truncate (res.records, 0);
+  g_assert_true (json_parser_load_lines_from_file_parallel (parser, filename, 1, collect_line, &res, &error));
+  g_assert_no_error (error);
+  g_assert_cmpstr (res.records->str, ==, expected.records->str);
+
+  /* the function can stop the workers */
+  g_string_truncate (res.records, 0);
+  res.stop_after = 10;
+  g_assert_true (json_parser_load_lines_from_file_parallel (parser, filename, 0, collect_line, &res, &error));
+  g_assert_no_error (error);
+  g_assert_true (g_str_has_suffix (res.records->str, "11:{\"id\":10,\"values\":[10.5,\"10\"]};"));
+
+  g_object_unref (parser);
+
+  g_unlink (filename);
+  g_free (filename);
+  g_string_free (data, TRUE);
+  g_string_free (res.records, TRUE);
+  g_string_free (expected.records, TRUE);
+}
+
+static gchar *
+build_large_document (gsize *length)
+{
+  GString *buffer = g_string_new ("[");
+  guint i;
+
+  for (i = 0; i < 50000; i++)
+    {
+      if (i > 0)
+        g_string_append_c (buffer, ',');
+
+      g_string_append_printf (buffer,
+                              "{ \"id\" : %u, \"name\" : \"item-%u\", "
+                              "\"score\" : %u.%02u, \"ratio\" : -%ue-3, "
+                              "\"active\" : %s, \"parent\" : null, "
+                              "\"tags\" : [ \"a\\tb\", \"\\u00e8\", %u ] }",
+                              i, i,
+                              i % 1000, i % 100, i % 7,
+                              (i % 2) ? "true" : "false",
+                              i * 3);
+    }
+
+  g_string_append_c (buffer, ']');
+
+  *length = buffer->len;
+
+  return g_string_free (buffer, FALSE);
+}
+
+/* the tokenizer replaced by the current JsonScanner was a copy of
+ * GScanner with this configuration, so GScanner gives the baseline
+ * for the throughput of the scanner
+ */
+static const GScannerConfig baseline_scanner_config =
+{
+  ( " \t\r\n" )           /* cset_skip_characters */,
+  (
+   "_"
+   G_CSET_a_2_z
+   G_CSET_A_2_Z
+  )                     /* cset_identifier_first */,
+  (
+   G_CSET_DIGITS
+   "-_"
+   G_CSET_a_2_z
+   G_CSET_A_2_Z
+  )                     /* cset_identifier_nth */,
+  ( "//\n" )              /* cpair_comment_single */,
+  TRUE                  /* case_sensitive */,
+  TRUE                  /* skip_comment_multi */,
+  TRUE                  /* skip_comment_single */,
+  FALSE                 /* scan_comment_multi */,
+  TRUE                  /* scan_identifier */,
+  TRUE                  /* scan_identifier_1char */,
+  FALSE                 /* scan_identifier_NULL */,
+  TRUE                  /* scan_symbols */,
+  TRUE                  /* scan_binary */,
+  TRUE                  /* scan_octal */,
+  TRUE                  /* scan_float */,
+  TRUE                  /* scan_hex */,
+  TRUE                  /* scan_hex_dollar */,
+  TRUE                  /* scan_string_sq */,
+  TRUE                  /* scan_string_dq */,
+  TRUE                  /* numbers_2_int */,
+  FALSE                 /* int_2_float */,
+  FALSE                 /* identifier_2_string */,
+  TRUE                  /* char_2_token */,
+  TRUE                  /* symbol_2_token */,
+  FALSE                 /* scope_0_fallback */,
+  TRUE                  /* store_int64 */
+};
+
+/* only tokenizes @data, so it measures less work than the parser did */
+static gdouble
+measure_baseline_scanner (const gchar *data,
+                          gsize        length,
+                          guint        n_runs)
+{
+  static const gchar *symbols[] = { "true", "false", "null", "var" };
+  GScanner *scanner;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  scanner = g_scanner_new (&baseline_scanner_config);
+  for (i = 0; i < G_N_ELEMENTS (symbols); i++)
+    g_scanner_scope_add_symbol (scanner, 0, symbols[i], GUINT_TO_POINTER (G_TOKEN_LAST + 1 + i));
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      GTokenType token;
+
+      g_scanner_input_text (scanner, data, length);
+
+      do
+        token = g_scanner_get_next_token (scanner);
+      while (token != G_TOKEN_EOF && token != G_TOKEN_ERROR);
+
+      g_assert_cmpint (token, ==, G_TOKEN_EOF);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_timer_destroy (timer);
+  g_scanner_destroy (scanner);
+
+  return elapsed;
+}
+
+static void
+test_throughput (gconstpointer data_)
+{
+  gboolean use_arena = GPOINTER_TO_INT (data_);
+  JsonParser *parser;
+  GTimer *timer;
+  gchar *data;
+  gsize length;
+  gdouble elapsed, baseline;
+  guint i, n_runs = 10;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Performance tests are disabled; use -m perf");
+      return;
+    }
+
+  data = build_large_document (&length);
+  parser = g_object_new (JSON_TYPE_PARSER, "use-arena", use_arena, NULL);
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      GError *error = NULL;
+
+      json_parser_load_from_data (parser, data, length, &error);
+      g_assert_no_error (error);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+
+  g_test_message ("Parsed %u x %" G_GSIZE_FORMAT " bytes in %.3f seconds",
+                  n_runs, length, elapsed);
+  g_test_maximized_result ((gdouble) (length * n_runs) / (1024.0 * 1024.0) / elapsed,
+                           "%.2f MB/s", (gdouble) (length * n_runs) / (1024.0 * 1024.0) / elapsed);
+
+  /* the previous scanner only tokenizing the data gives a lower bound
+   * of the speed-up of the parser
+   */
+  baseline = measure_baseline_scanner (data, length, n_runs);
+  g_test_message ("Tokenized %u x %" G_GSIZE_FORMAT " bytes with the GScanner "
+                  "baseline in %.3f seconds (%.2f MB/s); parsing runs at "
+                  "%.2fx the speed of the baseline",
+                  n_runs, length, baseline,
+                  (gdouble) (length * n_runs) / (1024.0 * 1024.0) / baseline,
+                  baseline / elapsed);
+
+  g_timer_destroy (timer);
+  g_object_unref (parser);
+  g_free (data);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -756,8 +1689,28 @@ main (int   argc,
   g_test_add_func ("/parser/nested-object", test_nested_object);
   g_test_add_func ("/parser/assignment", test_assignment);
   g_test_add_func ("/parser/unicode-escape", test_unicode_escape);
+  g_test_add_func ("/parser/numbers", test_numbers_value);
   g_test_add_func ("/parser/stream-sync", test_stream_sync);
   g_test_add_func ("/parser/stream-async", test_stream_async);
+  g_test_add_func ("/parser/load-file", test_load_file);
+#ifdef G_OS_UNIX
+  g_test_add_func ("/parser/load-fifo", test_load_fifo);
+#endif
+  g_test_add_func ("/parser/nul-member-name", test_nul_member_name);
+  g_test_add_func ("/parser/arena", test_arena);
+  g_test_add_data_func ("/parser/packed-arrays", GINT_TO_POINTER (FALSE), test_packed_arrays);
+  g_test_add_data_func ("/parser/packed-arrays-arena", GINT_TO_POINTER (TRUE), test_packed_arrays);
+  g_test_add_data_func ("/parser/thread-local", GINT_TO_POINTER (FALSE), test_thread_local);
+  g_test_add_data_func ("/parser/thread-local-arena", GINT_TO_POINTER (TRUE), test_thread_local);
+  g_test_add_data_func ("/parser/intern-member-names", GINT_TO_POINTER (FALSE), test_intern_member_names);
+  g_test_add_data_func ("/parser/intern-member-names-arena", GINT_TO_POINTER (TRUE), test_intern_member_names);
+  g_test_add_data_func ("/parser/feed", GINT_TO_POINTER (FALSE), test_feed);
+  g_test_add_data_func ("/parser/feed-arena", GINT_TO_POINTER (TRUE), test_feed);
+  g_test_add_func ("/parser/feed-single-value", test_feed_single_value);
+  g_test_add_func ("/parser/lines", test_lines);
+  g_test_add_func ("/parser/lines-parallel", test_lines_parallel);
+  g_test_add_data_func ("/parser/throughput", GINT_TO_POINTER (FALSE), test_throughput);
+  g_test_add_data_func ("/parser/throughput-arena", GINT_TO_POINTER (TRUE), test_throughput);
 
   return g_test_run ();
 }
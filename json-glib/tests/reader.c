@@ -215,6 +215,43 @@ test_reader_null_value (void)
   g_object_unref (parser);
 }
 
+static void
+test_read_member_by_key (void)
+{
+  JsonParser *parser = json_parser_new ();
+  JsonReader *reader = json_reader_new (NULL);
+  JsonKey *blah = json_key_new ("blah");
+  JsonKey *bar = json_key_new ("bar");
+  GError *error = NULL;
+
+  json_parser_load_from_data (parser, test_base_object_data, -1, &error);
+  g_assert_no_error (error);
+
+  json_reader_set_root (reader, json_parser_get_root (parser));
+
+  g_assert_true (json_reader_read_member_by_key (reader, blah));
+  g_assert_cmpstr (json_reader_get_member_name (reader), ==, "blah");
+  g_assert_cmpint (json_reader_get_int_value (reader), ==, 47);
+  json_reader_end_member (reader);
+
+  g_assert_false (json_reader_read_member_by_key (reader, bar));
+  g_assert_error ((GError *) json_reader_get_error (reader),
+                  JSON_READER_ERROR,
+                  JSON_READER_ERROR_INVALID_MEMBER);
+  json_reader_end_member (reader);
+  g_assert_null (json_reader_get_error (reader));
+
+  /* the reader holds a reference on the key it is reading */
+  g_assert_true (json_reader_read_member_by_key (reader, blah));
+  json_key_unref (blah);
+  g_assert_cmpstr (json_reader_get_member_name (reader), ==, "blah");
+  json_reader_end_member (reader);
+
+  json_key_unref (bar);
+  g_object_unref (reader);
+  g_object_unref (parser);
+}
+
 int
 main (int   argc,
       char *argv[])
@@ -226,6 +263,7 @@ main (int   argc,
   g_test_add_func ("/reader/base-object", test_base_object);
   g_test_add_func ("/reader/level", test_reader_level);
   g_test_add_func ("/reader/null-value", test_reader_null_value);
+  g_test_add_func ("/reader/read-member-by-key", test_read_member_by_key);
 
   return g_test_run ();
 }
@@ -0,0 +1,286 @@
+#include <math.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <json-glib/json-glib.h>
+
+static const gchar *test_events_data =
+"{\n"
+"  \"string\" : \"hello, world!\",\n"
+"  \"escapes\" : \"a\\tb\\u00e9\\ud83d\\ude00\",\n"
+"  \"utf8\" : \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\",\n"
+"  \"int\" : 42, \"negative\" : -1234567890123,\n"
+"  \"double\" : 3.5, \"exponent\" : -2.5e-3,\n"
+"  \"values\" : [ true, false, null, [], {}, [ [ 0 ] ] ],\n"
+"  \"\xc3\xa9\" : { \"empty\" : \"\" }\n"
+"}\n";
+
+static const gchar *test_events_expected =
+"{ string: \"hello, world!\" escapes: \"a\tb\xc3\xa9\xf0\x9f\x98\x80\" "
+"utf8: \"caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80\" "
+"int: 42 negative: -1234567890123 "
+"double: 3.5 exponent: -0.0025 "
+"values: [ true false null [ ] { } [ [ 0 ] ] ] "
+"\xc3\xa9: { empty: \"\" } } .";
+
+static const guint chunk_sizes[] = { 1, 2, 3, 4, 5, 6, 7, 8, 11, 13, 16, 17, 4096 };
+
+static const struct
+{
+  const gchar *desc;
+  const gchar *str;
+  JsonParserError code;
+} test_errors_data[] = {
+  { "trailing-comma-array", "[ 1, 2, ]", JSON_PARSER_ERROR_TRAILING_COMMA },
+  { "trailing-comma-object", "{ \"a\" : 1, }", JSON_PARSER_ERROR_TRAILING_COMMA },
+  { "missing-comma", "[ 1 2 ]", JSON_PARSER_ERROR_MISSING_COMMA },
+  { "missing-colon", "{ \"a\" 1 }", JSON_PARSER_ERROR_MISSING_COLON },
+  { "bareword", "[ foo ]", JSON_PARSER_ERROR_INVALID_BAREWORD },
+  { "unterminated-string", "[ \"abc", JSON_PARSER_ERROR_PARSE },
+  { "unterminated-array", "[ 1, 2", JSON_PARSER_ERROR_MISSING_COMMA },
+  { "trailing-data", "[ 1 ] [ 2 ]", JSON_PARSER_ERROR_PARSE },
+  { "truncated-utf8", "[ \"caf\xc3\" ]", JSON_PARSER_ERROR_INVALID_DATA },
+  { "truncated-utf8-eof", "[ \"caf\xc3", JSON_PARSER_ERROR_INVALID_DATA },
+};
+
+static gchar *
+read_events (JsonStreamReader  *reader,
+             GError           **error)
+{
+  GString *res = g_string_new (NULL);
+  JsonStreamEvent event;
+
+  while ((event = json_stream_reader_next (reader, NULL, error)) != JSON_STREAM_EVENT_END)
+    {
+      switch (event)
+        {
+        case JSON_STREAM_EVENT_NONE:
+          g_string_free (res, TRUE);
+          return NULL;
+
+        case JSON_STREAM_EVENT_START_OBJECT:
+          g_string_append (res, "{ ");
+          break;
+
+        case JSON_STREAM_EVENT_END_OBJECT:
+          g_string_append (res, "} ");
+          break;
+
+        case JSON_STREAM_EVENT_START_ARRAY:
+          g_string_append (res, "[ ");
+          break;
+
+        case JSON_STREAM_EVENT_END_ARRAY:
+          g_string_append (res, "] ");
+          break;
+
+        case JSON_STREAM_EVENT_MEMBER_NAME:
+          g_string_append_printf (res, "%s: ", json_stream_reader_get_member_name (reader));
+          break;
+
+        case JSON_STREAM_EVENT_VALUE:
+          switch (json_stream_reader_get_value_type (reader))
+            {
+            case G_TYPE_INT64:
+              g_string_append_printf (res, "%" G_GINT64_FORMAT " ",
+                                      json_stream_reader_get_int_value (reader));
+              break;
+
+            case G_TYPE_DOUBLE:
+              g_string_append_printf (res, "%g ",
+                                      json_stream_reader_get_double_value (reader));
+              break;
+
+            case G_TYPE_STRING:
+              g_string_append_printf (res, "\"%s\" ",
+                                      json_stream_reader_get_string_value (reader));
+              break;
+
+            case G_TYPE_BOOLEAN:
+              g_string_append (res, json_stream_reader_get_boolean_value (reader) ? "true " : "false ");
+              break;
+
+            default:
+              g_assert_true (json_stream_reader_get_null_value (reader));
+              g_string_append (res, "null ");
+              break;
+            }
+          break;
+
+        default:
+          g_assert_not_reached ();
+        }
+    }
+
+  g_assert_cmpint (json_stream_reader_get_depth (reader), ==, 0);
+  g_string_append_c (res, '.');
+
+  return g_string_free (res, FALSE);
+}
+
+static JsonStreamReader *
+create_reader (const gchar *data,
+               gsize        len,
+               guint        chunk_size)
+{
+  JsonStreamReader *reader;
+  GInputStream *stream;
+
+  stream = g_memory_input_stream_new_from_data (data, len, NULL);
+  reader = g_object_new (JSON_TYPE_STREAM_READER,
+                         "stream", stream,
+                         "chunk-size", chunk_size,
+                         NULL);
+  g_object_unref (stream);
+
+  return reader;
+}
+
+static void
+test_events (void)
+{
+  guint i;
+
+  /* small chunks split every token at every possible position */
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++)
+    {
+      guint chunk_size = chunk_sizes[i];
+      JsonStreamReader *reader;
+      GError *error = NULL;
+      gchar *events;
+
+      if (g_test_verbose ())
+        g_print ("chunk size: %u\n", chunk_size);
+
+      reader = create_reader (test_events_data, strlen (test_events_data), chunk_size);
+
+      events = read_events (reader, &error);
+      g_assert_no_error (error);
+      g_assert_cmpstr (events, ==, test_events_expected);
+
+      /* the end of the stream is sticky */
+      g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_END);
+      g_assert_no_error (error);
+
+      g_free (events);
+      g_object_unref (reader);
+    }
+}
+
+static void
+test_errors (gconstpointer data)
+{
+  guint idx = GPOINTER_TO_UINT (data);
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (chunk_sizes); i++)
+    {
+      guint chunk_size = chunk_sizes[i];
+      const gchar *str = test_errors_data[idx].str;
+      JsonStreamReader *reader;
+      GError *error = NULL;
+      gchar *events;
+
+      reader = create_reader (str, strlen (str), chunk_size);
+
+      events = read_events (reader, &error);
+      g_assert_null (events);
+      g_assert_error (error, JSON_PARSER_ERROR, test_errors_data[idx].code);
+
+      if (g_test_verbose ())
+        g_print ("error: %s\n", error->message);
+
+      g_clear_error (&error);
+
+      /* errors are sticky */
+      g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_NONE);
+      g_assert_error (error, JSON_PARSER_ERROR, test_errors_data[idx].code);
+      g_clear_error (&error);
+
+      g_object_unref (reader);
+    }
+}
+
+static void
+test_long_token (void)
+{
+  JsonStreamReader *reader;
+  GString *data = g_string_new ("[ \"");
+  GError *error = NULL;
+  gsize len = 0;
+  guint i;
+
+  for (i = 0; i < 20000; i++)
+    {
+      g_string_append (data, "abc\\n\xc3\xa9");
+      len += 6;
+    }
+
+  g_string_append (data, "\", 12345678901234567890e-20, \"\" ]");
+
+  reader = create_reader (data->str, data->len, 7);
+
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_START_ARRAY);
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_VALUE);
+  g_assert_no_error (error);
+  g_assert_cmpint (strlen (json_stream_reader_get_string_value (reader)), ==, len);
+  g_assert_true (g_str_has_suffix (json_stream_reader_get_string_value (reader), "abc\n\xc3\xa9"));
+
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_VALUE);
+  g_assert_cmpint (json_stream_reader_get_value_type (reader), ==, G_TYPE_DOUBLE);
+  g_assert_cmpfloat (fabs (json_stream_reader_get_double_value (reader) - 0.1234567890123456789), <, 1e-15);
+
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_VALUE);
+  g_assert_cmpstr (json_stream_reader_get_string_value (reader), ==, "");
+
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_END_ARRAY);
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_END);
+  g_assert_no_error (error);
+
+  g_object_unref (reader);
+  g_string_free (data, TRUE);
+}
+
+static void
+test_empty (void)
+{
+  JsonStreamReader *reader;
+  GError *error = NULL;
+
+  reader = create_reader (" \n ", 3, 1);
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_END);
+  g_assert_no_error (error);
+  g_object_unref (reader);
+
+  reader = create_reader ("-12", 3, 1);
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_VALUE);
+  g_assert_cmpint (json_stream_reader_get_int_value (reader), ==, -12);
+  g_assert_cmpint (json_stream_reader_next (reader, NULL, &error), ==, JSON_STREAM_EVENT_END);
+  g_assert_no_error (error);
+  g_object_unref (reader);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  guint i;
+
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/stream-reader/events", test_events);
+  g_test_add_func ("/stream-reader/long-token", test_long_token);
+  g_test_add_func ("/stream-reader/empty", test_empty);
+
+  for (i = 0; i < G_N_ELEMENTS (test_errors_data); i++)
+    {
+      gchar *test_name = g_strdup_printf ("/stream-reader/errors/%s", test_errors_data[i].desc);
+
+      g_test_add_data_func (test_name, GUINT_TO_POINTER (i), test_errors);
+
+      g_free (test_name);
+    }
+
+  return g_test_run ();
+}
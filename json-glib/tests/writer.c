@@ -0,0 +1,245 @@
+#include <string.h>
+
+#include <glib.h>
+
+#include <json-glib/json-glib.h>
+
+static const gchar *test_document =
+"{"
+  "\"string\" : \"hello, \\\"world\\\"\\n\\t\\u0001\","
+  "\"utf8\" : \"caf\xc3\xa9 \xe2\x82\xac\","
+  "\"int\" : -1234567890123,"
+  "\"double\" : 3.5,"
+  "\"round\" : 2.0,"
+  "\"values\" : [ true, false, null, [], {}, [ [ 0 ] ] ],"
+  "\"es\\\\caped\" : { \"empty\" : \"\" }"
+"}";
+
+static void
+write_document (JsonWriter *writer)
+{
+  guint depth = json_writer_get_depth (writer);
+
+  json_writer_begin_object (writer);
+
+  json_writer_set_member_name (writer, "string");
+  json_writer_add_string_value (writer, "hello, \"world\"\n\t\001");
+  json_writer_set_member_name (writer, "utf8");
+  json_writer_add_string_value (writer, "caf\xc3\xa9 \xe2\x82\xac");
+  json_writer_set_member_name (writer, "int");
+  json_writer_add_int_value (writer, G_GINT64_CONSTANT (-1234567890123));
+  json_writer_set_member_name (writer, "double");
+  json_writer_add_double_value (writer, 3.5);
+  json_writer_set_member_name (writer, "round");
+  json_writer_add_double_value (writer, 2.0);
+
+  json_writer_set_member_name (writer, "values");
+  json_writer_begin_array (writer);
+  json_writer_add_boolean_value (writer, TRUE);
+  json_writer_add_boolean_value (writer, FALSE);
+  json_writer_add_null_value (writer);
+  json_writer_begin_array (writer);
+  json_writer_end_array (writer);
+  json_writer_begin_object (writer);
+  json_writer_end_object (writer);
+  json_writer_begin_array (writer);
+  json_writer_begin_array (writer);
+  g_assert_cmpuint (json_writer_get_depth (writer), ==, depth + 4);
+  json_writer_add_int_value (writer, 0);
+  json_writer_end_array (writer);
+  json_writer_end_array (writer);
+  json_writer_end_array (writer);
+
+  json_writer_set_member_name (writer, "es\\caped");
+  json_writer_begin_object (writer);
+  json_writer_set_member_name (writer, "empty");
+  json_writer_add_string_value (writer, "");
+  json_writer_end_object (writer);
+
+  json_writer_end_object (writer);
+
+  g_assert_cmpuint (json_writer_get_depth (writer), ==, depth);
+}
+
+static gchar *
+generate_document (const gchar *str,
+                   gboolean     pretty)
+{
+  JsonParser *parser = json_parser_new ();
+  JsonGenerator *generator;
+  GError *error = NULL;
+  gchar *res;
+
+  json_parser_load_from_data (parser, str, -1, &error);
+  g_assert_no_error (error);
+
+  generator = json_generator_new ();
+  json_generator_set_pretty (generator, pretty);
+  json_generator_set_root (generator, json_parser_get_root (parser));
+  res = json_generator_to_data (generator, NULL);
+
+  g_object_unref (generator);
+  g_object_unref (parser);
+
+  return res;
+}
+
+static void
+test_compare (void)
+{
+  gboolean pretty;
+
+  for (pretty = FALSE; pretty <= TRUE; pretty++)
+    {
+      JsonWriter *writer = g_object_new (JSON_TYPE_WRITER, "pretty", pretty, NULL);
+      GError *error = NULL;
+      gchar *expected;
+      gchar *data;
+      gsize length;
+
+      write_document (writer);
+
+      g_assert_true (json_writer_finish (writer, NULL, &error));
+      g_assert_no_error (error);
+
+      data = json_writer_steal_data (writer, &length);
+      expected = generate_document (test_document, pretty);
+
+      if (g_test_verbose ())
+        g_print ("writer: '%s'\n", data);
+
+      g_assert_cmpstr (data, ==, expected);
+      g_assert_cmpuint (length, ==, strlen (expected));
+
+      g_free (expected);
+      g_free (data);
+      g_object_unref (writer);
+    }
+}
+
+static void
+test_add_value (void)
+{
+  JsonParser *parser = json_parser_new ();
+  JsonWriter *writer = json_writer_new (NULL);
+  GError *error = NULL;
+  gchar *expected;
+  gchar *data;
+  gchar *str;
+
+  json_parser_load_from_data (parser, test_document, -1, &error);
+  g_assert_no_error (error);
+
+  json_writer_begin_array (writer);
+  json_writer_add_value (writer, json_parser_get_root (parser));
+  write_document (writer);
+  json_writer_add_string_value (writer, NULL);
+  json_writer_end_array (writer);
+
+  g_assert_true (json_writer_finish (writer, NULL, &error));
+  g_assert_no_error (error);
+
+  data = json_writer_steal_data (writer, NULL);
+
+  str = g_strconcat ("[", test_document, ",", test_document, ",null]", NULL);
+  expected = generate_document (str, FALSE);
+
+  g_assert_cmpstr (data, ==, expected);
+
+  g_free (str);
+  g_free (expected);
+  g_free (data);
+  g_object_unref (writer);
+  g_object_unref (parser);
+}
+
+static void
+test_stream (void)
+{
+  JsonWriter *writer, *memory;
+  GOutputStream *stream;
+  GError *error = NULL;
+  gchar *data;
+  gsize length;
+  guint i;
+
+  stream = g_memory_output_stream_new_resizable ();
+  writer = json_writer_new (stream);
+  memory = json_writer_new (NULL);
+
+  /* large enough to be written out in more than one chunk */
+  json_writer_begin_array (writer);
+  json_writer_begin_array (memory);
+
+  for (i = 0; i < 10000; i++)
+    {
+      write_document (writer);
+      write_document (memory);
+    }
+
+  json_writer_end_array (writer);
+  json_writer_end_array (memory);
+
+  g_assert_true (json_writer_finish (writer, NULL, &error));
+  g_assert_no_error (error);
+  g_assert_null (json_writer_steal_data (writer, NULL));
+
+  g_assert_true (json_writer_finish (memory, NULL, &error));
+  g_assert_no_error (error);
+  data = json_writer_steal_data (memory, &length);
+
+  g_assert_cmpuint (length, >, 64 * 1024);
+  g_assert_cmpuint (g_memory_output_stream_get_data_size (G_MEMORY_OUTPUT_STREAM (stream)), ==, length);
+  g_assert_true (memcmp (g_memory_output_stream_get_data (G_MEMORY_OUTPUT_STREAM (stream)), data, length) == 0);
+
+  g_free (data);
+  g_object_unref (memory);
+  g_object_unref (writer);
+  g_object_unref (stream);
+}
+
+static void
+test_reset (void)
+{
+  JsonWriter *writer = json_writer_new (NULL);
+  GError *error = NULL;
+  gchar *data;
+
+  json_writer_begin_object (writer);
+  json_writer_set_member_name (writer, "incomplete");
+  json_writer_begin_array (writer);
+  g_assert_cmpuint (json_writer_get_depth (writer), ==, 2);
+
+  json_writer_reset (writer);
+  g_assert_cmpuint (json_writer_get_depth (writer), ==, 0);
+
+  json_writer_add_int_value (writer, 42);
+  g_assert_true (json_writer_finish (writer, NULL, &error));
+  g_assert_no_error (error);
+
+  data = json_writer_steal_data (writer, NULL);
+  g_assert_cmpstr (data, ==, "42");
+  g_free (data);
+
+  /* stealing the data resets the writer */
+  json_writer_add_double_value (writer, 0.5);
+  data = json_writer_steal_data (writer, NULL);
+  g_assert_cmpstr (data, ==, "0.5");
+  g_free (data);
+
+  g_object_unref (writer);
+}
+
+int
+main (int   argc,
+      char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+
+  g_test_add_func ("/writer/compare", test_compare);
+  g_test_add_func ("/writer/add-value", test_add_value);
+  g_test_add_func ("/writer/stream", test_stream);
+  g_test_add_func ("/writer/reset", test_reset);
+
+  return g_test_run ();
+}